@@ -0,0 +1,135 @@
+//
+// Created by seeu on 2022/8/30.
+//
+
+#include "Arithmetic.h"
+
+namespace Common {
+
+    BigInt toBigInt(GIObject *object) {
+        if (object->getType() == ObjectType::INTEGER) {
+            return BigInt{static_cast<IntegerObject *>(object)->value};
+        }
+        return static_cast<BigIntObject *>(object)->value;
+    }
+
+    std::shared_ptr<GIObject> makeIntegerObject(const BigInt &value) {
+        if (auto small = value.toInt64()) {
+            return std::make_shared<IntegerObject>(*small);
+        }
+        return std::make_shared<BigIntObject>(value);
+    }
+
+    std::shared_ptr<GIObject> integerArithmetic(ArithmeticOperator op, GIObject *left, GIObject *right) {
+        if (left->getType() == ObjectType::INTEGER && right->getType() == ObjectType::INTEGER) {
+            auto leftValue = static_cast<IntegerObject *>(left)->value;
+            auto rightValue = static_cast<IntegerObject *>(right)->value;
+            std::int64_t result;
+            bool overflow;
+            switch (op) {
+                case ArithmeticOperator::Add:
+                    overflow = __builtin_add_overflow(leftValue, rightValue, &result);
+                    break;
+                case ArithmeticOperator::Sub:
+                    overflow = __builtin_sub_overflow(leftValue, rightValue, &result);
+                    break;
+                case ArithmeticOperator::Mul:
+                    overflow = __builtin_mul_overflow(leftValue, rightValue, &result);
+                    break;
+                case ArithmeticOperator::Div:
+                    if (rightValue == 0) {
+                        return makeErrorObject("division by zero");
+                    }
+                    // INT64_MIN / -1 is the only quotient that does not fit
+                    overflow = leftValue == INT64_MIN && rightValue == -1;
+                    result = overflow ? 0 : leftValue / rightValue;
+                    break;
+                case ArithmeticOperator::Mod:
+                    if (rightValue == 0) {
+                        return makeErrorObject("division by zero");
+                    }
+                    // INT64_MIN % -1 is undefined behaviour in c++ although the remainder is 0
+                    overflow = false;
+                    result = rightValue == -1 ? 0 : leftValue % rightValue;
+                    break;
+            }
+            if (!overflow) {
+                return std::make_shared<IntegerObject>(result);
+            }
+        }
+
+        auto leftValue = toBigInt(left);
+        auto rightValue = toBigInt(right);
+        switch (op) {
+            case ArithmeticOperator::Add:
+                return makeIntegerObject(leftValue + rightValue);
+            case ArithmeticOperator::Sub:
+                return makeIntegerObject(leftValue - rightValue);
+            case ArithmeticOperator::Mul:
+                return makeIntegerObject(leftValue * rightValue);
+            case ArithmeticOperator::Div:
+                if (rightValue.isZero()) {
+                    return makeErrorObject("division by zero");
+                }
+                return makeIntegerObject(BigInt::divMod(leftValue, rightValue).first);
+            case ArithmeticOperator::Mod:
+                if (rightValue.isZero()) {
+                    return makeErrorObject("division by zero");
+                }
+                return makeIntegerObject(BigInt::divMod(leftValue, rightValue).second);
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<GIObject> integerNegate(GIObject *operand) {
+        if (operand->getType() == ObjectType::INTEGER) {
+            auto value = static_cast<IntegerObject *>(operand)->value;
+            if (value != INT64_MIN) {
+                return std::make_shared<IntegerObject>(-value);
+            }
+        }
+        return makeIntegerObject(-toBigInt(operand));
+    }
+
+    double toDouble(GIObject *number) {
+        switch (number->getType()) {
+            case ObjectType::INTEGER:
+                return double(static_cast<IntegerObject *>(number)->value);
+            case ObjectType::BIG_INTEGER:
+                return static_cast<BigIntObject *>(number)->value.toDouble();
+            default:
+                return static_cast<FloatObject *>(number)->value;
+        }
+    }
+
+    std::shared_ptr<GIObject> numberArithmetic(ArithmeticOperator op, GIObject *left, GIObject *right) {
+        if (left->getType() == ObjectType::FLOAT || right->getType() == ObjectType::FLOAT) {
+            return std::make_shared<FloatObject>(floatArithmetic(op, toDouble(left), toDouble(right)));
+        }
+        return integerArithmetic(op, left, right);
+    }
+
+    std::shared_ptr<GIObject> numberNegate(GIObject *operand) {
+        if (operand->getType() == ObjectType::FLOAT) {
+            return std::make_shared<FloatObject>(-static_cast<FloatObject *>(operand)->value);
+        }
+        return integerNegate(operand);
+    }
+
+    std::partial_ordering numberCompare(GIObject *left, GIObject *right) {
+        if (left->getType() == ObjectType::FLOAT || right->getType() == ObjectType::FLOAT) {
+            return toDouble(left) <=> toDouble(right);
+        }
+        return integerCompare(left, right) <=> 0;
+    }
+
+    int integerCompare(GIObject *left, GIObject *right) {
+        if (left->getType() == ObjectType::INTEGER && right->getType() == ObjectType::INTEGER) {
+            auto leftValue = static_cast<IntegerObject *>(left)->value;
+            auto rightValue = static_cast<IntegerObject *>(right)->value;
+            return leftValue < rightValue ? -1 : leftValue > rightValue;
+        }
+        auto order = toBigInt(left) <=> toBigInt(right);
+        return order < 0 ? -1 : order > 0;
+    }
+}
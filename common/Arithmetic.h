@@ -0,0 +1,73 @@
+//
+// Created by seeu on 2022/8/30.
+//
+
+#ifndef GOINTERPRETER_ARITHMETIC_H
+#define GOINTERPRETER_ARITHMETIC_H
+
+#include "GIObject.h"
+#include <cmath>
+#include <compare>
+
+// Number arithmetic shared by the interpreter and the vm. Operations on two int64 values are checked for
+// overflow and only fall back to BigInt when the result does not fit. An integer mixed with a float is
+// promoted to a float.
+namespace Common {
+
+    enum class ArithmeticOperator {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        // remainder of the truncating division, it has the sign of the dividend
+        Mod,
+    };
+
+    inline bool isIntegerType(ObjectType type) {
+        return type == ObjectType::INTEGER || type == ObjectType::BIG_INTEGER;
+    }
+
+    inline bool isNumberType(ObjectType type) {
+        return isIntegerType(type) || type == ObjectType::FLOAT;
+    }
+
+    // IntegerObject when the value fits into an int64, BigIntObject otherwise
+    std::shared_ptr<GIObject> makeIntegerObject(const BigInt &value);
+
+    // both operands must be integer objects, division or modulo by zero returns an error object
+    std::shared_ptr<GIObject> integerArithmetic(ArithmeticOperator op, GIObject *left, GIObject *right);
+
+    std::shared_ptr<GIObject> integerNegate(GIObject *operand);
+
+    // negative, zero or positive like `left <=> right`
+    int integerCompare(GIObject *left, GIObject *right);
+
+    // value of a number object as a double
+    double toDouble(GIObject *number);
+
+    inline double floatArithmetic(ArithmeticOperator op, double left, double right) {
+        switch (op) {
+            case ArithmeticOperator::Add:
+                return left + right;
+            case ArithmeticOperator::Sub:
+                return left - right;
+            case ArithmeticOperator::Mul:
+                return left * right;
+            case ArithmeticOperator::Div:
+                return left / right;
+            case ArithmeticOperator::Mod:
+                return std::fmod(left, right);
+        }
+        return 0;
+    }
+
+    // both operands must be number objects, integers are promoted when the other operand is a float
+    std::shared_ptr<GIObject> numberArithmetic(ArithmeticOperator op, GIObject *left, GIObject *right);
+
+    std::shared_ptr<GIObject> numberNegate(GIObject *operand);
+
+    // NaN is unordered to everything
+    std::partial_ordering numberCompare(GIObject *left, GIObject *right);
+}
+
+#endif //GOINTERPRETER_ARITHMETIC_H
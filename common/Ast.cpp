@@ -27,12 +27,12 @@ namespace Common {
     }
 
     std::string Identifier::toString() {
-        return value;
+        return std::string{token.literal};
     }
 
     std::string PrefixExpression::toString() {
         std::stringstream ss;
-        ss << fmt::format("({}{})", prefixOperator, rightExpression->toString());
+        ss << fmt::format("({}{})", operatorSymbol(prefixOperator), rightExpression->toString());
         return ss.str();
     }
 
@@ -45,9 +45,22 @@ namespace Common {
         return ss.str();
     }
 
+    std::string MatchExpression::toString() {
+        vector<string> arms{};
+        transform(this->arms.begin(), this->arms.end(), back_inserter(arms), [](auto &arm) {
+            vector<string> patterns{};
+            transform(arm.patterns.begin(), arm.patterns.end(), back_inserter(patterns), [](auto &p) {
+                return p->toString();
+            });
+            return fmt::format("{} => {}", patterns.empty() ? "_" : fmt::format("{}", fmt::join(patterns, ", ")),
+                               arm.body->toString());
+        });
+        return fmt::format("match ({}) {{ {} }}", subject->toString(), fmt::join(arms, ", "));
+    }
+
     std::string FunctionExpression::toString() {
         vector<string> params{};
-        transform(parameters.begin(), parameters.end(), params.begin(), [](auto &p) {
+        transform(parameters.begin(), parameters.end(), back_inserter(params), [](auto &p) {
             return p->toString();
         });
         return fmt::format("fn({}){}", fmt::join(params, ", "), body->toString());
@@ -69,13 +82,29 @@ namespace Common {
         return expression->toString();
     }
 
+    std::string AssignStatement::toString() {
+        return fmt::format("{} = {};", target->toString(), value->toString());
+    }
+
+    std::string WhileStatement::toString() {
+        return fmt::format("while {} {}", condition->toString(), body->toString());
+    }
+
+    std::string ForStatement::toString() {
+        return fmt::format("for ({} in {}) {}", variable->toString(), iterable->toString(), body->toString());
+    }
+
+    std::string IndexExpression::toString() {
+        return fmt::format("({}[{}])", leftExpression->toString(), indexExpression->toString());
+    }
+
     std::string InfixExpression::toString() {
-        return fmt::format("({} {} {})", leftExpression->toString(), infixOperator, rightExpression->toString());
+        return fmt::format("({} {} {})", leftExpression->toString(), operatorSymbol(infixOperator), rightExpression->toString());
     }
 
     std::string CallExpression::toString() {
         vector<string> args{};
-        transform(arguments.begin(), arguments.end(), args.begin(), [](auto &p) {
+        transform(arguments.begin(), arguments.end(), back_inserter(args), [](auto &p) {
             return p->toString();
         });
         return fmt::format("{}({})", name->toString(), fmt::join(args, ", "));
@@ -93,7 +122,7 @@ namespace Common {
 
     std::string ArrayExpression::toString() {
         vector<string> elems{};
-        transform(elements.begin(), elements.end(), elems.begin(), [](auto &e) {
+        transform(elements.begin(), elements.end(), back_inserter(elems), [](auto &e) {
             return e->toString();
         });
         return fmt::format("[{}]", fmt::join(elems, ", "));
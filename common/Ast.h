@@ -7,9 +7,14 @@
 
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <cstdint>
+#include "BigInt.h"
 #include "Token.h"
 
 using namespace std;
@@ -18,6 +23,7 @@ namespace Common {
     enum class NodeType {
         Identifier,
         IntegerExpression,
+        FloatExpression,
         StringExpression,
         ArrayExpression,
         IndexExpression,
@@ -25,136 +31,219 @@ namespace Common {
         PrefixExpression,
         BoolExpression,
         IfExpression,
+        MatchExpression,
         FunctionExpression,
         LetStatement,
         BlockStatement,
         ReturnStatement,
         ExpressionStatement,
+        AssignStatement,
+        WhileStatement,
+        ForStatement,
         InfixExpression,
         CallExpression,
         Program
     };
 
+    enum class PrefixOperator {
+        Bang,
+        Minus,
+    };
+
+    // resolved by the parser, both engines switch on it instead of comparing operator text
+    enum class InfixOperator {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Mod,
+        Equal,
+        NotEqual,
+        Less,
+        Greater,
+        LessEqual,
+        GreaterEqual,
+        And,
+        Or,
+    };
+
+    // source text of an operator, for printing and error messages
+    constexpr std::string_view operatorSymbol(PrefixOperator op) {
+        constexpr std::string_view symbols[]{"!", "-"};
+        return symbols[static_cast<std::size_t>(op)];
+    }
+
+    constexpr std::string_view operatorSymbol(InfixOperator op) {
+        constexpr std::string_view symbols[]{"+", "-", "*", "/", "%", "==", "!=", "<", ">", "<=", ">=", "&&", "||"};
+        return symbols[static_cast<std::size_t>(op)];
+    }
+
     struct Node {
+        Node(NodeType type, std::uint32_t line) : type{type}, line{line} {}
+
         virtual std::string toString() = 0;
 
-        virtual NodeType getType() = 0;
+        NodeType getType() const { return type; }
+
+        // line of the node's token, 0 when unknown
+        std::uint32_t getLine() const { return line; }
 
         virtual ~Node() = default;
+
+    private:
+        NodeType type;
+        std::uint32_t line;
+    };
+
+    // Memory of one parsed program. Nodes are bump allocated from `arena` and destroyed in place, the
+    // arena is released in one piece once the program and every function body shared out of it are gone.
+    // Token literals point into `source`, identifier symbols are ids of `symbols`.
+    struct SyntaxStorage {
+        SyntaxStorage(Source source, Symbols symbols) : source{std::move(source)}, symbols{std::move(symbols)} {}
+
+        template<typename T, typename... Args>
+        T *allocate(Args &&... args) {
+            return std::pmr::polymorphic_allocator<T>{&arena}.template new_object<T>(std::forward<Args>(args)...);
+        }
+
+        Source source;
+        Symbols symbols;
+        std::pmr::monotonic_buffer_resource arena;
+    };
+
+    // runs the destructor only, the memory belongs to a SyntaxStorage arena
+    struct NodeDeleter {
+        void operator()(Node *node) const {
+            node->~Node();
+        }
     };
 
+    template<typename T>
+    using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
     struct Expression : Node {
-        std::string toString() override = 0;
+        Expression(NodeType type, std::uint32_t line) : Node{type, line} {}
 
-        NodeType getType() override = 0;
+        std::string toString() override = 0;
     };
 
     struct Identifier : Expression {
-        Identifier(Token token, std::string value) : token{std::move(token)}, value{value} {};
-
-        NodeType getType() override { return NodeType::Identifier; };
+        Identifier(Token token, SymbolId symbol) :
+                Expression{NodeType::Identifier, token.line}, token{std::move(token)}, symbol{symbol}, slot{symbol} {};
 
         std::string toString() override;
 
         Token token;
-        std::string value;
+        SymbolId symbol;
+        // where the evaluator finds the binding, `depth` environments up in `slot`. Set by GI::resolve, until
+        // then the identifier names a global, the global environment is indexed by symbol.
+        std::uint32_t depth{0};
+        std::uint32_t slot;
     };
 
     struct IntegerExpression : Expression {
-        IntegerExpression(Token token, int value) : token{std::move(token)}, value{value} {}
+        IntegerExpression(Token token, std::int64_t value) :
+                Expression{NodeType::IntegerExpression, token.line}, token{std::move(token)}, value{value} {}
 
-        NodeType getType() override { return NodeType::IntegerExpression; };
+        IntegerExpression(Token token, BigInt bigValue) :
+                Expression{NodeType::IntegerExpression, token.line}, token{std::move(token)}, value{0},
+                bigValue{std::move(bigValue)} {}
 
         std::string toString() override {
-            return token.literal;
+            return std::string{token.literal};
         }
 
         Token token;
-        int value;
+        std::int64_t value;
+        // set instead of `value` for literals that don't fit into an int64
+        std::optional<BigInt> bigValue;
     };
 
-    struct StringExpression : Expression {
-        StringExpression(Token token, std::string value) : token{std::move(token)}, value{std::move(value)} {}
+    struct FloatExpression : Expression {
+        FloatExpression(Token token, double value) :
+                Expression{NodeType::FloatExpression, token.line}, token{std::move(token)}, value{value} {}
+
+        std::string toString() override {
+            return std::string{token.literal};
+        }
 
-        NodeType getType() override { return NodeType::StringExpression; }
+        Token token;
+        double value;
+    };
+
+    struct StringExpression : Expression {
+        explicit StringExpression(Token token) : Expression{NodeType::StringExpression, token.line}, token{std::move(token)} {}
 
         std::string toString() override {
-            return value;
+            return std::string{value()};
         }
 
+        // contents between the quotes, strings have no escapes
+        std::string_view value() const { return token.literal; }
+
         Token token;
-        std::string value;
     };
 
     struct ArrayExpression : Expression {
-        ArrayExpression(Token token, std::vector<std::unique_ptr<Expression>> elements) :
+        ArrayExpression(Token token, std::vector<NodePtr<Expression>> elements) :
+                Expression{NodeType::ArrayExpression, token.line},
                 token{std::move(token)},
                 elements{std::move(elements)} {}
 
-        NodeType getType() override { return NodeType::ArrayExpression; }
-
         std::string toString() override;
 
         Token token;
-        std::vector<std::unique_ptr<Expression>> elements;
+        std::vector<NodePtr<Expression>> elements;
     };
 
     struct HashExpression : Expression {
-        HashExpression(Token token, std::map<unique_ptr<Expression>,unique_ptr<Expression>> pairs) : token{token}, pairs{std::move(pairs)} {}
+        // key and value expressions in source order
+        using Pairs = std::vector<std::pair<NodePtr<Expression>, NodePtr<Expression>>>;
 
-        NodeType getType() override { return NodeType::HashExpression;};
+        HashExpression(Token token, Pairs pairs) :
+                Expression{NodeType::HashExpression, token.line}, token{token}, pairs{std::move(pairs)} {}
 
         string toString() override;
 
         Token token;
-        std::map<unique_ptr<Expression>,unique_ptr<Expression> > pairs;
+        Pairs pairs;
     };
 
     struct IndexExpression : Expression {
-        IndexExpression(Token token, unique_ptr <Expression> leftExpression,
-                        unique_ptr <Expression> indexExpression) :
+        IndexExpression(Token token, NodePtr<Expression> leftExpression,
+                        NodePtr<Expression> indexExpression) :
+                Expression{NodeType::IndexExpression, token.line},
                 token(std::move(token)), leftExpression(std::move(leftExpression)),
                 indexExpression(std::move(indexExpression)) {}
 
-        std::string toString() override {
-            return "";
-        }
-
-        NodeType getType() override {
-            return NodeType::IndexExpression;
-        }
+        std::string toString() override;
 
         Token token;
-        unique_ptr <Expression> leftExpression;
-        unique_ptr <Expression> indexExpression;
+        NodePtr<Expression> leftExpression;
+        NodePtr<Expression> indexExpression;
     };
 
 
     struct PrefixExpression : Expression {
-        PrefixExpression(Token token, std::string prefixOperator, std::unique_ptr<Expression> rightExpression) : token{
-                std::move(
-                        token)}, prefixOperator{prefixOperator}, rightExpression{std::move(rightExpression)} {};
+        PrefixExpression(Token token, PrefixOperator prefixOperator, NodePtr<Expression> rightExpression) :
+                Expression{NodeType::PrefixExpression, token.line}, token{std::move(token)}, prefixOperator{prefixOperator},
+                rightExpression{std::move(rightExpression)} {};
 
         std::string toString() override;
 
-        NodeType getType() override { return NodeType::PrefixExpression; };
-
         Token token;
-        std::string prefixOperator;
-        std::unique_ptr<Expression> rightExpression;
+        PrefixOperator prefixOperator;
+        NodePtr<Expression> rightExpression;
     };
 
     struct BoolExpression : Expression {
-        BoolExpression(Token token, bool value) : token(std::move(token)), value{value} {}
+        BoolExpression(Token token, bool value) :
+                Expression{NodeType::BoolExpression, token.line}, token(std::move(token)), value{value} {}
 
         std::string toString() override {
-            return token.literal;
+            return std::string{token.literal};
         };
 
-        NodeType getType() override {
-            return NodeType::BoolExpression;
-        }
-
         Token token;
         bool value;
     };
@@ -164,143 +253,223 @@ namespace Common {
 
     struct IfExpression : Expression {
         IfExpression(Token token,
-                     std::unique_ptr<Expression> condition,
-                     std::unique_ptr<BlockStatement> consequences,
-                     std::unique_ptr<BlockStatement> alternative
-        ) : token{std::move(token)}, condition{std::move(condition)}, consequence{std::move(consequences)},
-            alternative{std::move(alternative)} {}
+                     NodePtr<Expression> condition,
+                     NodePtr<BlockStatement> consequences,
+                     NodePtr<BlockStatement> alternative
+        ) : Expression{NodeType::IfExpression, token.line}, token{std::move(token)}, condition{std::move(condition)},
+            consequence{std::move(consequences)}, alternative{std::move(alternative)} {}
 
         std::string toString() override;
 
-        NodeType getType() override { return NodeType::IfExpression; };
+        Token token;
+        NodePtr<Expression> condition;
+        NodePtr<BlockStatement> consequence;
+        NodePtr<BlockStatement> alternative;
+    };
+
+    // `patterns => body`, the `_` arm has no patterns
+    struct MatchArm {
+        std::vector<NodePtr<Expression>> patterns;
+        NodePtr<BlockStatement> body;
+    };
+
+    // match (subject) { 1, 2 => a, "x" => { b }, _ => c }. Patterns are literals, an arm is taken when
+    // the subject has the same type and value as one of its patterns. The `_` arm is taken when no
+    // pattern matches, wherever it is placed.
+    struct MatchExpression : Expression {
+        MatchExpression(Token token,
+                        NodePtr<Expression> subject,
+                        std::vector<MatchArm> arms
+        ) : Expression{NodeType::MatchExpression, token.line}, token{std::move(token)}, subject{std::move(subject)},
+            arms{std::move(arms)} {}
+
+        std::string toString() override;
 
         Token token;
-        std::unique_ptr<Expression> condition;
-        std::unique_ptr<BlockStatement> consequence;
-        std::unique_ptr<BlockStatement> alternative;
+        NodePtr<Expression> subject;
+        std::vector<MatchArm> arms;
     };
 
     struct FunctionExpression : Expression {
         FunctionExpression(Token token,
-                           std::vector<std::unique_ptr<Identifier>> parameters,
-                           std::unique_ptr<BlockStatement> body
-        ) : token{std::move(token)}, parameters{std::move(parameters)}, body{std::move(body)} {}
-
-        NodeType getType() override { return NodeType::FunctionExpression; };
+                           std::vector<NodePtr<Identifier>> parameters,
+                           std::shared_ptr<BlockStatement> body
+        ) : Expression{NodeType::FunctionExpression, token.line}, token{std::move(token)}, parameters{std::move(parameters)},
+            body{std::move(body)} {}
 
         std::string toString() override;
 
         Token token;
-        string name{""};
-        std::vector<std::unique_ptr<Identifier>> parameters;
-        std::unique_ptr<BlockStatement> body;
+        // set when the function is bound by a let statement, so the body can refer to itself
+        std::optional<SymbolId> name;
+        std::vector<NodePtr<Identifier>> parameters;
+        // shared with the function objects the evaluator creates from this expression, it keeps the
+        // storage of its program alive
+        std::shared_ptr<BlockStatement> body;
+        // size of the environment the evaluator creates for a call, parameters and locals. Set by GI::resolve.
+        std::uint32_t slots{0};
     };
 
     struct Statement : Node {
-        std::string toString() override = 0;
+        Statement(NodeType type, std::uint32_t line) : Node{type, line} {}
 
-        NodeType getType() override = 0;
+        std::string toString() override = 0;
 
         ~Statement() override = default;
     };
 
     struct LetStatement : Statement {
-        LetStatement(Token token, std::unique_ptr<Identifier> name, std::unique_ptr<Expression> value)
-                : token{std::move(token)}, name{std::move(name)}, value{std::move(value)} {}
+        LetStatement(Token token, NodePtr<Identifier> name, NodePtr<Expression> value)
+                : Statement{NodeType::LetStatement, token.line}, token{std::move(token)}, name{std::move(name)},
+                  value{std::move(value)} {}
 
         std::string toString() override;
 
-        NodeType getType() override {
-            return NodeType::LetStatement;
-        }
-
         Token token;
-        std::unique_ptr<Identifier> name;
-        std::unique_ptr<Expression> value;
+        NodePtr<Identifier> name;
+        NodePtr<Expression> value;
     };
 
     struct BlockStatement : Statement {
         BlockStatement(Token token,
-                       std::vector<std::unique_ptr<Statement>> statements) :
+                       std::vector<NodePtr<Statement>> statements) :
+                Statement{NodeType::BlockStatement, token.line},
                 token{std::move(token)},
                 statements{std::move(statements)} {}
 
-        NodeType getType() override { return NodeType::BlockStatement; };
-
         std::string toString() override;
 
         Token token;
-        std::vector<std::unique_ptr<Statement>> statements;
+        std::vector<NodePtr<Statement>> statements;
     };
 
     struct ReturnStatement : Statement {
-        ReturnStatement(Token token, std::unique_ptr<Expression> returnValue) : token{
-                std::move(token)}, returnValue{std::move(returnValue)} {};
-
-        NodeType getType() override { return NodeType::ReturnStatement; };
+        ReturnStatement(Token token, NodePtr<Expression> returnValue) :
+                Statement{NodeType::ReturnStatement, token.line}, token{std::move(token)}, returnValue{std::move(returnValue)} {};
 
         std::string toString() override;
 
         Token token;
-        std::unique_ptr<Expression> returnValue;
+        NodePtr<Expression> returnValue;
     };
 
     struct ExpressionStatement : Statement {
         ExpressionStatement(
                 Token token,
-                std::unique_ptr<Expression> expression
-        ) : token{std::move(token)}, expression{std::move(expression)} {}
+                NodePtr<Expression> expression
+        ) : Statement{NodeType::ExpressionStatement, token.line}, token{std::move(token)}, expression{std::move(expression)} {}
+
+        std::string toString() override;
 
-        NodeType getType() override { return NodeType::ExpressionStatement; };
+        Token token;
+        NodePtr<Expression> expression;
+    };
+
+    // target = value, the target is an identifier or an index expression like `arr[i]` or `hash[key][i]`
+    struct AssignStatement : Statement {
+        AssignStatement(
+                Token token,
+                NodePtr<Expression> target,
+                NodePtr<Expression> value
+        ) : Statement{NodeType::AssignStatement, token.line}, token{std::move(token)}, target{std::move(target)},
+            value{std::move(value)} {}
 
         std::string toString() override;
 
         Token token;
-        std::unique_ptr<Expression> expression;
+        NodePtr<Expression> target;
+        NodePtr<Expression> value;
+    };
+
+    struct WhileStatement : Statement {
+        WhileStatement(
+                Token token,
+                NodePtr<Expression> condition,
+                NodePtr<BlockStatement> body
+        ) : Statement{NodeType::WhileStatement, token.line}, token{std::move(token)}, condition{std::move(condition)},
+            body{std::move(body)} {}
+
+        std::string toString() override;
+
+        Token token;
+        NodePtr<Expression> condition;
+        NodePtr<BlockStatement> body;
+    };
+
+    // for (variable in iterable) { body }
+    struct ForStatement : Statement {
+        ForStatement(
+                Token token,
+                NodePtr<Identifier> variable,
+                NodePtr<Expression> iterable,
+                NodePtr<BlockStatement> body
+        ) : Statement{NodeType::ForStatement, token.line}, token{std::move(token)}, variable{std::move(variable)},
+            iterable{std::move(iterable)}, body{std::move(body)} {}
+
+        std::string toString() override;
+
+        Token token;
+        NodePtr<Identifier> variable;
+        NodePtr<Expression> iterable;
+        NodePtr<BlockStatement> body;
     };
 
     struct InfixExpression : Expression {
         InfixExpression(Token token,
-                        std::unique_ptr<Expression> leftExpression,
-                        std::unique_ptr<Expression> rightExpression,
-                        std::string infixOperator
-        ) : token(std::move(token)), leftExpression{std::move(leftExpression)},
-            rightExpression{std::move(rightExpression)},
-            infixOperator{std::move(infixOperator)} {};
-
-        NodeType getType() override { return NodeType::InfixExpression; };
+                        InfixOperator infixOperator,
+                        NodePtr<Expression> leftExpression,
+                        NodePtr<Expression> rightExpression
+        ) : Expression{NodeType::InfixExpression, token.line}, token(std::move(token)), infixOperator{infixOperator},
+            leftExpression{std::move(leftExpression)}, rightExpression{std::move(rightExpression)} {};
 
         std::string toString() override;
 
         Token token;
-        std::unique_ptr<Expression> leftExpression;
-        std::unique_ptr<Expression> rightExpression;
-        std::string infixOperator;
+        InfixOperator infixOperator;
+        NodePtr<Expression> leftExpression;
+        NodePtr<Expression> rightExpression;
     };
 
     struct CallExpression : Expression {
         CallExpression(Token token,
-                       std::unique_ptr<Expression> name,
-                       std::vector<std::unique_ptr<Expression>> arguments
-        ) : token{std::move(token)}, name{std::move(name)}, arguments{std::move(arguments)} {};
-
-        NodeType getType() override { return NodeType::CallExpression; };
+                       NodePtr<Expression> name,
+                       std::vector<NodePtr<Expression>> arguments
+        ) : Expression{NodeType::CallExpression, token.line}, token{std::move(token)}, name{std::move(name)},
+            arguments{std::move(arguments)} {};
 
         std::string toString() override;
 
         Token token;
-        std::unique_ptr<Expression> name;
-        std::vector<std::unique_ptr<Expression>> arguments;
+        NodePtr<Expression> name;
+        std::vector<NodePtr<Expression>> arguments;
     };
 
-    struct Program : Node {
-        explicit Program(std::vector<std::unique_ptr<Statement>> statements) : statements{std::move(statements)} {}
+    // where a top level statement starts in the program text and the storage its nodes live in, which is an
+    // earlier version's storage for statements reused by Parser::reparse
+    struct StatementOrigin {
+        std::size_t offset;
+        std::uint32_t line;
+        // added to the lines recorded in the statement's nodes, they are those of the version it was parsed in
+        std::int32_t lineShift;
+        std::shared_ptr<SyntaxStorage> storage;
+    };
 
-        NodeType getType() override { return NodeType::Program; };
+    struct Program : Node {
+        Program(std::shared_ptr<SyntaxStorage> storage, std::vector<NodePtr<Statement>> statements,
+                std::vector<StatementOrigin> origins = {}) :
+                Node{NodeType::Program, 0}, storage{std::move(storage)}, origins{std::move(origins)},
+                statements{std::move(statements)} {}
 
         std::string toString() override;
 
-        std::vector<std::unique_ptr<Statement>> statements;
+        // storage of the nodes parsed for this program, its source is the whole program text
+        std::shared_ptr<SyntaxStorage> storage;
+        // one per statement when the program comes from the parser
+        std::vector<StatementOrigin> origins;
+        // messages of the syntax errors found by the parser, the statements are incomplete when there are any
+        std::vector<std::string> errors;
+        // declared last, the statements are destroyed before their arenas
+        std::vector<NodePtr<Statement>> statements;
     };
 
 }
@@ -0,0 +1,348 @@
+//
+// Created by seeu on 2022/8/30.
+//
+
+#include "BigInt.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace Common {
+
+    // below this many limbs on the shorter operand schoolbook multiplication is faster than karatsuba
+    constexpr std::size_t KARATSUBA_THRESHOLD = 32;
+
+    constexpr std::uint64_t LIMB_BASE = std::uint64_t{1} << 32;
+
+    BigInt::BigInt(std::int64_t value) : negative{value < 0} {
+        // negate in unsigned arithmetic so INT64_MIN works
+        auto magnitude = negative ? ~std::uint64_t(value) + 1 : std::uint64_t(value);
+        while (magnitude != 0) {
+            limbs.push_back(std::uint32_t(magnitude));
+            magnitude >>= 32;
+        }
+    }
+
+    BigInt::BigInt(bool negative, Limbs limbs) : negative{negative}, limbs{std::move(limbs)} {
+        trim(this->limbs);
+        if (this->limbs.empty()) {
+            this->negative = false;
+        }
+    }
+
+    std::optional<BigInt> BigInt::fromDecimal(std::string_view digits) {
+        if (digits.empty()) {
+            return std::nullopt;
+        }
+        Limbs limbs;
+        for (auto digit: digits) {
+            if (digit < '0' || digit > '9') {
+                return std::nullopt;
+            }
+            // limbs = limbs * 10 + digit
+            std::uint64_t carry = std::uint64_t(digit - '0');
+            for (auto &limb: limbs) {
+                auto current = std::uint64_t(limb) * 10 + carry;
+                limb = std::uint32_t(current);
+                carry = current >> 32;
+            }
+            if (carry != 0) {
+                limbs.push_back(std::uint32_t(carry));
+            }
+        }
+        return BigInt{false, std::move(limbs)};
+    }
+
+    std::optional<std::int64_t> BigInt::toInt64() const {
+        if (limbs.size() > 2) {
+            return std::nullopt;
+        }
+        std::uint64_t magnitude = 0;
+        for (auto i = limbs.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | limbs[i];
+        }
+        if (negative) {
+            if (magnitude > std::uint64_t{1} << 63) {
+                return std::nullopt;
+            }
+            return std::int64_t(~magnitude + 1);
+        }
+        if (magnitude >= std::uint64_t{1} << 63) {
+            return std::nullopt;
+        }
+        return std::int64_t(magnitude);
+    }
+
+    double BigInt::toDouble() const {
+        double result = 0;
+        for (auto i = limbs.size(); i-- > 0;) {
+            result = result * double(LIMB_BASE) + limbs[i];
+        }
+        return negative ? -result : result;
+    }
+
+    std::string BigInt::toString() const {
+        if (isZero()) {
+            return "0";
+        }
+        // peel off 9 decimal digits at a time
+        std::vector<std::uint32_t> chunks;
+        auto rest = limbs;
+        while (!rest.empty()) {
+            std::uint64_t remainder = 0;
+            for (auto i = rest.size(); i-- > 0;) {
+                auto current = (remainder << 32) | rest[i];
+                rest[i] = std::uint32_t(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            trim(rest);
+            chunks.push_back(std::uint32_t(remainder));
+        }
+        std::string result = negative ? "-" : "";
+        result += std::to_string(chunks.back());
+        for (auto i = chunks.size() - 1; i-- > 0;) {
+            auto digits = std::to_string(chunks[i]);
+            result.append(9 - digits.size(), '0').append(digits);
+        }
+        return result;
+    }
+
+    std::size_t BigInt::hash() const {
+        std::size_t result = negative;
+        for (auto limb: limbs) {
+            result = result * 31 + std::hash<std::uint32_t>{}(limb);
+        }
+        return result;
+    }
+
+    BigInt BigInt::operator-() const {
+        return {!negative, limbs};
+    }
+
+    BigInt operator+(const BigInt &left, const BigInt &right) {
+        return BigInt::addSigned(left.negative, left.limbs, right.negative, right.limbs);
+    }
+
+    BigInt operator-(const BigInt &left, const BigInt &right) {
+        return BigInt::addSigned(left.negative, left.limbs, !right.negative, right.limbs);
+    }
+
+    BigInt operator*(const BigInt &left, const BigInt &right) {
+        return {left.negative != right.negative, BigInt::mulMagnitude(left.limbs, right.limbs)};
+    }
+
+    std::pair<BigInt, BigInt> BigInt::divMod(const BigInt &dividend, const BigInt &divisor) {
+        auto [quotient, remainder] = divModMagnitude(dividend.limbs, divisor.limbs);
+        return {BigInt{dividend.negative != divisor.negative, std::move(quotient)},
+                BigInt{dividend.negative, std::move(remainder)}};
+    }
+
+    std::strong_ordering operator<=>(const BigInt &left, const BigInt &right) {
+        if (left.negative != right.negative) {
+            return left.negative ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        auto magnitude = BigInt::compareMagnitude(left.limbs, right.limbs);
+        if (left.negative) {
+            magnitude = -magnitude;
+        }
+        return magnitude <=> 0;
+    }
+
+    int BigInt::compareMagnitude(const Limbs &left, const Limbs &right) {
+        if (left.size() != right.size()) {
+            return left.size() < right.size() ? -1 : 1;
+        }
+        for (auto i = left.size(); i-- > 0;) {
+            if (left[i] != right[i]) {
+                return left[i] < right[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    BigInt BigInt::addSigned(bool leftNegative, const Limbs &left, bool rightNegative, const Limbs &right) {
+        if (leftNegative == rightNegative) {
+            return {leftNegative, addMagnitude(left, right)};
+        }
+        if (compareMagnitude(left, right) >= 0) {
+            return {leftNegative, subMagnitude(left, right)};
+        }
+        return {rightNegative, subMagnitude(right, left)};
+    }
+
+    BigInt::Limbs BigInt::addMagnitude(const Limbs &left, const Limbs &right) {
+        auto &longer = left.size() >= right.size() ? left : right;
+        auto &shorter = left.size() >= right.size() ? right : left;
+        Limbs result(longer.size() + 1);
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < longer.size(); i++) {
+            auto sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+            result[i] = std::uint32_t(sum);
+            carry = sum >> 32;
+        }
+        result[longer.size()] = std::uint32_t(carry);
+        trim(result);
+        return result;
+    }
+
+    BigInt::Limbs BigInt::subMagnitude(const Limbs &left, const Limbs &right) {
+        Limbs result(left.size());
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < left.size(); i++) {
+            auto difference = std::int64_t(left[i]) - borrow - (i < right.size() ? std::int64_t(right[i]) : 0);
+            borrow = difference < 0;
+            result[i] = std::uint32_t(difference + (borrow ? std::int64_t(LIMB_BASE) : 0));
+        }
+        trim(result);
+        return result;
+    }
+
+    BigInt::Limbs BigInt::mulMagnitude(const Limbs &left, const Limbs &right) {
+        if (left.empty() || right.empty()) {
+            return {};
+        }
+        if (std::min(left.size(), right.size()) < KARATSUBA_THRESHOLD) {
+            return schoolbookMul(left, right);
+        }
+        return karatsubaMul(left, right);
+    }
+
+    BigInt::Limbs BigInt::schoolbookMul(const Limbs &left, const Limbs &right) {
+        Limbs result(left.size() + right.size());
+        for (std::size_t i = 0; i < left.size(); i++) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j < right.size(); j++) {
+                auto product = std::uint64_t(left[i]) * right[j] + result[i + j] + carry;
+                result[i + j] = std::uint32_t(product);
+                carry = product >> 32;
+            }
+            result[i + right.size()] = std::uint32_t(carry);
+        }
+        trim(result);
+        return result;
+    }
+
+    BigInt::Limbs BigInt::karatsubaMul(const Limbs &left, const Limbs &right) {
+        // left = a1 * B^half + a0, right = b1 * B^half + b0
+        auto half = std::max(left.size(), right.size()) / 2;
+        auto split = [half](const Limbs &limbs) {
+            auto middle = limbs.begin() + long(std::min(half, limbs.size()));
+            Limbs low{limbs.begin(), middle};
+            Limbs high{middle, limbs.end()};
+            trim(low);
+            return std::make_pair(std::move(low), std::move(high));
+        };
+        auto [a0, a1] = split(left);
+        auto [b0, b1] = split(right);
+
+        auto z0 = mulMagnitude(a0, b0);
+        auto z2 = mulMagnitude(a1, b1);
+        // (a0 + a1)(b0 + b1) - z0 - z2 = a0 * b1 + a1 * b0
+        auto z1 = subMagnitude(subMagnitude(mulMagnitude(addMagnitude(a0, a1), addMagnitude(b0, b1)), z0), z2);
+
+        Limbs result(left.size() + right.size() + 1);
+        auto addAt = [&result](const Limbs &limbs, std::size_t offset) {
+            std::uint64_t carry = 0;
+            std::size_t i = 0;
+            for (; i < limbs.size() || carry != 0; i++) {
+                auto sum = std::uint64_t(result[offset + i]) + (i < limbs.size() ? limbs[i] : 0) + carry;
+                result[offset + i] = std::uint32_t(sum);
+                carry = sum >> 32;
+            }
+        };
+        addAt(z0, 0);
+        addAt(z1, half);
+        addAt(z2, half * 2);
+        trim(result);
+        return result;
+    }
+
+    std::pair<BigInt::Limbs, BigInt::Limbs> BigInt::divModMagnitude(const Limbs &dividend, const Limbs &divisor) {
+        if (compareMagnitude(dividend, divisor) < 0) {
+            return {{}, dividend};
+        }
+        if (divisor.size() == 1) {
+            Limbs quotient(dividend.size());
+            std::uint64_t remainder = 0;
+            for (auto i = dividend.size(); i-- > 0;) {
+                auto current = (remainder << 32) | dividend[i];
+                quotient[i] = std::uint32_t(current / divisor[0]);
+                remainder = current % divisor[0];
+            }
+            trim(quotient);
+            Limbs rest{std::uint32_t(remainder)};
+            trim(rest);
+            return {std::move(quotient), std::move(rest)};
+        }
+
+        // Knuth's algorithm D: normalize so the top divisor limb has its high bit set, then estimate each
+        // quotient limb from the top two limbs and correct it at most twice
+        auto n = divisor.size();
+        auto m = dividend.size() - n;
+        auto shift = std::countl_zero(divisor.back());
+        Limbs v(n);
+        Limbs u(dividend.size() + 1);
+        for (auto i = n; i-- > 1;) {
+            v[i] = shift == 0 ? divisor[i] : (divisor[i] << shift) | (divisor[i - 1] >> (32 - shift));
+        }
+        v[0] = divisor[0] << shift;
+        u[dividend.size()] = shift == 0 ? 0 : dividend.back() >> (32 - shift);
+        for (auto i = dividend.size(); i-- > 1;) {
+            u[i] = shift == 0 ? dividend[i] : (dividend[i] << shift) | (dividend[i - 1] >> (32 - shift));
+        }
+        u[0] = dividend[0] << shift;
+
+        Limbs quotient(m + 1);
+        for (auto j = m + 1; j-- > 0;) {
+            auto numerator = (std::uint64_t(u[j + n]) << 32) | u[j + n - 1];
+            auto qhat = numerator / v[n - 1];
+            auto rhat = numerator % v[n - 1];
+            while (qhat >= LIMB_BASE || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+                qhat--;
+                rhat += v[n - 1];
+                if (rhat >= LIMB_BASE) {
+                    break;
+                }
+            }
+
+            // u[j..j+n] -= qhat * v
+            std::int64_t borrow = 0;
+            std::int64_t t;
+            for (std::size_t i = 0; i < n; i++) {
+                auto product = qhat * v[i];
+                t = std::int64_t(u[i + j]) - borrow - std::int64_t(product & 0xFFFFFFFF);
+                u[i + j] = std::uint32_t(t);
+                borrow = std::int64_t(product >> 32) - (t >> 32);
+            }
+            t = std::int64_t(u[j + n]) - borrow;
+            u[j + n] = std::uint32_t(t);
+
+            quotient[j] = std::uint32_t(qhat);
+            if (t < 0) {
+                // qhat was one too large, add the divisor back
+                quotient[j]--;
+                std::uint64_t carry = 0;
+                for (std::size_t i = 0; i < n; i++) {
+                    auto sum = std::uint64_t(u[i + j]) + v[i] + carry;
+                    u[i + j] = std::uint32_t(sum);
+                    carry = sum >> 32;
+                }
+                u[j + n] = std::uint32_t(std::uint64_t(u[j + n]) + carry);
+            }
+        }
+
+        Limbs remainder(n);
+        for (std::size_t i = 0; i < n; i++) {
+            remainder[i] = shift == 0 ? u[i] : (u[i] >> shift) | (u[i + 1] << (32 - shift));
+        }
+        trim(quotient);
+        trim(remainder);
+        return {std::move(quotient), std::move(remainder)};
+    }
+
+    void BigInt::trim(Limbs &limbs) {
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+    }
+}
@@ -0,0 +1,89 @@
+//
+// Created by seeu on 2022/8/30.
+//
+
+#ifndef GOINTERPRETER_BIGINT_H
+#define GOINTERPRETER_BIGINT_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+    // Arbitrary precision integer stored as sign and magnitude, the magnitude is a vector of 32-bit limbs with the
+    // least significant limb first and no leading zero limbs. Zero has no limbs and is never negative.
+    class BigInt {
+    public:
+        BigInt() = default;
+
+        explicit BigInt(std::int64_t value);
+
+        // non-negative value of a string of decimal digits, nullopt when it contains anything else
+        static std::optional<BigInt> fromDecimal(std::string_view digits);
+
+        bool isZero() const { return limbs.empty(); }
+
+        bool isNegative() const { return negative; }
+
+        // the value when it fits into an int64
+        std::optional<std::int64_t> toInt64() const;
+
+        std::string toString() const;
+
+        // nearest double, may be infinite for huge values
+        double toDouble() const;
+
+        std::size_t hash() const;
+
+        BigInt operator-() const;
+
+        friend BigInt operator+(const BigInt &left, const BigInt &right);
+
+        friend BigInt operator-(const BigInt &left, const BigInt &right);
+
+        friend BigInt operator*(const BigInt &left, const BigInt &right);
+
+        // quotient truncated toward zero and the remainder with the sign of the dividend, divisor must not be zero
+        static std::pair<BigInt, BigInt> divMod(const BigInt &dividend, const BigInt &divisor);
+
+        friend std::strong_ordering operator<=>(const BigInt &left, const BigInt &right);
+
+        friend bool operator==(const BigInt &left, const BigInt &right) = default;
+
+    private:
+        using Limbs = std::vector<std::uint32_t>;
+
+        BigInt(bool negative, Limbs limbs);
+
+        static int compareMagnitude(const Limbs &left, const Limbs &right);
+
+        static Limbs addMagnitude(const Limbs &left, const Limbs &right);
+
+        // left - right, left must not be smaller than right
+        static Limbs subMagnitude(const Limbs &left, const Limbs &right);
+
+        static Limbs mulMagnitude(const Limbs &left, const Limbs &right);
+
+        static Limbs schoolbookMul(const Limbs &left, const Limbs &right);
+
+        static Limbs karatsubaMul(const Limbs &left, const Limbs &right);
+
+        static std::pair<Limbs, Limbs> divModMagnitude(const Limbs &dividend, const Limbs &divisor);
+
+        static void trim(Limbs &limbs);
+
+        // signed sum of two magnitudes
+        static BigInt addSigned(bool leftNegative, const Limbs &left, bool rightNegative, const Limbs &right);
+
+        bool negative{false};
+        Limbs limbs;
+    };
+}
+
+#endif //GOINTERPRETER_BIGINT_H
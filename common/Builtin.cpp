@@ -5,9 +5,19 @@
 #include "Builtin.h"
 #include "fmt/format.h"
 #include "magic_enum.hpp"
+#include "Simd.h"
+#include "Arithmetic.h"
+#include "Iterator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <limits>
 
 namespace Common {
-    std::unique_ptr<GIObject> evalBuiltinLen(BuiltinArguments arguments) {
+    std::shared_ptr<GIObject> evalBuiltinLen(BuiltinArguments arguments, FunctionCaller &) {
         if (arguments.size() != 1) {
             return makeErrorObject("len() arguments size not match: " + std::to_string(arguments.size()));
         }
@@ -19,7 +29,7 @@ namespace Common {
             }
             case ObjectType::ARRAY: {
                 auto arrayObject = static_cast<ArrayObject *>(arg);
-                return std::make_unique<IntegerObject>(arrayObject->elements.size());
+                return std::make_unique<IntegerObject>(arrayObject->size());
             }
             default:
                 return makeErrorObject(
@@ -27,11 +37,777 @@ namespace Common {
         }
     }
 
-    std::unique_ptr<GIObject> evalBuiltin(string name, BuiltinArguments args) {
-        if (name == "len") {
-            return evalBuiltinLen(args);
+    // resolve `from` and optional `to` arguments into a clamped [from, to) range of a sequence with given size
+    std::optional<std::pair<std::size_t, std::size_t>>
+    sliceRange(BuiltinArguments arguments, std::size_t size) {
+        auto clamp = [size](GIObject *arg) -> std::optional<std::size_t> {
+            if (arg->getType() != ObjectType::INTEGER) {
+                return std::nullopt;
+            }
+            auto value = static_cast<IntegerObject *>(arg)->value;
+            return std::clamp<std::size_t>(value < 0 ? 0 : value, 0, size);
+        };
+        auto from = clamp(arguments[1].get());
+        auto to = arguments.size() == 3 ? clamp(arguments[2].get()) : size;
+        if (!from.has_value() || !to.has_value()) {
+            return std::nullopt;
+        }
+        return std::make_pair(*from, std::max(*from, *to));
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinSlice(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.size() != 2 && arguments.size() != 3) {
+            return makeErrorObject("slice() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        auto arg = arguments[0].get();
+        if (arg->getType() != ObjectType::ARRAY) {
+            return makeErrorObject(
+                    fmt::format("slice() argument type is not support: {}", magic_enum::enum_name(arg->getType())));
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arg);
+        auto range = sliceRange(arguments, arrayObject->size());
+        if (!range.has_value()) {
+            return makeErrorObject("slice() range must be integer");
+        }
+        return arrayObject->slice(range->first, range->second);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinSubstr(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.size() != 2 && arguments.size() != 3) {
+            return makeErrorObject("substr() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        auto arg = arguments[0].get();
+        if (arg->getType() != ObjectType::STRING) {
+            return makeErrorObject(
+                    fmt::format("substr() argument type is not support: {}", magic_enum::enum_name(arg->getType())));
+        }
+        auto stringObject = static_cast<StringObject *>(arg);
+        auto range = sliceRange(arguments, stringObject->value.size());
+        if (!range.has_value()) {
+            return makeErrorObject("substr() range must be integer");
+        }
+        return stringObject->substr(range->first, range->second);
+    }
+
+    std::shared_ptr<GIObject> checkArrayArgument(std::string_view name, BuiltinArguments arguments,
+                                                 std::size_t argumentsSize) {
+        if (arguments.size() != argumentsSize) {
+            return makeErrorObject(fmt::format("{}() arguments size not match: {}", name, arguments.size()));
+        }
+        if (arguments[0]->getType() != ObjectType::ARRAY) {
+            return makeErrorObject(fmt::format("{}() argument type is not support: {}", name,
+                                               magic_enum::enum_name(arguments[0]->getType())));
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinFirst(BuiltinArguments arguments, FunctionCaller &) {
+        if (auto error = checkArrayArgument("first", arguments, 1)) {
+            return error;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        if (arrayObject->size() == 0) {
+            return std::make_shared<NullObject>();
+        }
+        return arrayObject->at(0);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinLast(BuiltinArguments arguments, FunctionCaller &) {
+        if (auto error = checkArrayArgument("last", arguments, 1)) {
+            return error;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        if (arrayObject->size() == 0) {
+            return std::make_shared<NullObject>();
+        }
+        return arrayObject->at(arrayObject->size() - 1);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinRest(BuiltinArguments arguments, FunctionCaller &) {
+        if (auto error = checkArrayArgument("rest", arguments, 1)) {
+            return error;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        if (arrayObject->size() == 0) {
+            return std::make_shared<NullObject>();
+        }
+        return arrayObject->slice(1, arrayObject->size());
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinPush(BuiltinArguments arguments, FunctionCaller &) {
+        if (auto error = checkArrayArgument("push", arguments, 2)) {
+            return error;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        return arrayObject->push(arguments[1]);
+    }
+
+    // integer array argument as a packed array, boxed arrays holding only integers are packed on the fly
+    std::shared_ptr<ArrayObject> packedArrayArgument(const std::shared_ptr<GIObject> &argument) {
+        if (argument->getType() != ObjectType::ARRAY) {
+            return nullptr;
+        }
+        auto arrayObject = std::static_pointer_cast<ArrayObject>(argument);
+        if (arrayObject->isPacked()) {
+            return arrayObject;
+        }
+        auto packed = std::make_shared<ArrayObject>(ArrayObject::Elements{arrayObject->begin(), arrayObject->end()});
+        return packed->isPacked() ? packed : nullptr;
+    }
+
+    // visit the unboxed integers of a packed array one contiguous chunk at a time
+    template<typename F>
+    void forEachChunk(const ArrayObject &arrayObject, F visit) {
+        for (std::size_t index = 0; index < arrayObject.size();) {
+            auto [data, size] = arrayObject.packedChunkAt(index);
+            visit(data, size);
+            index += size;
+        }
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinPuts(BuiltinArguments arguments, FunctionCaller &) {
+        for (auto &arg: arguments) {
+            std::cout << arg->inspect() << std::endl;
+        }
+        return std::make_shared<NullObject>();
+    }
+
+    // the first argument as an integer array, or an error object when there are not `argumentsSize` arguments
+    std::shared_ptr<GIObject> integerArrayArgument(std::string_view name, BuiltinArguments arguments,
+                                                   std::size_t argumentsSize) {
+        if (arguments.size() != argumentsSize) {
+            return makeErrorObject(fmt::format("{}() arguments size not match: {}", name, arguments.size()));
+        }
+        auto arrayObject = packedArrayArgument(arguments[0]);
+        if (arrayObject == nullptr) {
+            return makeErrorObject(fmt::format("{}() argument must be an integer array", name));
+        }
+        return arrayObject;
+    }
+
+    // sum of two partial results, nullopt when either overflowed already or their sum does
+    std::optional<std::int64_t> addChecked(std::int64_t left, std::optional<std::int64_t> right) {
+        std::int64_t result;
+        if (!right.has_value() || __builtin_add_overflow(left, *right, &result)) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinSum(BuiltinArguments arguments, FunctionCaller &) {
+        auto array = integerArrayArgument("sum", arguments, 1);
+        if (array->getType() == ObjectType::ERROR) {
+            return array;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(array.get());
+        std::optional<std::int64_t> result = 0;
+        forEachChunk(*arrayObject, [&](const std::int64_t *data, std::size_t size) {
+            if (result.has_value()) {
+                result = addChecked(*result, Simd::sum(data, size));
+            }
+        });
+        if (result.has_value()) {
+            return std::make_shared<IntegerObject>(*result);
+        }
+        // overflowed, like + the sum is a big integer then
+        BigInt total;
+        forEachChunk(*arrayObject, [&](const std::int64_t *data, std::size_t size) {
+            for (std::size_t i = 0; i < size; i++) {
+                total = total + BigInt{data[i]};
+            }
+        });
+        return makeIntegerObject(total);
+    }
+
+    template<bool IsMin>
+    std::shared_ptr<GIObject> evalBuiltinExtreme(BuiltinArguments arguments, FunctionCaller &) {
+        auto array = integerArrayArgument(IsMin ? "min" : "max", arguments, 1);
+        if (array->getType() == ObjectType::ERROR) {
+            return array;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(array.get());
+        if (arrayObject->size() == 0) {
+            return std::make_shared<NullObject>();
+        }
+        auto result = arrayObject->packedChunkAt(0).first[0];
+        forEachChunk(*arrayObject, [&](const std::int64_t *data, std::size_t size) {
+            result = IsMin ? std::min(result, Simd::min(data, size)) : std::max(result, Simd::max(data, size));
+        });
+        return std::make_shared<IntegerObject>(result);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinDot(BuiltinArguments arguments, FunctionCaller &) {
+        auto array = integerArrayArgument("dot", arguments, 2);
+        if (array->getType() == ObjectType::ERROR) {
+            return array;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(array.get());
+        auto other = packedArrayArgument(arguments[1]);
+        if (other == nullptr) {
+            return makeErrorObject("dot() argument must be an integer array");
+        }
+        if (other->size() != arrayObject->size()) {
+            return makeErrorObject(fmt::format("dot() arrays size not match: {} and {}", arrayObject->size(),
+                                               other->size()));
+        }
+        std::optional<std::int64_t> result = 0;
+        for (std::size_t index = 0; index < arrayObject->size() && result.has_value();) {
+            auto [left, leftSize] = arrayObject->packedChunkAt(index);
+            auto [right, rightSize] = other->packedChunkAt(index);
+            auto size = std::min(leftSize, rightSize);
+            result = addChecked(*result, Simd::dot(left, right, size));
+            index += size;
+        }
+        if (result.has_value()) {
+            return std::make_shared<IntegerObject>(*result);
+        }
+        BigInt total;
+        for (std::size_t index = 0; index < arrayObject->size();) {
+            auto [left, leftSize] = arrayObject->packedChunkAt(index);
+            auto [right, rightSize] = other->packedChunkAt(index);
+            auto size = std::min(leftSize, rightSize);
+            for (std::size_t i = 0; i < size; i++) {
+                total = total + BigInt{left[i]} * BigInt{right[i]};
+            }
+            index += size;
+        }
+        return makeIntegerObject(total);
+    }
+
+    // map_add and filter_gt: an integer array and an integer in, a new packed array out
+    template<bool IsFilter>
+    std::shared_ptr<GIObject> evalBuiltinArrayScalar(BuiltinArguments arguments, FunctionCaller &) {
+        auto name = IsFilter ? "filter_gt" : "map_add";
+        auto array = integerArrayArgument(name, arguments, 2);
+        if (array->getType() == ObjectType::ERROR) {
+            return array;
+        }
+        if (arguments[1]->getType() != ObjectType::INTEGER) {
+            return makeErrorObject(fmt::format("{}() argument must be an integer", name));
+        }
+        auto arrayObject = static_cast<ArrayObject *>(array.get());
+        auto value = static_cast<IntegerObject *>(arguments[1].get())->value;
+        std::vector<std::int64_t> result(arrayObject->size());
+        std::size_t resultSize = 0;
+        bool overflow = false;
+        forEachChunk(*arrayObject, [&](const std::int64_t *data, std::size_t size) {
+            if (IsFilter) {
+                resultSize += Simd::filterGreater(data, size, value, result.data() + resultSize);
+            } else {
+                overflow |= !Simd::addScalar(data, size, value, result.data() + resultSize);
+                resultSize += size;
+            }
+        });
+        if (overflow) {
+            // a sum doesn't fit into an int64, add element by element so it is promoted like `+`
+            ArrayObject::Elements elements;
+            elements.reserve(arrayObject->size());
+            for (auto elem: *arrayObject) {
+                elements.push_back(integerArithmetic(ArithmeticOperator::Add, elem.get(), arguments[1].get()));
+            }
+            return std::make_shared<ArrayObject>(elements);
+        }
+        return std::make_shared<ArrayObject>(ArrayObject::PackedStorage{result.begin(), result.begin() + long(resultSize)},
+                                             0, resultSize);
+    }
+
+    // numbers of a number or of an array of numbers, nullopt for anything else
+    std::optional<std::vector<double>> numberArguments(GIObject *argument) {
+        if (isNumberType(argument->getType())) {
+            return std::vector<double>{toDouble(argument)};
+        }
+        if (argument->getType() != ObjectType::ARRAY) {
+            return std::nullopt;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(argument);
+        std::vector<double> values;
+        values.reserve(arrayObject->size());
+        for (auto elem: *arrayObject) {
+            if (!isNumberType(elem->getType())) {
+                return std::nullopt;
+            }
+            values.push_back(toDouble(elem.get()));
+        }
+        return values;
+    }
+
+    // a float for a number argument, an array of floats for an array argument
+    std::shared_ptr<GIObject> makeFloatResult(GIObject *argument, const std::vector<double> &values) {
+        if (argument->getType() != ObjectType::ARRAY) {
+            return std::make_shared<FloatObject>(values[0]);
+        }
+        ArrayObject::Elements elements;
+        elements.reserve(values.size());
+        for (auto value: values) {
+            elements.push_back(std::make_shared<FloatObject>(value));
+        }
+        return std::make_shared<ArrayObject>(elements);
+    }
+
+    // sqrt and floor, applied element wise to arrays
+    template<void (*Kernel)(const double *, std::size_t, double *)>
+    std::shared_ptr<GIObject> evalBuiltinMath(BuiltinArguments arguments, FunctionCaller &) {
+        auto name = Kernel == Simd::sqrt ? "sqrt" : "floor";
+        if (arguments.size() != 1) {
+            return makeErrorObject(fmt::format("{}() arguments size not match: {}", name, arguments.size()));
+        }
+        auto values = numberArguments(arguments[0].get());
+        if (!values.has_value()) {
+            return makeErrorObject(fmt::format("{}() argument must be a number or an array of numbers", name));
+        }
+        Kernel(values->data(), values->size(), values->data());
+        return makeFloatResult(arguments[0].get(), *values);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinPow(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.size() != 2) {
+            return makeErrorObject("pow() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        auto values = numberArguments(arguments[0].get());
+        if (!values.has_value() || !isNumberType(arguments[1]->getType())) {
+            return makeErrorObject("pow() arguments must be a number or an array of numbers and a number");
+        }
+        auto exponent = toDouble(arguments[1].get());
+        for (auto &value: *values) {
+            value = std::pow(value, exponent);
+        }
+        return makeFloatResult(arguments[0].get(), *values);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinRange(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.empty() || arguments.size() > 3) {
+            return makeErrorObject("range() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        std::int64_t bounds[3]{0, 0, 1};
+        for (std::size_t index = 0; index < arguments.size(); index++) {
+            if (arguments[index]->getType() != ObjectType::INTEGER) {
+                return makeErrorObject("range() arguments must be integer");
+            }
+            // range(end) counts from zero
+            bounds[arguments.size() == 1 ? 1 : index] = static_cast<IntegerObject *>(arguments[index].get())->value;
+        }
+        if (bounds[2] == 0) {
+            return makeErrorObject("range() step must not be zero");
+        }
+        return std::make_shared<RangeIteratorObject>(bounds[0], bounds[1], bounds[2]);
+    }
+
+    // the first argument as an iterator, or an error object when there are not `argumentsSize` arguments
+    std::shared_ptr<GIObject> iteratorArgument(std::string_view name, BuiltinArguments arguments,
+                                               std::size_t argumentsSize) {
+        if (arguments.size() != argumentsSize) {
+            return makeErrorObject(fmt::format("{}() arguments size not match: {}", name, arguments.size()));
+        }
+        auto iterator = makeIterator(arguments[0]);
+        if (iterator == nullptr) {
+            return makeErrorObject(fmt::format("{}() cannot iterate over {}", name,
+                                               magic_enum::enum_name(arguments[0]->getType())));
+        }
+        return iterator;
+    }
+
+    std::shared_ptr<GIObject> checkFunctionArgument(std::string_view name, GIObject *argument) {
+        auto type = argument->getType();
+        if (type != ObjectType::FUNCTION && type != ObjectType::CLOSURE && type != ObjectType::BUILTIN) {
+            return makeErrorObject(fmt::format("{}() argument is not a function: {}", name, magic_enum::enum_name(type)));
+        }
+        return nullptr;
+    }
+
+    template<typename Stage>
+    std::shared_ptr<GIObject> evalBuiltinStage(std::string_view name, BuiltinArguments arguments) {
+        auto source = iteratorArgument(name, arguments, 2);
+        if (source->getType() == ObjectType::ERROR) {
+            return source;
+        }
+        if (auto error = checkFunctionArgument(name, arguments[1].get())) {
+            return error;
+        }
+        return std::make_shared<Stage>(std::static_pointer_cast<IteratorObject>(source), arguments[1]);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinImap(BuiltinArguments arguments, FunctionCaller &) {
+        return evalBuiltinStage<MapIteratorObject>("imap", arguments);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinIfilter(BuiltinArguments arguments, FunctionCaller &) {
+        return evalBuiltinStage<FilterIteratorObject>("ifilter", arguments);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinTake(BuiltinArguments arguments, FunctionCaller &) {
+        auto source = iteratorArgument("take", arguments, 2);
+        if (source->getType() == ObjectType::ERROR) {
+            return source;
+        }
+        if (arguments[1]->getType() != ObjectType::INTEGER) {
+            return makeErrorObject("take() count must be integer");
+        }
+        return std::make_shared<TakeIteratorObject>(std::static_pointer_cast<IteratorObject>(source),
+                                                    static_cast<IntegerObject *>(arguments[1].get())->value);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinCollect(BuiltinArguments arguments, FunctionCaller &) {
+        auto source = iteratorArgument("collect", arguments, 1);
+        if (source->getType() == ObjectType::ERROR) {
+            return source;
+        }
+        return std::make_shared<CollectIteratorObject>(std::static_pointer_cast<IteratorObject>(source));
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinReduce(BuiltinArguments arguments, FunctionCaller &) {
+        auto source = iteratorArgument("reduce", arguments, 3);
+        if (source->getType() == ObjectType::ERROR) {
+            return source;
+        }
+        if (auto error = checkFunctionArgument("reduce", arguments[1].get())) {
+            return error;
+        }
+        return std::make_shared<ReduceIteratorObject>(std::static_pointer_cast<IteratorObject>(source),
+                                                      arguments[1], arguments[2]);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinMap(BuiltinArguments arguments, FunctionCaller &caller) {
+        if (auto error = checkArrayArgument("map", arguments, 2)) {
+            return error;
+        }
+        if (auto error = checkFunctionArgument("map", arguments[1].get())) {
+            return error;
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        std::vector<std::shared_ptr<GIObject>> elements;
+        elements.reserve(arrayObject->size());
+        for (auto element: *arrayObject) {
+            auto result = caller.call(arguments[1], {&element, 1});
+            if (result->getType() == ObjectType::ERROR) {
+                return result;
+            }
+            elements.push_back(std::move(result));
+        }
+        return std::make_shared<ArrayObject>(std::move(elements));
+    }
+
+    // NaN sorts after every other number so the order stays a strict weak ordering
+    bool numberLess(GIObject *left, GIObject *right) {
+        auto order = numberCompare(left, right);
+        if (order == std::partial_ordering::unordered) {
+            return !std::isnan(toDouble(left)) && std::isnan(toDouble(right));
+        }
+        return order < 0;
+    }
+
+    bool hasElementsOfType(const ArrayObject::Elements &elements, bool (*matches)(ObjectType)) {
+        return std::all_of(elements.begin(), elements.end(), [matches](auto &element) {
+            return matches(element->getType());
+        });
+    }
+
+    // sorted with the user comparator, one call at a time through the caller
+    std::shared_ptr<GIObject> sortWithComparator(ArrayObject::Elements elements,
+                                                 const std::shared_ptr<GIObject> &comparator, FunctionCaller &caller) {
+        std::shared_ptr<GIObject> error;
+        // stable_sort stays in bounds even when the comparator is not a strict weak ordering
+        std::stable_sort(elements.begin(), elements.end(), [&](auto &left, auto &right) {
+            if (error != nullptr) {
+                return false;
+            }
+            std::shared_ptr<GIObject> pair[2]{left, right};
+            auto result = caller.call(comparator, pair);
+            switch (result->getType()) {
+                case ObjectType::ERROR:
+                    error = std::move(result);
+                    return false;
+                case ObjectType::BOOLEAN:
+                    return static_cast<BooleanObject *>(result.get())->value;
+                default:
+                    error = makeErrorObject(fmt::format("sort() comparator must return a boolean, got {}",
+                                                        magic_enum::enum_name(result->getType())));
+                    return false;
+            }
+        });
+        if (error != nullptr) {
+            return error;
+        }
+        return std::make_shared<ArrayObject>(elements);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinSort(BuiltinArguments arguments, FunctionCaller &caller) {
+        if (arguments.size() != 1 && arguments.size() != 2) {
+            return makeErrorObject("sort() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        if (arguments[0]->getType() != ObjectType::ARRAY) {
+            return makeErrorObject(fmt::format("sort() argument type is not support: {}",
+                                               magic_enum::enum_name(arguments[0]->getType())));
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        if (arguments.size() == 2) {
+            if (auto error = checkFunctionArgument("sort", arguments[1].get())) {
+                return error;
+            }
+            return sortWithComparator({arrayObject->begin(), arrayObject->end()}, arguments[1], caller);
+        }
+
+        // packed integers are sorted unboxed
+        if (arrayObject->isPacked()) {
+            std::vector<std::int64_t> values;
+            values.reserve(arrayObject->size());
+            forEachChunk(*arrayObject, [&](const std::int64_t *data, std::size_t size) {
+                values.insert(values.end(), data, data + size);
+            });
+            parallelSort(values, std::less<>{});
+            return std::make_shared<ArrayObject>(ArrayObject::PackedStorage{values.begin(), values.end()}, 0,
+                                                 values.size());
+        }
+        ArrayObject::Elements elements{arrayObject->begin(), arrayObject->end()};
+        if (hasElementsOfType(elements, [](ObjectType type) { return type == ObjectType::STRING; })) {
+            parallelSort(elements, [](auto &left, auto &right) {
+                return static_cast<StringObject *>(left.get())->value < static_cast<StringObject *>(right.get())->value;
+            });
+        } else if (hasElementsOfType(elements, isNumberType)) {
+            parallelSort(elements, [](auto &left, auto &right) {
+                return numberLess(left.get(), right.get());
+            });
+        } else {
+            return makeErrorObject("sort() elements must all be numbers or all be strings, pass a comparator");
+        }
+        return std::make_shared<ArrayObject>(elements);
+    }
+
+    // the arguments as string views, or an error object when there are not `argumentsSize` strings
+    std::shared_ptr<GIObject> stringArguments(std::string_view name, BuiltinArguments arguments,
+                                              std::size_t argumentsSize, std::string_view *out) {
+        if (arguments.size() != argumentsSize) {
+            return makeErrorObject(fmt::format("{}() arguments size not match: {}", name, arguments.size()));
+        }
+        for (std::size_t index = 0; index < argumentsSize; index++) {
+            if (arguments[index]->getType() != ObjectType::STRING) {
+                return makeErrorObject(fmt::format("{}() argument must be a string, got {}", name,
+                                                   magic_enum::enum_name(arguments[index]->getType())));
+            }
+            out[index] = static_cast<StringObject *>(arguments[index].get())->value;
         }
         return nullptr;
     }
 
+    // position of needle in text at or after from, text.size() when there is none
+    std::size_t findIn(std::string_view text, std::string_view needle, std::size_t from = 0) {
+        return from + Simd::find(text.data() + from, text.size() - from, needle.data(), needle.size());
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinSplit(BuiltinArguments arguments, FunctionCaller &) {
+        std::string_view strings[2];
+        if (auto error = stringArguments("split", arguments, 2, strings)) {
+            return error;
+        }
+        auto [text, separator] = strings;
+        if (separator.empty()) {
+            return makeErrorObject("split() separator must not be empty");
+        }
+        // the parts are views into the buffer of the split string
+        auto stringObject = static_cast<StringObject *>(arguments[0].get());
+        ArrayObject::Elements parts;
+        std::size_t from = 0;
+        while (true) {
+            auto position = findIn(text, separator, from);
+            parts.push_back(stringObject->substr(from, position));
+            if (position == text.size()) {
+                break;
+            }
+            from = position + separator.size();
+        }
+        return std::make_shared<ArrayObject>(parts);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinJoin(BuiltinArguments arguments, FunctionCaller &) {
+        if (auto error = checkArrayArgument("join", arguments, 2)) {
+            return error;
+        }
+        if (arguments[1]->getType() != ObjectType::STRING) {
+            return makeErrorObject("join() separator must be a string");
+        }
+        auto arrayObject = static_cast<ArrayObject *>(arguments[0].get());
+        auto separator = static_cast<StringObject *>(arguments[1].get())->value;
+        // one pass to check the elements and size the output, one pass to copy
+        std::size_t size = arrayObject->size() > 0 ? separator.size() * (arrayObject->size() - 1) : 0;
+        for (auto element: *arrayObject) {
+            if (element->getType() != ObjectType::STRING) {
+                return makeErrorObject(fmt::format("join() elements must be strings, got {}",
+                                                   magic_enum::enum_name(element->getType())));
+            }
+            size += static_cast<StringObject *>(element.get())->value.size();
+        }
+        std::string result;
+        result.reserve(size);
+        for (auto it = arrayObject->begin(); it != arrayObject->end(); ++it) {
+            if (it != arrayObject->begin()) {
+                result.append(separator);
+            }
+            result.append(static_cast<StringObject *>((*it).get())->value);
+        }
+        return std::make_shared<StringObject>(std::move(result));
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinFind(BuiltinArguments arguments, FunctionCaller &) {
+        std::string_view strings[2];
+        if (auto error = stringArguments("find", arguments, 2, strings)) {
+            return error;
+        }
+        auto [text, needle] = strings;
+        auto position = findIn(text, needle);
+        if (position == text.size() && !needle.empty()) {
+            return std::make_shared<IntegerObject>(-1);
+        }
+        return std::make_shared<IntegerObject>(std::int64_t(position));
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinContains(BuiltinArguments arguments, FunctionCaller &) {
+        std::string_view strings[2];
+        if (auto error = stringArguments("contains", arguments, 2, strings)) {
+            return error;
+        }
+        return makeBoolObject(strings[1].empty() || findIn(strings[0], strings[1]) != strings[0].size());
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinReplace(BuiltinArguments arguments, FunctionCaller &) {
+        std::string_view strings[3];
+        if (auto error = stringArguments("replace", arguments, 3, strings)) {
+            return error;
+        }
+        auto [text, pattern, replacement] = strings;
+        if (pattern.empty()) {
+            return makeErrorObject("replace() pattern must not be empty");
+        }
+        auto position = findIn(text, pattern);
+        if (position == text.size()) {
+            return arguments[0];
+        }
+        std::string result;
+        result.reserve(text.size());
+        std::size_t from = 0;
+        while (position != text.size()) {
+            result.append(text.substr(from, position - from)).append(replacement);
+            from = position + pattern.size();
+            position = findIn(text, pattern, from);
+        }
+        result.append(text.substr(from));
+        return std::make_shared<StringObject>(std::move(result));
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinTrim(BuiltinArguments arguments, FunctionCaller &) {
+        std::string_view text;
+        if (auto error = stringArguments("trim", arguments, 1, &text)) {
+            return error;
+        }
+        constexpr std::string_view whitespace = " \t\n\r\f\v";
+        auto from = text.find_first_not_of(whitespace);
+        if (from == std::string_view::npos) {
+            return std::make_shared<StringObject>("");
+        }
+        auto to = text.find_last_not_of(whitespace) + 1;
+        return static_cast<StringObject *>(arguments[0].get())->substr(from, to);
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinBuilder(BuiltinArguments arguments, FunctionCaller &) {
+        if (!arguments.empty()) {
+            return makeErrorObject("builder() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        return std::make_shared<BuilderObject>();
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinAppend(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.size() < 2) {
+            return makeErrorObject("append() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        if (arguments[0]->getType() != ObjectType::BUILDER) {
+            return makeErrorObject(fmt::format("append() argument must be a builder, got {}",
+                                               magic_enum::enum_name(arguments[0]->getType())));
+        }
+        auto &buffer = static_cast<BuilderObject *>(arguments[0].get())->buffer;
+        for (auto &argument: arguments.subspan(1)) {
+            switch (argument->getType()) {
+                case ObjectType::STRING:
+                    buffer.append(static_cast<StringObject *>(argument.get())->value);
+                    break;
+                case ObjectType::INTEGER: {
+                    // format straight into the buffer
+                    auto size = buffer.size();
+                    buffer.resize(size + std::numeric_limits<std::int64_t>::digits10 + 2);
+                    auto result = std::to_chars(buffer.data() + size, buffer.data() + buffer.size(),
+                                                static_cast<IntegerObject *>(argument.get())->value);
+                    buffer.resize(result.ptr - buffer.data());
+                    break;
+                }
+                default:
+                    buffer.append(argument->inspect());
+                    break;
+            }
+        }
+        return arguments[0];
+    }
+
+    std::shared_ptr<GIObject> evalBuiltinBuild(BuiltinArguments arguments, FunctionCaller &) {
+        if (arguments.size() != 1) {
+            return makeErrorObject("build() arguments size not match: " + std::to_string(arguments.size()));
+        }
+        if (arguments[0]->getType() != ObjectType::BUILDER) {
+            return makeErrorObject(fmt::format("build() argument must be a builder, got {}",
+                                               magic_enum::enum_name(arguments[0]->getType())));
+        }
+        // the string takes over the buffer, the builder starts over empty
+        auto &buffer = static_cast<BuilderObject *>(arguments[0].get())->buffer;
+        auto result = std::make_shared<StringObject>(std::move(buffer));
+        buffer.clear();
+        return result;
+    }
+
+    constexpr std::array BUILTINS{
+            BuiltinDefinition{"len", evalBuiltinLen},
+            BuiltinDefinition{"slice", evalBuiltinSlice},
+            BuiltinDefinition{"substr", evalBuiltinSubstr},
+            BuiltinDefinition{"first", evalBuiltinFirst},
+            BuiltinDefinition{"last", evalBuiltinLast},
+            BuiltinDefinition{"rest", evalBuiltinRest},
+            BuiltinDefinition{"push", evalBuiltinPush},
+            BuiltinDefinition{"sum", evalBuiltinSum},
+            BuiltinDefinition{"min", evalBuiltinExtreme<true>},
+            BuiltinDefinition{"max", evalBuiltinExtreme<false>},
+            BuiltinDefinition{"dot", evalBuiltinDot},
+            BuiltinDefinition{"map_add", evalBuiltinArrayScalar<false>},
+            BuiltinDefinition{"filter_gt", evalBuiltinArrayScalar<true>},
+            BuiltinDefinition{"puts", evalBuiltinPuts},
+            BuiltinDefinition{"sqrt", evalBuiltinMath<Simd::sqrt>},
+            BuiltinDefinition{"floor", evalBuiltinMath<Simd::floor>},
+            BuiltinDefinition{"pow", evalBuiltinPow},
+            BuiltinDefinition{"range", evalBuiltinRange},
+            BuiltinDefinition{"imap", evalBuiltinImap},
+            BuiltinDefinition{"ifilter", evalBuiltinIfilter},
+            BuiltinDefinition{"take", evalBuiltinTake},
+            BuiltinDefinition{"collect", evalBuiltinCollect, true},
+            BuiltinDefinition{"reduce", evalBuiltinReduce, true},
+            BuiltinDefinition{"map", evalBuiltinMap},
+            BuiltinDefinition{"sort", evalBuiltinSort},
+            BuiltinDefinition{"split", evalBuiltinSplit},
+            BuiltinDefinition{"join", evalBuiltinJoin},
+            BuiltinDefinition{"find", evalBuiltinFind},
+            BuiltinDefinition{"contains", evalBuiltinContains},
+            BuiltinDefinition{"replace", evalBuiltinReplace},
+            BuiltinDefinition{"trim", evalBuiltinTrim},
+            BuiltinDefinition{"builder", evalBuiltinBuilder},
+            BuiltinDefinition{"append", evalBuiltinAppend},
+            BuiltinDefinition{"build", evalBuiltinBuild},
+    };
+
+    std::span<const BuiltinDefinition> builtinDefinitions() {
+        return BUILTINS;
+    }
+
+    std::optional<int> lookupBuiltin(std::string_view name) {
+        auto it = std::find_if(BUILTINS.begin(), BUILTINS.end(), [name](auto &builtin) {
+            return builtin.name == name;
+        });
+        if (it == BUILTINS.end()) {
+            return std::nullopt;
+        }
+        return int(it - BUILTINS.begin());
+    }
+
 }
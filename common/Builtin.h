@@ -6,13 +6,39 @@
 #define GOINTERPRETER_BUILTIN_H
 
 #include "GIObject.h"
+#include <optional>
+#include <span>
+#include <string_view>
 
 namespace Common {
     using namespace std;
 
-    using BuiltinArguments = std::vector<std::shared_ptr<GIObject>>;
+    // arguments are viewed in place, e.g. straight from the vm stack
+    using BuiltinArguments = std::span<const std::shared_ptr<GIObject>>;
 
-    std::unique_ptr<GIObject> evalBuiltin(string name, BuiltinArguments args);
+    // lets builtins call back into Monkey functions, implemented by the vm and by the evaluator
+    class FunctionCaller {
+    public:
+        virtual ~FunctionCaller() = default;
+
+        // function is a closure, a function or a builtin. Returns its result, or an error object when it failed.
+        virtual std::shared_ptr<GIObject> call(const std::shared_ptr<GIObject> &function, BuiltinArguments arguments) = 0;
+    };
+
+    using BuiltinFunction = std::shared_ptr<GIObject> (*)(BuiltinArguments arguments, FunctionCaller &caller);
+
+    struct BuiltinDefinition {
+        std::string_view name;
+        BuiltinFunction function;
+        // the function returns an iterator whose first element is the result of the call. The caller drives
+        // it, so the functions it asks for run in the caller instead of inside the builtin.
+        bool driven{false};
+    };
+
+    // all builtins, the position in this table is the builtin index used by the compiler and the vm
+    std::span<const BuiltinDefinition> builtinDefinitions();
+
+    std::optional<int> lookupBuiltin(std::string_view name);
 
 }
 
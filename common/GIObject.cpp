@@ -6,6 +6,167 @@
 
 namespace Common {
 
+    bool isIntegerObject(const std::shared_ptr<GIObject> &object) {
+        return object->getType() == ObjectType::INTEGER;
+    }
+
+    ArrayObject::ArrayObject(const Elements &elements) : packed{std::all_of(elements.begin(), elements.end(),
+                                                                            isIntegerObject)},
+                                                         offset{0}, length{elements.size()} {
+        if (!packed) {
+            storage = Storage{elements.begin(), elements.end()};
+            return;
+        }
+        std::vector<std::int64_t> values(elements.size());
+        std::transform(elements.begin(), elements.end(), values.begin(), [](auto &elem) {
+            return static_cast<IntegerObject *>(elem.get())->value;
+        });
+        packedStorage = PackedStorage{values.begin(), values.end()};
+    }
+
+    std::unique_ptr<ArrayObject> ArrayObject::push(std::shared_ptr<GIObject> value) const {
+        auto end = offset + length;
+        if (packed && value->getType() == ObjectType::INTEGER) {
+            auto integer = static_cast<IntegerObject *>(value.get())->value;
+            // elements of the storage past the end of this view are not visible, overwrite instead of append
+            auto next = end == packedStorage.size() ? packedStorage.pushBack(integer)
+                                                    : packedStorage.set(end, integer);
+            return std::make_unique<ArrayObject>(std::move(next), offset, length + 1);
+        }
+        if (packed) {
+            // a non integer element turns the array back into boxed storage
+            Elements elements{begin(), this->end()};
+            elements.push_back(std::move(value));
+            return std::make_unique<ArrayObject>(Storage{elements.begin(), elements.end()}, 0, elements.size());
+        }
+        auto next = end == storage.size() ? storage.pushBack(std::move(value))
+                                          : storage.set(end, std::move(value));
+        return std::make_unique<ArrayObject>(std::move(next), offset, length + 1);
+    }
+
+    std::unique_ptr<ArrayObject> ArrayObject::set(std::size_t index, std::shared_ptr<GIObject> value) const {
+        auto result = packed ? std::make_unique<ArrayObject>(packedStorage, offset, length)
+                             : std::make_unique<ArrayObject>(storage, offset, length);
+        result->setInPlace(index, std::move(value));
+        return result;
+    }
+
+    void ArrayObject::setInPlace(std::size_t index, std::shared_ptr<GIObject> value) {
+        if (packed && value->getType() == ObjectType::INTEGER) {
+            packedStorage.setInPlace(offset + index, static_cast<IntegerObject *>(value.get())->value);
+            return;
+        }
+        if (packed) {
+            // a non integer element turns the array back into boxed storage
+            Elements elements{begin(), end()};
+            elements[index] = std::move(value);
+            storage = Storage{elements.begin(), elements.end()};
+            packedStorage = PackedStorage{};
+            packed = false;
+            offset = 0;
+            return;
+        }
+        storage.setInPlace(offset + index, std::move(value));
+    }
+
+    std::shared_ptr<GIObject> setIndex(const std::shared_ptr<GIObject> &container, const std::shared_ptr<GIObject> &index,
+                                       std::shared_ptr<GIObject> value, bool inPlace) {
+        if (container->getType() == ObjectType::ARRAY) {
+            if (index->getType() != ObjectType::INTEGER) {
+                return makeErrorObject(fmt::format("array index must be integer, got {}", index->inspect()));
+            }
+            auto arrayObject = static_cast<ArrayObject *>(container.get());
+            auto indexValue = static_cast<IntegerObject *>(index.get())->value;
+            if (indexValue < 0 || std::uint64_t(indexValue) >= arrayObject->size()) {
+                return makeErrorObject(fmt::format("array index out of range: {}", indexValue));
+            }
+            if (!inPlace) {
+                return arrayObject->set(indexValue, std::move(value));
+            }
+            arrayObject->setInPlace(indexValue, std::move(value));
+            return container;
+        } else if (container->getType() == ObjectType::HASH) {
+            auto hashObject = static_cast<HashObject *>(container.get());
+            auto hashKey = index->hash();
+            if (!inPlace) {
+                auto pairs = hashObject->pairs;
+                pairs[hashKey] = HashPair{index, std::move(value)};
+                return std::make_shared<HashObject>(std::move(pairs));
+            }
+            hashObject->pairs[hashKey] = HashPair{index, std::move(value)};
+            return container;
+        }
+        return makeErrorObject(fmt::format("index assignment not supported: {}", container->inspect()));
+    }
+
+    std::shared_ptr<GIObject> setIndexPath(const std::shared_ptr<GIObject> &container,
+                                           const std::vector<std::shared_ptr<GIObject>> &indices,
+                                           std::shared_ptr<GIObject> value, bool inPlace) {
+        std::vector<std::shared_ptr<GIObject>> containers{container};
+        for (std::size_t i = 0; i + 1 < indices.size(); i++) {
+            auto current = containers.back().get();
+            std::shared_ptr<GIObject> next;
+            if (current->getType() == ObjectType::ARRAY && indices[i]->getType() == ObjectType::INTEGER) {
+                auto arrayObject = static_cast<ArrayObject *>(current);
+                auto indexValue = static_cast<IntegerObject *>(indices[i].get())->value;
+                if (indexValue >= 0 && std::uint64_t(indexValue) < arrayObject->size()) {
+                    next = arrayObject->at(indexValue);
+                }
+            } else if (current->getType() == ObjectType::HASH) {
+                auto hashObject = static_cast<HashObject *>(current);
+                auto pair = hashObject->pairs.find(indices[i]->hash());
+                if (pair != hashObject->pairs.end()) {
+                    next = pair->second.value;
+                }
+            }
+            if (next == nullptr) {
+                return makeErrorObject(fmt::format("index assignment on missing element: {}", indices[i]->inspect()));
+            }
+            containers.push_back(std::move(next));
+        }
+        // rebuild from the innermost container, only the outermost one may be updated in place
+        for (auto i = indices.size(); i-- > 0;) {
+            value = setIndex(containers[i], indices[i], std::move(value), inPlace && i == 0);
+            if (value->getType() == ObjectType::ERROR) {
+                return value;
+            }
+        }
+        return value;
+    }
+
+    bool valueEquals(GIObject *left, GIObject *right) {
+        if (left->getType() != right->getType()) {
+            return false;
+        }
+        switch (left->getType()) {
+            case ObjectType::INTEGER:
+                return static_cast<IntegerObject *>(left)->value == static_cast<IntegerObject *>(right)->value;
+            case ObjectType::BIG_INTEGER:
+                return static_cast<BigIntObject *>(left)->value == static_cast<BigIntObject *>(right)->value;
+            case ObjectType::FLOAT:
+                return static_cast<FloatObject *>(left)->value == static_cast<FloatObject *>(right)->value;
+            case ObjectType::STRING:
+                return static_cast<StringObject *>(left)->value == static_cast<StringObject *>(right)->value;
+            case ObjectType::BOOLEAN:
+                return static_cast<BooleanObject *>(left)->value == static_cast<BooleanObject *>(right)->value;
+            case ObjectType::_NULL:
+                return true;
+            default:
+                return left == right;
+        }
+    }
+
+    std::shared_ptr<IteratorObject> makeIterator(const std::shared_ptr<GIObject> &iterable) {
+        switch (iterable->getType()) {
+            case ObjectType::ARRAY:
+                return std::make_shared<ArrayIteratorObject>(std::static_pointer_cast<ArrayObject>(iterable));
+            case ObjectType::ITERATOR:
+                return std::static_pointer_cast<IteratorObject>(iterable);
+            default:
+                return nullptr;
+        }
+    }
+
     std::unique_ptr<BooleanObject> makeBoolObject(bool value) {
         return std::make_unique<BooleanObject>(value);
     }
@@ -6,9 +6,17 @@
 #define GOINTERPRETER_GIOBJECT_H
 
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <stdexcept>
 #include <iterator>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
 #include "Ast.h"
+#include "PersistentVector.h"
+#include "BigInt.h"
 #include "fmt/core.h"
 
 namespace Common {
@@ -19,18 +27,25 @@ namespace Common {
         _NULL,
         ERROR,
         INTEGER,
+        // integer outside of the int64 range
+        BIG_INTEGER,
+        FLOAT,
         BOOLEAN,
         STRING,
         BUILTIN,
         RETURN_VALUE,
         ARRAY,
         HASH,
+        ITERATOR,
+        // mutable string buffer
+        BUILDER,
         // used in interpreter
         FUNCTION,
 
         // used in compiler
         COMPILED_FUNCTION,
         CLOSURE,
+        MATCH_TABLE,
     };
 
     struct GIObject {
@@ -46,7 +61,7 @@ namespace Common {
     };
 
     struct IntegerObject : GIObject {
-        explicit IntegerObject(int value) : value{value} {}
+        explicit IntegerObject(std::int64_t value) : value{value} {}
 
         ObjectType getType() override { return ObjectType::INTEGER; }
 
@@ -55,23 +70,71 @@ namespace Common {
         }
 
         HashKey hash() override {
-            return std::hash<int>{}(value);
+            return std::hash<std::int64_t>{}(value);
         }
 
-        int value;
+        std::int64_t value;
+    };
+
+    // only created for values that don't fit into an int64, see `makeIntegerObject`
+    struct BigIntObject : GIObject {
+        explicit BigIntObject(BigInt value) : value{std::move(value)} {}
+
+        ObjectType getType() override { return ObjectType::BIG_INTEGER; }
+
+        std::string inspect() override {
+            return value.toString();
+        }
+
+        HashKey hash() override {
+            return value.hash();
+        }
+
+        BigInt value;
+    };
+
+    struct FloatObject : GIObject {
+        explicit FloatObject(double value) : value{value} {}
+
+        ObjectType getType() override { return ObjectType::FLOAT; }
+
+        std::string inspect() override {
+            auto result = fmt::format("{}", value);
+            // keep floats recognizable, 3.0 instead of 3
+            if (result.find_first_of(".en") == std::string::npos) {
+                result += ".0";
+            }
+            return result;
+        }
+
+        HashKey hash() override {
+            return std::hash<double>{}(value);
+        }
+
+        double value;
     };
 
     struct StringObject : GIObject {
-        explicit StringObject(std::string value) : value{value} {}
+        explicit StringObject(std::string value) : buffer{std::make_shared<const std::string>(std::move(value))},
+                                                   value{*buffer} {}
+
+        // view into an existing buffer, the buffer is shared instead of copied
+        StringObject(std::shared_ptr<const std::string> buffer, std::string_view value) : buffer{std::move(buffer)},
+                                                                                          value{value} {}
 
         ObjectType getType() override { return ObjectType::STRING; }
 
-        std::string inspect() override { return value; }
+        std::string inspect() override { return std::string{value}; }
+
+        std::unique_ptr<StringObject> substr(std::size_t from, std::size_t to) const {
+            return std::make_unique<StringObject>(buffer, value.substr(from, to - from));
+        }
 
-        std::string value;
+        std::shared_ptr<const std::string> buffer;
+        std::string_view value;
 
         HashKey hash() override {
-            return std::hash<string>{}(value);
+            return std::hash<std::string_view>{}(value);
         }
     };
 
@@ -117,9 +180,11 @@ namespace Common {
     };
 
     struct BuiltinFunctionObject : GIObject {
+        // index into the builtin table, see `builtinDefinitions()`
         BuiltinFunctionObject(
-                string name
-        ) : name{name} {}
+                int index,
+                std::string_view name
+        ) : index{index}, name{name} {}
 
         ObjectType getType() override { return ObjectType::BUILTIN; }
 
@@ -127,11 +192,66 @@ namespace Common {
             return fmt::format("<builtin: {}>", name);
         }
 
-        string name;
+        int index;
+        std::string_view name;
     };
 
     struct ArrayObject : GIObject {
-        explicit ArrayObject(std::vector<std::shared_ptr<GIObject>> elements) : elements(std::move(elements)) {}
+        using Elements = std::vector<std::shared_ptr<GIObject>>;
+        using Storage = PersistentVector<std::shared_ptr<GIObject>>;
+        // arrays holding only integers keep them unboxed
+        using PackedStorage = PersistentVector<std::int64_t>;
+
+        class ConstIterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::shared_ptr<GIObject>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = std::shared_ptr<GIObject>;
+
+            ConstIterator(Storage::ConstIterator boxed, PackedStorage::ConstIterator packed, bool isPacked) :
+                    boxed{boxed}, packed{packed}, isPacked{isPacked} {}
+
+            std::shared_ptr<GIObject> operator*() const {
+                return isPacked ? std::make_shared<IntegerObject>(*packed) : *boxed;
+            }
+
+            ConstIterator &operator++() {
+                if (isPacked) {
+                    ++packed;
+                } else {
+                    ++boxed;
+                }
+                return *this;
+            }
+
+            ConstIterator operator++(int) {
+                auto it = *this;
+                ++*this;
+                return it;
+            }
+
+            bool operator==(const ConstIterator &other) const {
+                return isPacked ? packed == other.packed : boxed == other.boxed;
+            }
+
+            bool operator!=(const ConstIterator &other) const { return !(*this == other); }
+
+        private:
+            Storage::ConstIterator boxed;
+            PackedStorage::ConstIterator packed;
+            bool isPacked;
+        };
+
+        explicit ArrayObject(const Elements &elements);
+
+        // view of [offset, offset + length) in an existing storage, the storage is shared instead of copied
+        ArrayObject(Storage storage, std::size_t offset, std::size_t length) :
+                storage{std::move(storage)}, packed{false}, offset{offset}, length{length} {}
+
+        ArrayObject(PackedStorage packedStorage, std::size_t offset, std::size_t length) :
+                packedStorage{std::move(packedStorage)}, packed{true}, offset{offset}, length{length} {}
 
         ObjectType getType() override {
             return ObjectType::ARRAY;
@@ -141,7 +261,7 @@ namespace Common {
             std::stringstream ss;
 
             std::vector<std::string> elems;
-            for (auto &elem: elements) {
+            for (auto elem: *this) {
                 elems.push_back(elem->inspect());
             }
             std::stringstream elemsStream;
@@ -150,7 +270,52 @@ namespace Common {
             return ss.str();
         }
 
-        std::vector<std::shared_ptr<GIObject>> elements;
+        std::size_t size() const { return length; }
+
+        bool isPacked() const { return packed; }
+
+        // packed integers are boxed on access
+        std::shared_ptr<GIObject> at(std::size_t index) const {
+            if (packed) {
+                return std::make_shared<IntegerObject>(packedStorage[offset + index]);
+            }
+            return storage[offset + index];
+        }
+
+        ConstIterator begin() const {
+            return {storage.iteratorAt(offset), packedStorage.iteratorAt(offset), packed};
+        }
+
+        ConstIterator end() const {
+            return {storage.iteratorAt(offset + length), packedStorage.iteratorAt(offset + length), packed};
+        }
+
+        // contiguous run of unboxed integers starting at index, only valid for packed arrays
+        std::pair<const std::int64_t *, std::size_t> packedChunkAt(std::size_t index) const {
+            auto chunk = packedStorage.chunkAt(offset + index);
+            return {chunk.first, std::min(chunk.second, length - index)};
+        }
+
+        std::unique_ptr<ArrayObject> slice(std::size_t from, std::size_t to) const {
+            if (packed) {
+                return std::make_unique<ArrayObject>(packedStorage, offset + from, to - from);
+            }
+            return std::make_unique<ArrayObject>(storage, offset + from, to - from);
+        }
+
+        std::unique_ptr<ArrayObject> push(std::shared_ptr<GIObject> value) const;
+
+        // copy of this array with element at index replaced
+        std::unique_ptr<ArrayObject> set(std::size_t index, std::shared_ptr<GIObject> value) const;
+
+        // replace element at index, only valid when this array is not shared
+        void setInPlace(std::size_t index, std::shared_ptr<GIObject> value);
+
+        Storage storage;
+        PackedStorage packedStorage;
+        bool packed;
+        std::size_t offset;
+        std::size_t length;
     };
 
     struct HashPair {
@@ -180,6 +345,92 @@ namespace Common {
         std::map<HashKey, HashPair> pairs;
     };
 
+    // What an iterator produced when it was asked for its next element. Iterators never call functions
+    // themselves: a Call step asks whoever drives the iterator to call `value` with `arguments` and to hand
+    // the result back through `resume`. That lets the vm run callbacks on its own frames.
+    struct IteratorStep {
+        enum class Kind {
+            Element,
+            Done,
+            Call,
+        };
+
+        static IteratorStep element(std::shared_ptr<GIObject> value) {
+            return {Kind::Element, std::move(value), {}};
+        }
+
+        static IteratorStep done() {
+            return {Kind::Done, nullptr, {}};
+        }
+
+        static IteratorStep call(std::shared_ptr<GIObject> function, std::vector<std::shared_ptr<GIObject>> arguments) {
+            return {Kind::Call, std::move(function), std::move(arguments)};
+        }
+
+        Kind kind;
+        // the element for Element, the function for Call
+        std::shared_ptr<GIObject> value;
+        std::vector<std::shared_ptr<GIObject>> arguments;
+    };
+
+    // lazy single pass sequence, drives for-in loops and the iterator builtins
+    struct IteratorObject : GIObject {
+        ObjectType getType() override { return ObjectType::ITERATOR; }
+
+        std::string inspect() override { return "<iterator>"; }
+
+        virtual IteratorStep next() = 0;
+
+        // result of the function requested by the last Call step
+        virtual IteratorStep resume([[maybe_unused]] std::shared_ptr<GIObject> result) {
+            throw std::logic_error{"iterator is not waiting for a call"};
+        }
+    };
+
+    // walks the array storage directly instead of indexing one element at a time
+    struct ArrayIteratorObject : IteratorObject {
+        explicit ArrayIteratorObject(std::shared_ptr<ArrayObject> array) :
+                array{std::move(array)}, current{this->array->begin()}, end{this->array->end()} {}
+
+        IteratorStep next() override {
+            if (current == end) {
+                return IteratorStep::done();
+            }
+            return IteratorStep::element(*current++);
+        }
+
+        std::shared_ptr<ArrayObject> array;
+        ArrayObject::ConstIterator current;
+        ArrayObject::ConstIterator end;
+    };
+
+    // Mutable string buffer behind builder(), append() and build(). Unlike every other object it is
+    // updated in place, all holders see the appended text.
+    struct BuilderObject : GIObject {
+        ObjectType getType() override { return ObjectType::BUILDER; }
+
+        std::string inspect() override { return "<builder>"; }
+
+        std::string buffer;
+    };
+
+    // same type and same value, containers and functions are only equal to themselves
+    bool valueEquals(GIObject *left, GIObject *right);
+
+    // iterator over an array, an iterator is returned as is. Returns nullptr for values that can't be iterated.
+    std::shared_ptr<IteratorObject> makeIterator(const std::shared_ptr<GIObject> &iterable);
+
+    // container[index] = value for arrays and hashes. A container that is not shared is updated in place,
+    // a shared one is copied first so other holders keep seeing the old value. Returns the updated
+    // container or an error object.
+    std::shared_ptr<GIObject> setIndex(const std::shared_ptr<GIObject> &container, const std::shared_ptr<GIObject> &index,
+                                       std::shared_ptr<GIObject> value, bool inPlace);
+
+    // container[indices[0]]...[indices[n - 1]] = value, nested containers are always copied on write
+    std::shared_ptr<GIObject> setIndexPath(const std::shared_ptr<GIObject> &container,
+                                           const std::vector<std::shared_ptr<GIObject>> &indices,
+                                           std::shared_ptr<GIObject> value, bool inPlace);
+
     std::unique_ptr<BooleanObject> makeBoolObject(bool value);
 
     std::unique_ptr<ErrorObject> makeErrorObject(const std::string &message);
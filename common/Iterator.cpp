@@ -0,0 +1,145 @@
+//
+// Created by seeu on 2022/9/3.
+//
+
+#include "Iterator.h"
+
+namespace Common {
+
+    bool isTruthyValue(GIObject *object) {
+        switch (object->getType()) {
+            case ObjectType::BOOLEAN:
+                return static_cast<BooleanObject *>(object)->value;
+            case ObjectType::_NULL:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    IteratorStep RangeIteratorObject::next() {
+        if (exhausted || (step > 0 ? current >= end : current <= end)) {
+            return IteratorStep::done();
+        }
+        auto value = current;
+        // stop instead of wrapping around at the ends of the int64 range
+        exhausted = __builtin_add_overflow(current, step, &current);
+        return IteratorStep::element(std::make_shared<IntegerObject>(value));
+    }
+
+    IteratorStep MapIteratorObject::next() {
+        return fromSource(source->next());
+    }
+
+    IteratorStep MapIteratorObject::resume(std::shared_ptr<GIObject> result) {
+        if (waitingOnSource) {
+            return fromSource(source->resume(std::move(result)));
+        }
+        return IteratorStep::element(std::move(result));
+    }
+
+    IteratorStep MapIteratorObject::fromSource(IteratorStep step) {
+        waitingOnSource = step.kind == IteratorStep::Kind::Call;
+        if (step.kind != IteratorStep::Kind::Element) {
+            return step;
+        }
+        return IteratorStep::call(function, {std::move(step.value)});
+    }
+
+    IteratorStep FilterIteratorObject::next() {
+        return fromSource(source->next());
+    }
+
+    IteratorStep FilterIteratorObject::resume(std::shared_ptr<GIObject> result) {
+        if (waitingOnSource) {
+            return fromSource(source->resume(std::move(result)));
+        }
+        if (isTruthyValue(result.get())) {
+            return IteratorStep::element(std::move(candidate));
+        }
+        candidate.reset();
+        return fromSource(source->next());
+    }
+
+    IteratorStep FilterIteratorObject::fromSource(IteratorStep step) {
+        waitingOnSource = step.kind == IteratorStep::Kind::Call;
+        if (step.kind != IteratorStep::Kind::Element) {
+            return step;
+        }
+        candidate = std::move(step.value);
+        return IteratorStep::call(predicate, {candidate});
+    }
+
+    IteratorStep TakeIteratorObject::next() {
+        if (remaining <= 0) {
+            return IteratorStep::done();
+        }
+        return fromSource(source->next());
+    }
+
+    IteratorStep TakeIteratorObject::resume(std::shared_ptr<GIObject> result) {
+        return fromSource(source->resume(std::move(result)));
+    }
+
+    IteratorStep TakeIteratorObject::fromSource(IteratorStep step) {
+        if (step.kind == IteratorStep::Kind::Element) {
+            remaining--;
+        } else if (step.kind == IteratorStep::Kind::Done) {
+            remaining = 0;
+        }
+        return step;
+    }
+
+    IteratorStep CollectIteratorObject::next() {
+        if (finished) {
+            return IteratorStep::done();
+        }
+        return fromSource(source->next());
+    }
+
+    IteratorStep CollectIteratorObject::resume(std::shared_ptr<GIObject> result) {
+        return fromSource(source->resume(std::move(result)));
+    }
+
+    IteratorStep CollectIteratorObject::fromSource(IteratorStep step) {
+        // elements that need no call are pulled right here, only calls go back to the driver
+        while (step.kind == IteratorStep::Kind::Element) {
+            elements.push_back(std::move(step.value));
+            step = source->next();
+        }
+        if (step.kind == IteratorStep::Kind::Call) {
+            return step;
+        }
+        finished = true;
+        return IteratorStep::element(std::make_shared<ArrayObject>(std::move(elements)));
+    }
+
+    IteratorStep ReduceIteratorObject::next() {
+        if (finished) {
+            return IteratorStep::done();
+        }
+        return fromSource(source->next());
+    }
+
+    IteratorStep ReduceIteratorObject::resume(std::shared_ptr<GIObject> result) {
+        if (waitingOnSource) {
+            return fromSource(source->resume(std::move(result)));
+        }
+        accumulator = std::move(result);
+        return fromSource(source->next());
+    }
+
+    IteratorStep ReduceIteratorObject::fromSource(IteratorStep step) {
+        waitingOnSource = step.kind == IteratorStep::Kind::Call;
+        switch (step.kind) {
+            case IteratorStep::Kind::Call:
+                return step;
+            case IteratorStep::Kind::Element:
+                // hand the accumulator over instead of keeping a second reference to it
+                return IteratorStep::call(function, {std::move(accumulator), std::move(step.value)});
+            default:
+                finished = true;
+                return IteratorStep::element(std::move(accumulator));
+        }
+    }
+}
@@ -0,0 +1,121 @@
+//
+// Created by seeu on 2022/9/3.
+//
+
+#ifndef GOINTERPRETER_ITERATOR_H
+#define GOINTERPRETER_ITERATOR_H
+
+#include "GIObject.h"
+#include <cstdint>
+#include <memory>
+
+// Lazy iterator stages behind the range, imap, ifilter, take, collect and reduce builtins. A pipeline pulls
+// one element at a time through all of its stages, no stage materializes an intermediate array.
+// Stages that need a function call hand it to the driver as a Call step and continue in resume(), a stage
+// forwards the Call steps of its source unchanged.
+namespace Common {
+
+    // integers from start up to (excluding) end, counting by step
+    struct RangeIteratorObject : IteratorObject {
+        RangeIteratorObject(std::int64_t start, std::int64_t end, std::int64_t step) :
+                current{start}, end{end}, step{step} {}
+
+        IteratorStep next() override;
+
+    private:
+        std::int64_t current;
+        std::int64_t end;
+        std::int64_t step;
+        bool exhausted{false};
+    };
+
+    // function(element) for every element of the source
+    struct MapIteratorObject : IteratorObject {
+        MapIteratorObject(std::shared_ptr<IteratorObject> source, std::shared_ptr<GIObject> function) :
+                source{std::move(source)}, function{std::move(function)} {}
+
+        IteratorStep next() override;
+
+        IteratorStep resume(std::shared_ptr<GIObject> result) override;
+
+    private:
+        IteratorStep fromSource(IteratorStep step);
+
+        std::shared_ptr<IteratorObject> source;
+        std::shared_ptr<GIObject> function;
+        // the pending call was requested by the source, not by this stage
+        bool waitingOnSource{false};
+    };
+
+    // elements of the source for which predicate(element) is truthy
+    struct FilterIteratorObject : IteratorObject {
+        FilterIteratorObject(std::shared_ptr<IteratorObject> source, std::shared_ptr<GIObject> predicate) :
+                source{std::move(source)}, predicate{std::move(predicate)} {}
+
+        IteratorStep next() override;
+
+        IteratorStep resume(std::shared_ptr<GIObject> result) override;
+
+    private:
+        IteratorStep fromSource(IteratorStep step);
+
+        std::shared_ptr<IteratorObject> source;
+        std::shared_ptr<GIObject> predicate;
+        std::shared_ptr<GIObject> candidate;
+        bool waitingOnSource{false};
+    };
+
+    // at most `count` elements of the source, the source is not pulled past the last one
+    struct TakeIteratorObject : IteratorObject {
+        TakeIteratorObject(std::shared_ptr<IteratorObject> source, std::int64_t count) :
+                source{std::move(source)}, remaining{count} {}
+
+        IteratorStep next() override;
+
+        IteratorStep resume(std::shared_ptr<GIObject> result) override;
+
+    private:
+        IteratorStep fromSource(IteratorStep step);
+
+        std::shared_ptr<IteratorObject> source;
+        std::int64_t remaining;
+    };
+
+    // drains the source, its single element is the array of all source elements
+    struct CollectIteratorObject : IteratorObject {
+        explicit CollectIteratorObject(std::shared_ptr<IteratorObject> source) : source{std::move(source)} {}
+
+        IteratorStep next() override;
+
+        IteratorStep resume(std::shared_ptr<GIObject> result) override;
+
+    private:
+        IteratorStep fromSource(IteratorStep step);
+
+        std::shared_ptr<IteratorObject> source;
+        std::vector<std::shared_ptr<GIObject>> elements;
+        bool finished{false};
+    };
+
+    // drains the source, its single element is function(...function(initial, e0)..., en)
+    struct ReduceIteratorObject : IteratorObject {
+        ReduceIteratorObject(std::shared_ptr<IteratorObject> source, std::shared_ptr<GIObject> function,
+                             std::shared_ptr<GIObject> initial) :
+                source{std::move(source)}, function{std::move(function)}, accumulator{std::move(initial)} {}
+
+        IteratorStep next() override;
+
+        IteratorStep resume(std::shared_ptr<GIObject> result) override;
+
+    private:
+        IteratorStep fromSource(IteratorStep step);
+
+        std::shared_ptr<IteratorObject> source;
+        std::shared_ptr<GIObject> function;
+        std::shared_ptr<GIObject> accumulator;
+        bool waitingOnSource{false};
+        bool finished{false};
+    };
+}
+
+#endif //GOINTERPRETER_ITERATOR_H
@@ -3,38 +3,37 @@
 //
 
 #include "Lexer.h"
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include "Simd.h"
 
 namespace Common {
 
-    std::map<std::string, TokenType> initializeKeywords() {
-        std::map<std::string, TokenType> keywordsMap;
-        keywordsMap["fn"] = TokenType::FUNCTION;
-        keywordsMap["let"] = TokenType::LET;
-        keywordsMap["true"] = TokenType::TRUE;
-        keywordsMap["false"] = TokenType::FALSE;
-        keywordsMap["if"] = TokenType::IF;
-        keywordsMap["else"] = TokenType::ELSE;
-        keywordsMap["return"] = TokenType::RETURN;
-        return keywordsMap;
-    }
+    Lexer::Lexer(std::string input, Symbols symbols) :
+            source{std::make_shared<const std::string>(std::move(input))}, symbols{std::move(symbols)},
+            input{*source}, readPosition{0}, position{0}, currentChar{0} {}
 
+    Lexer::Lexer(Source source, unsigned start, std::uint32_t line, Symbols symbols) :
+            source{std::move(source)}, symbols{std::move(symbols)}, input{*this->source}, readPosition{start},
+            position{start}, currentChar{0}, line{line} {
+        auto newline = start == 0 ? std::string_view::npos : input.rfind('\n', start - 1);
+        lineStart = newline == std::string_view::npos ? 0 : unsigned(newline + 1);
+    }
 
-    Lexer::Lexer(std::string input) : input{std::move(input)}, readPosition{0}, position{0}, currentChar{0} {
-        keywordsMap = initializeKeywords();
+    Token Lexer::makeToken(TokenType type, std::string_view literal, SymbolId symbol) {
+        Token token{type, literal, symbol};
+        token.line = tokenLine;
+        token.column = tokenColumn;
+        return token;
     }
 
-    std::string charToString(char c) {
-        std::string s;
-        s = c;
-        return s;
+    Token Lexer::tokenFrom(TokenType type, unsigned start) {
+        return makeToken(type, input.substr(start, position + 1 - start));
     }
 
-    void Lexer::skipWhitespace() {
-        while (currentChar == ' ' || currentChar == '\t' || currentChar == '\n' || currentChar == '\r') {
-            readChar();
-        }
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
     }
 
     bool isDigit(char c) {
@@ -45,25 +44,108 @@ namespace Common {
         return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
     }
 
-    std::string Lexer::readNumber() {
-        auto pos = position;
-        while (isDigit(peekChar())) {
-            readChar();
+    bool isStringContent(char c) {
+        return c != '"' && c != '\n' && c != 0;
+    }
+
+    // most runs are shorter than this and cheaper to scan inline than through a kernel call
+    constexpr unsigned INLINE_SCAN_LENGTH = 16;
+
+    // end of the run of InRun characters starting at `from`, longer runs continue in the vectorized Kernel
+    template<bool (*InRun)(char), std::size_t (*Kernel)(const char *, std::size_t)>
+    unsigned scanRun(std::string_view input, unsigned from) {
+        auto inlineEnd = std::min<std::size_t>(input.size(), from + INLINE_SCAN_LENGTH);
+        auto end = from;
+        while (end < inlineEnd && InRun(input[end])) {
+            end++;
         }
+        if (end < inlineEnd || end == input.size()) {
+            return end;
+        }
+        return end + unsigned(Kernel(input.data() + end, input.size() - end));
+    }
 
-        // 1: peek ahead
-        return input.substr(pos, position + 1 - pos);
+    void Lexer::skipWhitespace() {
+        if (!isWhitespace(currentChar)) {
+            return;
+        }
+        // lines are counted while scanning, runs longer than the inline scan continue in the kernel
+        auto end = position;
+        auto inlineEnd = std::min<std::size_t>(input.size(), position + INLINE_SCAN_LENGTH);
+        while (end < inlineEnd && isWhitespace(input[end])) {
+            if (input[end] == '\n') {
+                line++;
+                lineStart = end + 1;
+            }
+            end++;
+        }
+        if (end == inlineEnd && end < input.size()) {
+            auto runEnd = end + unsigned(Simd::whitespaceRun(input.data() + end, input.size() - end));
+            countLines(end, runEnd);
+            end = runEnd;
+        }
+        jumpTo(end);
+    }
+
+    void Lexer::countLines(unsigned from, unsigned to) {
+        auto begin = input.data();
+        if (to - from <= INLINE_SCAN_LENGTH) {
+            for (auto at = from; at < to; at++) {
+                if (begin[at] == '\n') {
+                    line++;
+                    lineStart = at + 1;
+                }
+            }
+            return;
+        }
+        auto at = begin + from;
+        while ((at = static_cast<const char *>(std::memchr(at, '\n', begin + to - at))) != nullptr) {
+            line++;
+            lineStart = unsigned(++at - begin);
+        }
     }
 
-    std::string Lexer::readIdentifier() {
+    void Lexer::jumpTo(unsigned target) {
+        position = target;
+        readPosition = target + 1;
+        currentChar = target < input.size() ? input[target] : 0;
+    }
+
+    void Lexer::readDigits() {
+        jumpTo(scanRun<isDigit, Simd::digitRun>(input, readPosition) - 1);
+    }
+
+    std::string_view Lexer::readNumber() {
         auto pos = position;
-        while (isLetter(peekChar())) {
+        readDigits();
+        // fraction, only when a digit follows the dot
+        if (peekChar() == '.' && readPosition + 1 < input.size() && isDigit(input[readPosition + 1])) {
             readChar();
+            readDigits();
+        }
+        // exponent like 1e9 or 2.5e-3
+        if (peekChar() == 'e' || peekChar() == 'E') {
+            auto digits = readPosition + 1;
+            if (digits < input.size() && (input[digits] == '+' || input[digits] == '-')) {
+                digits++;
+            }
+            if (digits < input.size() && isDigit(input[digits])) {
+                jumpTo(digits);
+                readDigits();
+            }
         }
+
         // 1: peek ahead
         return input.substr(pos, position + 1 - pos);
     }
 
+    std::string_view Lexer::readIdentifier() {
+        auto pos = position;
+        auto end = scanRun<isLetter, Simd::letterRun>(input, position);
+        jumpTo(end - 1);
+        return input.substr(pos, end - pos);
+    }
+
     unsigned int Lexer::peekChar() {
         if (readPosition >= input.size()) {
             return 0;
@@ -87,86 +169,109 @@ namespace Common {
         readChar();
         skipWhitespace();
 
+        // taken before reading the token, strings can span lines
+        tokenLine = line;
+        tokenColumn = position - lineStart + 1;
+
         switch (currentChar) {
             case '=':
                 if (peekChar() == '=') {
-                    auto ch = currentChar;
-                    // sign
                     readChar();
-                    std::stringstream literal;
-                    literal << ch;
-                    literal << currentChar;
-                    return {TokenType::EQ, literal.str()};
+                    return tokenFrom(TokenType::EQ, position - 1);
+                } else if (peekChar() == '>') {
+                    readChar();
+                    return tokenFrom(TokenType::ARROW, position - 1);
                 } else {
-                    return {TokenType::ASSIGN, charToString(currentChar)};
+                    return tokenFrom(TokenType::ASSIGN, position);
                 }
             case '+':
-                return {TokenType::PLUS, charToString(currentChar)};
+                return tokenFrom(TokenType::PLUS, position);
             case '-':
-                return {TokenType::MINUS, charToString(currentChar)};
+                return tokenFrom(TokenType::MINUS, position);
             case '!':
                 if (peekChar() == '=') {
-                    auto ch = currentChar;
                     readChar();
-                    std::stringstream literal;
-                    literal << ch;
-                    literal << currentChar;
-                    return {TokenType::NOT_EQ, literal.str()};
+                    return tokenFrom(TokenType::NOT_EQ, position - 1);
                 } else {
-                    return {TokenType::BANG, charToString(currentChar)};
+                    return tokenFrom(TokenType::BANG, position);
                 }
             case '/':
-                return {TokenType::SLASH, charToString(currentChar)};
+                return tokenFrom(TokenType::SLASH, position);
             case '*':
-                return {TokenType::ASTERISK, charToString(currentChar)};
+                return tokenFrom(TokenType::ASTERISK, position);
+            case '%':
+                return tokenFrom(TokenType::PERCENT, position);
             case '<':
-                return {TokenType::LT, charToString(currentChar)};
+                if (peekChar() == '=') {
+                    readChar();
+                    return tokenFrom(TokenType::LT_EQ, position - 1);
+                }
+                return tokenFrom(TokenType::LT, position);
             case '>':
-                return {TokenType::GT, charToString(currentChar)};
+                if (peekChar() == '=') {
+                    readChar();
+                    return tokenFrom(TokenType::GT_EQ, position - 1);
+                }
+                return tokenFrom(TokenType::GT, position);
+            case '&':
+                if (peekChar() == '&') {
+                    readChar();
+                    return tokenFrom(TokenType::AND, position - 1);
+                }
+                return tokenFrom(TokenType::ILLEGAL, position);
+            case '|':
+                if (peekChar() == '|') {
+                    readChar();
+                    return tokenFrom(TokenType::OR, position - 1);
+                }
+                return tokenFrom(TokenType::ILLEGAL, position);
             case ';':
-                return {TokenType::SEMICOLON, charToString(currentChar)};
+                return tokenFrom(TokenType::SEMICOLON, position);
             case ',':
-                return {TokenType::COMMA, charToString(currentChar)};
+                return tokenFrom(TokenType::COMMA, position);
             case '{':
-                return {TokenType::LBRACE, charToString(currentChar)};
+                return tokenFrom(TokenType::LBRACE, position);
             case '}':
-                return {TokenType::RBRACE, charToString(currentChar)};
+                return tokenFrom(TokenType::RBRACE, position);
             case ':':
-                return {TokenType::COLON, charToString(currentChar)};
+                return tokenFrom(TokenType::COLON, position);
             case '(':
-                return {TokenType::LPAREN, charToString(currentChar)};
+                return tokenFrom(TokenType::LPAREN, position);
             case ')':
-                return {TokenType::RPAREN, charToString(currentChar)};
+                return tokenFrom(TokenType::RPAREN, position);
             case '[':
-                return {TokenType::LBRACKET, charToString(currentChar)};
+                return tokenFrom(TokenType::LBRACKET, position);
             case ']':
-                return {TokenType::RBRACKET, charToString(currentChar)};
+                return tokenFrom(TokenType::RBRACKET, position);
             case '"':
-                return {TokenType::STRING, readString()};
+                return makeToken(TokenType::STRING, readString());
             case 0:
-                return {TokenType::_EOF, ""};
+                return makeToken(TokenType::_EOF, "");
             default:
                 if (isLetter(currentChar)) {
                     auto literal = readIdentifier();
-                    auto c = keywordsMap.size();
-                    auto type = keywordsMap.contains(literal) ? keywordsMap[literal] : TokenType::IDENTIFIER;
-                    return {type, literal};
+                    auto type = lookupIdentifier(literal);
+                    return makeToken(type, literal, type == TokenType::IDENTIFIER ? symbols->intern(literal) : 0);
                 } else if (isDigit(currentChar)) {
-                    return {TokenType::INT, readNumber()};
+                    auto literal = readNumber();
+                    auto isFloat = literal.find_first_of(".eE") != std::string_view::npos;
+                    return makeToken(isFloat ? TokenType::FLOAT : TokenType::INT, literal);
                 } else {
-                    return {TokenType::ILLEGAL, charToString(currentChar)};
+                    return tokenFrom(TokenType::ILLEGAL, position);
                 }
         }
     }
 
-    std::string Lexer::readString() {
+    std::string_view Lexer::readString() {
         auto pos = position + 1;
-        while (true) {
-            readChar();
-            if (currentChar == '"' || currentChar == 0) {
-                break;
-            }
+        // stops on the closing quote, or at the end of the input for an unterminated string
+        auto end = scanRun<isStringContent, Simd::stringRun>(input, pos);
+        while (end < input.size() && input[end] == '\n') {
+            line++;
+            lineStart = end + 1;
+            end = scanRun<isStringContent, Simd::stringRun>(input, end + 1);
         }
+        jumpTo(end);
         return input.substr(pos, position - pos);
     }
 }
@@ -5,7 +5,9 @@
 #ifndef GOINTERPRETER_LEXER_H
 #define GOINTERPRETER_LEXER_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <utility>
 #include "Token.h"
 
@@ -13,28 +15,59 @@ namespace Common {
 
     class Lexer {
     public:
-        explicit Lexer(std::string input);
+        // identifiers are interned into `symbols`, a new table when none is given
+        explicit Lexer(std::string input, Symbols symbols = std::make_shared<SymbolInterner>());
+
+        // lexes `source` from offset `start`, which must not be inside a token and is on line `line`
+        Lexer(Source source, unsigned start, std::uint32_t line, Symbols symbols);
 
         Token nextToken();
 
+        // the buffer the literals of the returned tokens point into
+        const Source &getSource() const { return source; }
+
+        // the table the symbols of the returned tokens are interned in
+        const Symbols &getSymbols() const { return symbols; }
+
     private:
-        std::string input;
-        std::map<std::string, TokenType> keywordsMap;
+        Source source;
+        Symbols symbols;
+        std::string_view input;
         unsigned position{};
         unsigned readPosition;
         char currentChar{};
+        // line of the current character and the offset that line starts at
+        std::uint32_t line{1};
+        unsigned lineStart{0};
+        // position of the token being read
+        std::uint32_t tokenLine{1};
+        unsigned tokenColumn{1};
 
         void skipWhitespace();
 
+        // counts the line breaks in [from, to)
+        void countLines(unsigned from, unsigned to);
+
+        Token makeToken(TokenType type, std::string_view literal, SymbolId symbol = 0);
+
         void readChar();
 
         unsigned int peekChar();
 
-        std::string readIdentifier();
+        // makes `target` the current character
+        void jumpTo(unsigned target);
+
+        // moves to the last digit of the run following the current character
+        void readDigits();
+
+        // token of the characters from `start` up to and including the current one
+        Token tokenFrom(TokenType type, unsigned start);
+
+        std::string_view readIdentifier();
 
-        std::string readNumber();
+        std::string_view readNumber();
 
-        std::string readString();
+        std::string_view readString();
 
     };
 }
@@ -3,6 +3,9 @@
 //
 
 #include "Parser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
 #include <sstream>
 #include <optional>
 #include <stdexcept>
@@ -12,48 +15,233 @@
 
 namespace Common {
 
+    // only called for the token types the rule table sends to the prefix and infix parsers
+    static PrefixOperator prefixOperatorOf(TokenType type) {
+        return type == TokenType::BANG ? PrefixOperator::Bang : PrefixOperator::Minus;
+    }
+
+    static InfixOperator infixOperatorOf(TokenType type) {
+        switch (type) {
+            case TokenType::PLUS:
+                return InfixOperator::Add;
+            case TokenType::MINUS:
+                return InfixOperator::Sub;
+            case TokenType::ASTERISK:
+                return InfixOperator::Mul;
+            case TokenType::SLASH:
+                return InfixOperator::Div;
+            case TokenType::PERCENT:
+                return InfixOperator::Mod;
+            case TokenType::EQ:
+                return InfixOperator::Equal;
+            case TokenType::NOT_EQ:
+                return InfixOperator::NotEqual;
+            case TokenType::LT:
+                return InfixOperator::Less;
+            case TokenType::GT:
+                return InfixOperator::Greater;
+            case TokenType::LT_EQ:
+                return InfixOperator::LessEqual;
+            case TokenType::GT_EQ:
+                return InfixOperator::GreaterEqual;
+            case TokenType::AND:
+                return InfixOperator::And;
+            case TokenType::OR:
+                return InfixOperator::Or;
+            default:
+                throw std::logic_error{fmt::format("not an infix operator: {}", magic_enum::enum_name(type))};
+        }
+    }
+
+    constexpr std::array<Parser::ParseRule, TOKEN_TYPE_COUNT> Parser::rules = [] {
+        std::array<ParseRule, TOKEN_TYPE_COUNT> table{};
+        auto prefix = [&table](TokenType type, PrefixParseFn parse) {
+            table[tokenTypeIndex(type)].prefix = parse;
+        };
+        auto infix = [&table](TokenType type, InfixParseFn parse, Precedence precedence) {
+            table[tokenTypeIndex(type)].infix = parse;
+            table[tokenTypeIndex(type)].precedence = precedence;
+        };
+
+        prefix(TokenType::IDENTIFIER, &Parser::prefixRule<&Parser::parseIdentifier>);
+        prefix(TokenType::INT, &Parser::prefixRule<&Parser::parseIntegerExpression>);
+        prefix(TokenType::FLOAT, &Parser::prefixRule<&Parser::parseFloatExpression>);
+        prefix(TokenType::STRING, &Parser::prefixRule<&Parser::parseStringExpression>);
+        prefix(TokenType::BANG, &Parser::prefixRule<&Parser::parsePrefixExpression>);
+        prefix(TokenType::MINUS, &Parser::prefixRule<&Parser::parsePrefixExpression>);
+        prefix(TokenType::TRUE, &Parser::prefixRule<&Parser::parseBoolExpression>);
+        prefix(TokenType::FALSE, &Parser::prefixRule<&Parser::parseBoolExpression>);
+        prefix(TokenType::LPAREN, &Parser::parseGroupedExpression);
+        prefix(TokenType::LBRACKET, &Parser::prefixRule<&Parser::parseArrayExpression>);
+        prefix(TokenType::LBRACE, &Parser::prefixRule<&Parser::parseHashExpression>);
+        prefix(TokenType::IF, &Parser::prefixRule<&Parser::parseIfExpression>);
+        prefix(TokenType::MATCH, &Parser::prefixRule<&Parser::parseMatchExpression>);
+        prefix(TokenType::FUNCTION, &Parser::prefixRule<&Parser::parseFunctionExpression>);
+
+        auto binary = &Parser::infixRule<&Parser::parseInfixExpression>;
+        infix(TokenType::OR, binary, Precedence::OR);
+        infix(TokenType::AND, binary, Precedence::AND);
+        infix(TokenType::EQ, binary, Precedence::EQUALS);
+        infix(TokenType::NOT_EQ, binary, Precedence::EQUALS);
+        infix(TokenType::LT, binary, Precedence::LESS);
+        infix(TokenType::GT, binary, Precedence::LESS);
+        infix(TokenType::LT_EQ, binary, Precedence::LESS);
+        infix(TokenType::GT_EQ, binary, Precedence::LESS);
+        infix(TokenType::PLUS, binary, Precedence::SUM);
+        infix(TokenType::MINUS, binary, Precedence::SUM);
+        infix(TokenType::SLASH, binary, Precedence::PRODUCT);
+        infix(TokenType::ASTERISK, binary, Precedence::PRODUCT);
+        infix(TokenType::PERCENT, binary, Precedence::PRODUCT);
+        infix(TokenType::LPAREN, &Parser::infixRule<&Parser::parseCallExpression>, Precedence::CALL);
+        infix(TokenType::LBRACKET, &Parser::infixRule<&Parser::parseIndexExpression>, Precedence::INDEX);
+        return table;
+    }();
+
     std::string ParserError::toString() {
         return message;
     }
 
     void Parser::nextToken() {
-        currentToken = peekToken;
-        peekToken = lexer->nextToken();
+        currentToken = std::exchange(peekToken, lexer->nextToken());
     }
 
     std::unique_ptr<Program> Parser::parseProgram() {
-        std::vector<std::unique_ptr<Statement>> statements{};
+        std::vector<NodePtr<Statement>> statements{};
+        std::vector<StatementOrigin> origins{};
         nextToken(); // skip start
         nextToken();
 
         while (currentToken.type != TokenType::_EOF) {
-            auto stmt = parseStatement();
-            if (stmt != nullptr) {
-                statements.push_back(std::move(stmt));
+            appendStatement(statements, origins);
+        }
+
+        return makeProgram(std::move(statements), std::move(origins));
+    }
+
+    std::unique_ptr<Program> Parser::reparse(std::unique_ptr<Program> previous, const TextEdit &edit) {
+        auto &text = *previous->storage->source;
+        if (edit.offset > text.size() || edit.removed > text.size() - edit.offset) {
+            throw std::out_of_range{fmt::format("edit of {} bytes at {} is outside of a program of {} bytes",
+                                                edit.removed, edit.offset, text.size())};
+        }
+        std::string edited;
+        edited.reserve(text.size() - edit.removed + edit.inserted.size());
+        edited.append(text, 0, edit.offset).append(edit.inserted).append(text, edit.offset + edit.removed);
+
+        if (previous->origins.size() != previous->statements.size() || !previous->errors.empty()) {
+            // not from the parser or its statements may hide errors, nothing to reuse
+            Lexer lexer{std::move(edited), previous->storage->symbols};
+            return Parser{&lexer}.parseProgram();
+        }
+
+        // The statement containing the character before the edit changes, its last token may grow into the
+        // edit. So can the statement before it: a statement ends where the next token can't continue it, that
+        // token may be the edited one.
+        auto &origins = previous->origins;
+        auto damaged = edit.offset == 0 ? 0 : edit.offset - 1;
+        auto containing = std::upper_bound(origins.begin(), origins.end(), damaged,
+                                           [](std::size_t offset, const StatementOrigin &origin) {
+                                               return offset < origin.offset;
+                                           }) - origins.begin();
+        std::size_t first = containing >= 2 ? containing - 2 : 0;
+        auto start = first == 0 ? 0 : unsigned(origins[first].offset);
+        auto line = first == 0 ? 1 : origins[first].line;
+
+        Lexer lexer{std::make_shared<const std::string>(std::move(edited)), start, line, previous->storage->symbols};
+        return Parser{&lexer}.parseEdited(*previous, first, edit);
+    }
+
+    std::unique_ptr<Program> Parser::parseEdited(Program &previous, std::size_t first, const TextEdit &edit) {
+        std::vector<NodePtr<Statement>> statements{};
+        std::vector<StatementOrigin> origins{};
+        statements.reserve(previous.statements.size());
+        origins.reserve(previous.origins.size());
+        for (std::size_t index = 0; index < first; index++) {
+            statements.push_back(std::move(previous.statements[index]));
+            origins.push_back(std::move(previous.origins[index]));
+        }
+        nextToken(); // skip start
+        nextToken();
+
+        // text from `editEnd` on is the old text from `editEnd - grown` on
+        auto editEnd = edit.offset + edit.inserted.size();
+        auto grown = std::ptrdiff_t(edit.inserted.size()) - std::ptrdiff_t(edit.removed);
+        auto removed = std::string_view{*previous.storage->source}.substr(edit.offset, edit.removed);
+        auto linesGrown = std::int32_t(std::count(edit.inserted.begin(), edit.inserted.end(), '\n') -
+                                       std::count(removed.begin(), removed.end(), '\n'));
+        auto candidate = first;
+        while (currentToken.type != TokenType::_EOF) {
+            auto offset = sourceOffset(currentToken);
+            if (offset >= editEnd) {
+                auto oldOffset = std::size_t(std::ptrdiff_t(offset) - grown);
+                while (candidate < previous.origins.size() && previous.origins[candidate].offset < oldOffset) {
+                    candidate++;
+                }
+                if (candidate < previous.origins.size() && previous.origins[candidate].offset == oldOffset) {
+                    // back in step with the old parse, the remaining statements are unchanged
+                    for (auto index = candidate; index < previous.statements.size(); index++) {
+                        statements.push_back(std::move(previous.statements[index]));
+                        auto &origin = previous.origins[index];
+                        origins.push_back({std::size_t(std::ptrdiff_t(origin.offset) + grown),
+                                           std::uint32_t(std::int32_t(origin.line) + linesGrown),
+                                           origin.lineShift + linesGrown, std::move(origin.storage)});
+                    }
+                    break;
+                }
             }
-            nextToken();
+            appendStatement(statements, origins);
         }
 
-        return std::make_unique<Program>(std::move(statements));
+        return makeProgram(std::move(statements), std::move(origins));
     }
 
-    std::unique_ptr<Statement> Parser::parseStatement() {
+    std::unique_ptr<Program> Parser::makeProgram(std::vector<NodePtr<Statement>> statements,
+                                                 std::vector<StatementOrigin> origins) {
+        auto program = std::make_unique<Program>(storage, std::move(statements), std::move(origins));
+        for (auto &error: errors) {
+            program->errors.push_back(error->toString());
+        }
+        return program;
+    }
+
+    void Parser::appendStatement(std::vector<NodePtr<Statement>> &statements, std::vector<StatementOrigin> &origins) {
+        auto offset = sourceOffset(currentToken);
+        auto line = currentToken.line;
+        auto stmt = parseStatement();
+        if (stmt != nullptr) {
+            statements.push_back(std::move(stmt));
+            origins.push_back({offset, line, 0, storage});
+        }
+        nextToken();
+    }
+
+    std::size_t Parser::sourceOffset(const Token &token) const {
+        auto offset = std::size_t(token.literal.data() - storage->source->data());
+        // string literals start after the opening quote
+        return token.type == TokenType::STRING ? offset - 1 : offset;
+    }
+
+    NodePtr<Statement> Parser::parseStatement() {
         switch (currentToken.type) {
             case TokenType::LET:
                 return parseLetStatement();
             case TokenType::RETURN:
                 return parseReturnStatement();
+            case TokenType::WHILE:
+                return parseWhileStatement();
+            case TokenType::FOR:
+                return parseForStatement();
             default:
                 return parseExpressionStatement();
         }
     }
 
-    std::unique_ptr<LetStatement> Parser::parseLetStatement() {
+    NodePtr<LetStatement> Parser::parseLetStatement() {
         auto token = currentToken;
         if (!expectPeekAndConsume(TokenType::IDENTIFIER)) {
             return nullptr;
         }
-        auto name = std::make_unique<Identifier>(currentToken, currentToken.literal);
+        auto name = makeNode<Identifier>(currentToken, currentToken.symbol);
         if (!expectPeekAndConsume(TokenType::ASSIGN)) {
             return nullptr;
         }
@@ -61,12 +249,12 @@ namespace Common {
         auto value = parseExpression(Precedence::LOWEST);
         if (value->getType() == NodeType::FunctionExpression) {
             auto fn = static_cast<FunctionExpression *>(value.get());
-            fn->name = name->value;
+            fn->name = name->symbol;
         }
         if (peekToken.type == TokenType::SEMICOLON) {
             nextToken();
         }
-        return std::make_unique<LetStatement>(token, std::move(name), std::move(value));
+        return makeNode<LetStatement>(token, std::move(name), std::move(value));
     }
 
     bool Parser::expectPeekAndConsume(TokenType tokenType) {
@@ -86,112 +274,78 @@ namespace Common {
         errors.push_back(std::make_unique<ParserError>(peekToken, ss.str()));
     }
 
-    std::unique_ptr<Expression> Parser::parseExpression(Precedence precedence) {
-        std::unique_ptr<Expression> expression;
-        switch (currentToken.type) {
-            case TokenType::IDENTIFIER:
-                expression = std::make_unique<Identifier>(currentToken, currentToken.literal);
-                break;
-            case TokenType::INT:
-                expression = parseIntegerExpression();
-                break;
-            case TokenType::STRING:
-                expression = parseStringExpression();
-                break;
-            case TokenType::BANG: // falls through
-            case TokenType::MINUS:
-                expression = parsePrefixExpression();
-                break;
-            case TokenType::TRUE:
-            case TokenType::FALSE:
-                expression = parseBoolExpression();
-                break;
-            case TokenType::LPAREN:
-                expression = parseGroupedExpression();
-                break;
-            case TokenType::LBRACKET:
-                expression = parseArrayExpression();
-                break;
-            case TokenType::LBRACE:
-                expression = parseHashExpression();
-                break;
-            case TokenType::IF:
-                expression = parseIfExpression();
-                break;
-            case TokenType::FUNCTION:
-                expression = parseFunctionExpression();
-                break;
-            default:
-                // skip
-                break;
-
+    NodePtr<Expression> Parser::parseExpression(Precedence precedence) {
+        NodePtr<Expression> expression;
+        // tokens that can't start an expression leave it empty
+        if (auto prefix = rules[tokenTypeIndex(currentToken.type)].prefix; prefix != nullptr) {
+            expression = (this->*prefix)();
         }
 
         while (peekToken.type != TokenType::SEMICOLON && precedence < peekPrecedence()) {
-            switch (peekToken.type) {
-                case TokenType::PLUS:
-                case TokenType::MINUS:
-                case TokenType::SLASH:
-                case TokenType::ASTERISK:
-                case TokenType::EQ:
-                case TokenType::NOT_EQ:
-                case TokenType::LT:
-                case TokenType::GT:
-                    nextToken(); // consume infix token
-                    expression = parseInfixExpression(std::move(expression));
-                    break;
-                case TokenType::LBRACKET:
-                    nextToken(); // consume right bracket
-                    expression = parseIndexExpression(std::move(expression));
-                    break;
-                case TokenType::LPAREN:
-                    expression = parseCallExpression(std::move(expression));
-                    break;
-                default:
-                    return expression;
-            }
-
+            auto infix = rules[tokenTypeIndex(peekToken.type)].infix;
+            nextToken(); // consume infix token
+            expression = (this->*infix)(std::move(expression));
         }
         return expression;
     }
 
-    std::unique_ptr<IntegerExpression> Parser::parseIntegerExpression() {
-        try {
-            auto value = std::stoi(currentToken.literal);
-            return std::make_unique<IntegerExpression>(currentToken, value);
+    NodePtr<Identifier> Parser::parseIdentifier() {
+        return makeNode<Identifier>(currentToken, currentToken.symbol);
+    }
+
+    NodePtr<IntegerExpression> Parser::parseIntegerExpression() {
+        auto literal = currentToken.literal;
+        std::int64_t value;
+        auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+        if (error == std::errc::result_out_of_range) {
+            if (auto bigValue = BigInt::fromDecimal(literal)) {
+                return makeNode<IntegerExpression>(currentToken, std::move(*bigValue));
+            }
         }
-        catch (std::exception const &ex) {
-            errors.push_back(std::make_unique<ParserError>(currentToken,
-                                                           "could not parse value " + currentToken.literal +
-                                                           " as integer"));
+        if (error != std::errc{} || end != literal.data() + literal.size()) {
+            errors.push_back(std::make_unique<ParserError>(
+                    currentToken, fmt::format("could not parse value {} as integer", literal)));
             return nullptr;
         }
+        return makeNode<IntegerExpression>(currentToken, value);
     }
 
-    std::unique_ptr<StringExpression> Parser::parseStringExpression() {
-        return std::make_unique<StringExpression>(currentToken, currentToken.literal);
+    NodePtr<FloatExpression> Parser::parseFloatExpression() {
+        auto literal = currentToken.literal;
+        double value;
+        auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+        if (error != std::errc{} || end != literal.data() + literal.size()) {
+            errors.push_back(std::make_unique<ParserError>(
+                    currentToken, fmt::format("could not parse value {} as float", literal)));
+            return nullptr;
+        }
+        return makeNode<FloatExpression>(currentToken, value);
     }
 
-    std::unique_ptr<PrefixExpression> Parser::parsePrefixExpression() {
+    NodePtr<StringExpression> Parser::parseStringExpression() {
+        return makeNode<StringExpression>(currentToken);
+    }
+
+    NodePtr<PrefixExpression> Parser::parsePrefixExpression() {
         auto token = currentToken;
         nextToken();
 
         auto expression = parseExpression(Precedence::PREFIX);
-        return std::make_unique<PrefixExpression>(token, token.literal, std::move(expression));
+        return makeNode<PrefixExpression>(token, prefixOperatorOf(token.type), std::move(expression));
     }
 
-    std::unique_ptr<BoolExpression> Parser::parseBoolExpression() {
-        return std::make_unique<BoolExpression>(currentToken, currentToken.literal == "true");
+    NodePtr<BoolExpression> Parser::parseBoolExpression() {
+        return makeNode<BoolExpression>(currentToken, currentToken.literal == "true");
     }
 
-    std::unique_ptr<ArrayExpression> Parser::parseArrayExpression() {
+    NodePtr<ArrayExpression> Parser::parseArrayExpression() {
         auto token = currentToken;
 
-        std::vector<std::unique_ptr<Expression>> elements{};
+        std::vector<NodePtr<Expression>> elements{};
 
         if (peekToken.type == TokenType::RBRACKET) {
             nextToken(); // consume `]`
-            return std::make_unique<ArrayExpression>(token, std::move(elements));
+            return makeNode<ArrayExpression>(token, std::move(elements));
         }
         nextToken();
         elements.push_back(parseExpression(Precedence::LOWEST));
@@ -206,13 +360,13 @@ namespace Common {
             return nullptr;
         }
 
-        return std::make_unique<ArrayExpression>(token, std::move(elements));
+        return makeNode<ArrayExpression>(token, std::move(elements));
 
     }
 
-    std::unique_ptr<HashExpression> Parser::parseHashExpression() {
+    NodePtr<HashExpression> Parser::parseHashExpression() {
         auto token = currentToken;
-        std::map<unique_ptr<Expression>, unique_ptr<Expression>> pairs{};
+        HashExpression::Pairs pairs{};
 
         while (peekToken.type != TokenType::RBRACE) {
             nextToken();
@@ -224,7 +378,7 @@ namespace Common {
             nextToken(); // consume colon
             auto value = parseExpression(Precedence::LOWEST);
 
-            pairs[std::move(key)] = std::move(value);
+            pairs.emplace_back(std::move(key), std::move(value));
             if (peekToken.type != TokenType::RBRACE && !expectPeekAndConsume(TokenType::COMMA)) {
                 return nullptr;
             }
@@ -233,12 +387,12 @@ namespace Common {
         if (!expectPeekAndConsume(TokenType::RBRACE)) {
             return nullptr;
         }
-        return make_unique<HashExpression>(token, std::move(pairs));
+        return makeNode<HashExpression>(token, std::move(pairs));
 
     }
 
 
-    std::unique_ptr<Expression> Parser::parseGroupedExpression() {
+    NodePtr<Expression> Parser::parseGroupedExpression() {
         nextToken();
         auto expr = parseExpression(Precedence::LOWEST);
         if (expectPeekAndConsume(TokenType::RPAREN)) {
@@ -247,7 +401,7 @@ namespace Common {
         return nullptr;
     }
 
-    std::unique_ptr<FunctionExpression> Parser::parseFunctionExpression() {
+    NodePtr<FunctionExpression> Parser::parseFunctionExpression() {
         auto token = currentToken;
         if (!expectPeekAndConsume(TokenType::LPAREN)) {
             return nullptr;
@@ -258,14 +412,17 @@ namespace Common {
             return nullptr;
         }
 
-        auto body = parseBlockStatement();
+        // the body can outlive the program in function objects, it keeps the arena alive instead
+        std::shared_ptr<BlockStatement> body{parseBlockStatement().release(), [storage = storage](BlockStatement *block) {
+            block->~BlockStatement();
+        }};
 
-        return std::make_unique<FunctionExpression>(token, std::move(parameters), std::move(body));
+        return makeNode<FunctionExpression>(token, std::move(parameters), std::move(body));
     }
 
-    std::unique_ptr<BlockStatement> Parser::parseBlockStatement() {
+    NodePtr<BlockStatement> Parser::parseBlockStatement() {
         auto token = currentToken;
-        std::vector<std::unique_ptr<Statement>> statements;
+        std::vector<NodePtr<Statement>> statements;
         nextToken(); // consume lbrace
         while (currentToken.type != TokenType::RBRACE && currentToken.type != TokenType::_EOF) {
             auto stmt = parseStatement();
@@ -274,24 +431,24 @@ namespace Common {
             }
             nextToken(); // consume rbrace
         }
-        return std::make_unique<BlockStatement>(token, std::move(statements));
+        return makeNode<BlockStatement>(token, std::move(statements));
     }
 
-    std::vector<std::unique_ptr<Identifier>> Parser::parseFunctionParameters() {
-        std::vector<std::unique_ptr<Identifier>> parameters;
+    std::vector<NodePtr<Identifier>> Parser::parseFunctionParameters() {
+        std::vector<NodePtr<Identifier>> parameters;
         if (peekToken.type == TokenType::RPAREN) {
             nextToken();
             return parameters;
         }
         nextToken();
 
-        parameters.push_back(std::make_unique<Identifier>(currentToken, currentToken.literal));
+        parameters.push_back(makeNode<Identifier>(currentToken, currentToken.symbol));
 
         while (peekToken.type == TokenType::COMMA) {
             nextToken();
             nextToken();
 
-            parameters.push_back(std::make_unique<Identifier>(currentToken, currentToken.literal));
+            parameters.push_back(makeNode<Identifier>(currentToken, currentToken.symbol));
         }
         if (!expectPeekAndConsume(TokenType::RPAREN)) {
             return {};
@@ -299,7 +456,7 @@ namespace Common {
         return parameters;
     }
 
-    std::unique_ptr<IfExpression> Parser::parseIfExpression() {
+    NodePtr<IfExpression> Parser::parseIfExpression() {
         auto token = currentToken;
         if (!expectPeekAndConsume(TokenType::LPAREN)) {
             return nullptr;
@@ -316,7 +473,7 @@ namespace Common {
         }
 
         auto consequence = parseBlockStatement();
-        std::unique_ptr<BlockStatement> alternative = nullptr;
+        NodePtr<BlockStatement> alternative = nullptr;
         if (peekToken.type == TokenType::ELSE) {
             nextToken();
 
@@ -326,11 +483,155 @@ namespace Common {
             alternative = parseBlockStatement();
 
         }
-        return std::make_unique<IfExpression>(token, std::move(condition), std::move(consequence),
+        return makeNode<IfExpression>(token, std::move(condition), std::move(consequence),
                                               std::move(alternative));
     }
 
-    std::unique_ptr<ReturnStatement> Parser::parseReturnStatement() {
+    // literal integer, float, string or boolean, negative numbers included
+    bool isMatchPattern(Expression *expression) {
+        switch (expression->getType()) {
+            case NodeType::IntegerExpression:
+            case NodeType::FloatExpression:
+            case NodeType::StringExpression:
+            case NodeType::BoolExpression:
+                return true;
+            case NodeType::PrefixExpression: {
+                auto prefixExpression = static_cast<PrefixExpression *>(expression);
+                auto right = prefixExpression->rightExpression.get();
+                return prefixExpression->prefixOperator == PrefixOperator::Minus && right != nullptr &&
+                       (right->getType() == NodeType::IntegerExpression ||
+                        right->getType() == NodeType::FloatExpression);
+            }
+            default:
+                return false;
+        }
+    }
+
+    NodePtr<MatchExpression> Parser::parseMatchExpression() {
+        auto token = currentToken;
+        if (!expectPeekAndConsume(TokenType::LPAREN)) {
+            return nullptr;
+        }
+        nextToken();
+
+        auto subject = parseExpression(Precedence::LOWEST);
+
+        if (!expectPeekAndConsume(TokenType::RPAREN)) {
+            return nullptr;
+        }
+        if (!expectPeekAndConsume(TokenType::LBRACE)) {
+            return nullptr;
+        }
+
+        std::vector<MatchArm> arms;
+        while (peekToken.type != TokenType::RBRACE && peekToken.type != TokenType::_EOF) {
+            nextToken();
+            MatchArm arm;
+            if (!parseMatchArm(arm)) {
+                return nullptr;
+            }
+            arms.push_back(std::move(arm));
+            if (peekToken.type == TokenType::COMMA) {
+                nextToken();
+            }
+        }
+        if (!expectPeekAndConsume(TokenType::RBRACE)) {
+            return nullptr;
+        }
+        return makeNode<MatchExpression>(token, std::move(subject), std::move(arms));
+    }
+
+    bool Parser::parseMatchArm(MatchArm &arm) {
+        if (currentToken.type != TokenType::IDENTIFIER || currentToken.literal != "_") {
+            while (true) {
+                auto pattern = parseExpression(Precedence::LOWEST);
+                if (pattern == nullptr) {
+                    return false;
+                }
+                if (!isMatchPattern(pattern.get())) {
+                    errors.push_back(std::make_unique<ParserError>(
+                            currentToken, "match pattern must be a literal, got " + pattern->toString()));
+                    return false;
+                }
+                arm.patterns.push_back(std::move(pattern));
+                if (peekToken.type != TokenType::COMMA) {
+                    break;
+                }
+                nextToken();
+                nextToken();
+            }
+        }
+        if (!expectPeekAndConsume(TokenType::ARROW)) {
+            return false;
+        }
+        nextToken();
+        if (currentToken.type == TokenType::LBRACE) {
+            arm.body = parseBlockStatement();
+            return true;
+        }
+        auto token = currentToken;
+        auto value = parseExpression(Precedence::LOWEST);
+        if (value == nullptr) {
+            return false;
+        }
+        std::vector<NodePtr<Statement>> statements;
+        statements.push_back(makeNode<ExpressionStatement>(token, std::move(value)));
+        arm.body = makeNode<BlockStatement>(token, std::move(statements));
+        return true;
+    }
+
+    NodePtr<WhileStatement> Parser::parseWhileStatement() {
+        auto token = currentToken;
+        if (!expectPeekAndConsume(TokenType::LPAREN)) {
+            return nullptr;
+        }
+        nextToken();
+
+        auto condition = parseExpression(Precedence::LOWEST);
+
+        if (!expectPeekAndConsume(TokenType::RPAREN)) {
+            return nullptr;
+        }
+        if (!expectPeekAndConsume(TokenType::LBRACE)) {
+            return nullptr;
+        }
+        auto body = parseBlockStatement();
+        if (peekToken.type == TokenType::SEMICOLON) {
+            nextToken();
+        }
+        return makeNode<WhileStatement>(token, std::move(condition), std::move(body));
+    }
+
+    NodePtr<ForStatement> Parser::parseForStatement() {
+        auto token = currentToken;
+        if (!expectPeekAndConsume(TokenType::LPAREN)) {
+            return nullptr;
+        }
+        if (!expectPeekAndConsume(TokenType::IDENTIFIER)) {
+            return nullptr;
+        }
+        auto variable = makeNode<Identifier>(currentToken, currentToken.symbol);
+        if (!expectPeekAndConsume(TokenType::IN)) {
+            return nullptr;
+        }
+        nextToken();
+
+        auto iterable = parseExpression(Precedence::LOWEST);
+
+        if (!expectPeekAndConsume(TokenType::RPAREN)) {
+            return nullptr;
+        }
+        if (!expectPeekAndConsume(TokenType::LBRACE)) {
+            return nullptr;
+        }
+        auto body = parseBlockStatement();
+        if (peekToken.type == TokenType::SEMICOLON) {
+            nextToken();
+        }
+        return makeNode<ForStatement>(token, std::move(variable), std::move(iterable), std::move(body));
+    }
+
+    NodePtr<ReturnStatement> Parser::parseReturnStatement() {
         auto token = currentToken;
         nextToken();
 
@@ -339,52 +640,66 @@ namespace Common {
         if (peekToken.type == TokenType::SEMICOLON) {
             nextToken();
         }
-        return std::make_unique<ReturnStatement>(token, std::move(returnValue));
+        return makeNode<ReturnStatement>(token, std::move(returnValue));
     }
 
-    std::unique_ptr<ExpressionStatement> Parser::parseExpressionStatement() {
+    NodePtr<Statement> Parser::parseExpressionStatement() {
         auto token = currentToken;
         auto expr = parseExpression(Precedence::LOWEST);
+        if (peekToken.type == TokenType::ASSIGN && expr != nullptr &&
+            (expr->getType() == NodeType::Identifier || expr->getType() == NodeType::IndexExpression)) {
+            return parseAssignStatement(std::move(expr));
+        }
         if (peekToken.type == TokenType::SEMICOLON) {
             nextToken();
         }
-        return std::make_unique<ExpressionStatement>(token, std::move(expr));
+        return makeNode<ExpressionStatement>(token, std::move(expr));
     }
 
-    Precedence Parser::peekPrecedence() {
-        if (precedences.contains(peekToken.type)) {
-            return precedences[peekToken.type];
+    NodePtr<AssignStatement> Parser::parseAssignStatement(NodePtr<Expression> target) {
+        nextToken();
+        auto token = currentToken;
+        nextToken();
+        auto value = parseExpression(Precedence::LOWEST);
+        if (value == nullptr) {
+            return nullptr;
+        }
+        if (peekToken.type == TokenType::SEMICOLON) {
+            nextToken();
         }
-        return Precedence::LOWEST;
+        return makeNode<AssignStatement>(token, std::move(target), std::move(value));
     }
 
-    std::unique_ptr<InfixExpression> Parser::parseInfixExpression(std::unique_ptr<Expression> left) {
+    Precedence Parser::peekPrecedence() {
+        return rules[tokenTypeIndex(peekToken.type)].precedence;
+    }
+
+    NodePtr<InfixExpression> Parser::parseInfixExpression(NodePtr<Expression> left) {
         auto token = currentToken;
-        auto precedence = precedences[currentToken.type];
+        auto precedence = rules[tokenTypeIndex(currentToken.type)].precedence;
         nextToken();
         auto right = parseExpression(precedence);
-        return std::make_unique<InfixExpression>(token, std::move(left), std::move(right), token.literal);
+        return makeNode<InfixExpression>(token, infixOperatorOf(token.type), std::move(left), std::move(right));
     }
 
-    std::unique_ptr<IndexExpression> Parser::parseIndexExpression(std::unique_ptr<Expression> left) {
+    NodePtr<IndexExpression> Parser::parseIndexExpression(NodePtr<Expression> left) {
         auto token = currentToken;
         nextToken();
         auto indexExpression = parseExpression(Precedence::LOWEST);
         if (!expectPeekAndConsume(TokenType::RBRACKET)) {
             return nullptr;
         }
-        return make_unique<IndexExpression>(token, std::move(left), std::move(indexExpression));
+        return makeNode<IndexExpression>(token, std::move(left), std::move(indexExpression));
     }
 
-    std::unique_ptr<CallExpression> Parser::parseCallExpression(std::unique_ptr<Expression> left) {
+    NodePtr<CallExpression> Parser::parseCallExpression(NodePtr<Expression> left) {
         auto token = currentToken;
-        nextToken();
         auto arguments = parseCallArguments();
-        return std::make_unique<CallExpression>(token, std::move(left), std::move(arguments));
+        return makeNode<CallExpression>(token, std::move(left), std::move(arguments));
     }
 
-    std::vector<std::unique_ptr<Expression>> Parser::parseCallArguments() {
-        std::vector<std::unique_ptr<Expression>> args;
+    std::vector<NodePtr<Expression>> Parser::parseCallArguments() {
+        std::vector<NodePtr<Expression>> args;
 
         if (peekToken.type == TokenType::RPAREN) {
             nextToken();
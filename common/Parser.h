@@ -5,6 +5,7 @@
 #ifndef GOINTERPRETER_PARSER_H
 #define GOINTERPRETER_PARSER_H
 
+#include <array>
 #include <string>
 #include <utility>
 #include <vector>
@@ -16,13 +17,15 @@ namespace Common {
     using namespace std;
     enum class Precedence {
         LOWEST = 0,
-        EQUALS = 1,
-        LESS = 2,
-        SUM = 3,
-        PRODUCT = 4,
-        PREFIX = 5,
-        CALL = 6,
-        INDEX = 7,
+        OR = 1,
+        AND = 2,
+        EQUALS = 3,
+        LESS = 4,
+        SUM = 5,
+        PRODUCT = 6,
+        PREFIX = 7,
+        CALL = 8,
+        INDEX = 9,
     };
 
     class ParserError {
@@ -37,36 +40,81 @@ namespace Common {
 
     };
 
+    // replaces `removed` bytes at `offset` of a program text with `inserted`
+    struct TextEdit {
+        std::size_t offset;
+        std::size_t removed;
+        std::string inserted;
+    };
+
     class Parser {
     public:
         explicit Parser(Lexer *lexer)
-                : lexer(lexer) {
-
-            precedences[TokenType::EQ] = Precedence::EQUALS;
-            precedences[TokenType::NOT_EQ] = Precedence::EQUALS;
-            precedences[TokenType::LT] = Precedence::LESS;
-            precedences[TokenType::GT] = Precedence::LESS;
-            precedences[TokenType::PLUS] = Precedence::SUM;
-            precedences[TokenType::MINUS] = Precedence::SUM;
-            precedences[TokenType::SLASH] = Precedence::PRODUCT;
-            precedences[TokenType::ASTERISK] = Precedence::PRODUCT;
-            precedences[TokenType::LPAREN] = Precedence::CALL;
-            precedences[TokenType::LBRACKET] = Precedence::INDEX;
-        }
+                : lexer(lexer), storage{std::make_shared<SyntaxStorage>(lexer->getSource(), lexer->getSymbols())} {}
 
         std::unique_ptr<Program> parseProgram();
 
+        // Parses the text of `previous` with `edit` applied. Only the statements around the edit are lexed and
+        // parsed again, the statements before them and the ones after the point where parsing lines up with
+        // an old statement boundary again are moved over from `previous`. A previous program with syntax errors
+        // is parsed in full, so the errors of the result are always those of the whole edited text. The edited
+        // text is interned into the symbol table of `previous`.
+        static std::unique_ptr<Program> reparse(std::unique_ptr<Program> previous, const TextEdit &edit);
+
     private:
+        using PrefixParseFn = NodePtr<Expression> (Parser::*)();
+        using InfixParseFn = NodePtr<Expression> (Parser::*)(NodePtr<Expression> left);
+
+        // How a token type is parsed at the start of an expression and after a left operand. `precedence`
+        // is the binding power of the infix form.
+        struct ParseRule {
+            PrefixParseFn prefix{nullptr};
+            InfixParseFn infix{nullptr};
+            Precedence precedence{Precedence::LOWEST};
+        };
+
+        // indexed by tokenTypeIndex, constant initialized in Parser.cpp
+        static const std::array<ParseRule, TOKEN_TYPE_COUNT> rules;
+
+        // adapt the typed parse functions to the signatures of the rule table
+        template<auto parse>
+        NodePtr<Expression> prefixRule() {
+            return (this->*parse)();
+        }
+
+        template<auto parse>
+        NodePtr<Expression> infixRule(NodePtr<Expression> left) {
+            return (this->*parse)(std::move(left));
+        }
+
+        // continues parsing at the statement before the first one `edit` can change
+        std::unique_ptr<Program> parseEdited(Program &previous, std::size_t first, const TextEdit &edit);
+
+        // the parsed program carrying the messages of the errors found on the way
+        std::unique_ptr<Program> makeProgram(std::vector<NodePtr<Statement>> statements,
+                                             std::vector<StatementOrigin> origins);
+
+        // parses the statement at the current token and moves past it
+        void appendStatement(std::vector<NodePtr<Statement>> &statements, std::vector<StatementOrigin> &origins);
 
-        std::unique_ptr<Statement> parseStatement();
+        // offset of the first character of `token` in the source
+        std::size_t sourceOffset(const Token &token) const;
 
-        std::unique_ptr<LetStatement> parseLetStatement();
+        NodePtr<Statement> parseStatement();
 
-        std::unique_ptr<ReturnStatement> parseReturnStatement();
+        NodePtr<LetStatement> parseLetStatement();
 
-        std::unique_ptr<ExpressionStatement> parseExpressionStatement();
+        NodePtr<ReturnStatement> parseReturnStatement();
 
-        std::unique_ptr<BlockStatement> parseBlockStatement();
+        NodePtr<Statement> parseExpressionStatement();
+
+        NodePtr<AssignStatement> parseAssignStatement(NodePtr<Expression> target);
+
+        NodePtr<WhileStatement> parseWhileStatement();
+
+        NodePtr<ForStatement> parseForStatement();
+
+        NodePtr<BlockStatement> parseBlockStatement();
 
         bool expectPeekAndConsume(TokenType tokenType);
 
@@ -74,43 +122,57 @@ namespace Common {
 
         Precedence peekPrecedence();
 
-        std::unique_ptr<Expression> parseExpression(Precedence precedence);
+        NodePtr<Expression> parseExpression(Precedence precedence);
+
+        NodePtr<Identifier> parseIdentifier();
 
-        std::unique_ptr<IntegerExpression> parseIntegerExpression();
+        NodePtr<IntegerExpression> parseIntegerExpression();
 
-        std::unique_ptr<StringExpression> parseStringExpression();
+        NodePtr<FloatExpression> parseFloatExpression();
 
-        std::unique_ptr<PrefixExpression> parsePrefixExpression();
+        NodePtr<StringExpression> parseStringExpression();
 
-        std::unique_ptr<BoolExpression> parseBoolExpression();
+        NodePtr<PrefixExpression> parsePrefixExpression();
 
-        std::unique_ptr<IfExpression> parseIfExpression();
+        NodePtr<BoolExpression> parseBoolExpression();
 
-        std::unique_ptr<Expression> parseGroupedExpression();
+        NodePtr<IfExpression> parseIfExpression();
 
-        std::unique_ptr<ArrayExpression> parseArrayExpression();
+        NodePtr<MatchExpression> parseMatchExpression();
 
-        std::unique_ptr<HashExpression> parseHashExpression();
+        bool parseMatchArm(MatchArm &arm);
 
-        std::unique_ptr<FunctionExpression> parseFunctionExpression();
+        NodePtr<Expression> parseGroupedExpression();
 
-        std::vector<std::unique_ptr<Identifier>> parseFunctionParameters();
+        NodePtr<ArrayExpression> parseArrayExpression();
 
-        std::unique_ptr<InfixExpression> parseInfixExpression(std::unique_ptr<Expression> left);
+        NodePtr<HashExpression> parseHashExpression();
 
-        std::unique_ptr<IndexExpression> parseIndexExpression(std::unique_ptr<Expression> left);
+        NodePtr<FunctionExpression> parseFunctionExpression();
 
-        std::unique_ptr<CallExpression> parseCallExpression(std::unique_ptr<Expression> left);
+        std::vector<NodePtr<Identifier>> parseFunctionParameters();
 
-        std::vector<std::unique_ptr<Expression>> parseCallArguments();
+        NodePtr<InfixExpression> parseInfixExpression(NodePtr<Expression> left);
+
+        NodePtr<IndexExpression> parseIndexExpression(NodePtr<Expression> left);
+
+        NodePtr<CallExpression> parseCallExpression(NodePtr<Expression> left);
+
+        std::vector<NodePtr<Expression>> parseCallArguments();
 
         void nextToken();
 
+        // nodes live in the arena of the program being parsed
+        template<typename T, typename... Args>
+        NodePtr<T> makeNode(Args &&... args) {
+            return NodePtr<T>{storage->allocate<T>(std::forward<Args>(args)...)};
+        }
+
         Lexer *lexer;
+        std::shared_ptr<SyntaxStorage> storage;
         Token currentToken{TokenType::START, ""};
         Token peekToken{TokenType::START, ""};
         std::vector<std::unique_ptr<ParserError>> errors;
-        std::map<TokenType, Precedence> precedences;
     };
 }
 
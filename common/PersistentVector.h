@@ -0,0 +1,257 @@
+//
+// Created by seeu on 2022/8/27.
+//
+
+#ifndef GOINTERPRETER_PERSISTENTVECTOR_H
+#define GOINTERPRETER_PERSISTENTVECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace Common {
+
+    // Bit-partitioned vector trie with 32-way branching. Every version shares the nodes it did not
+    // touch with the version it was derived from, so `pushBack` and `set` copy at most one path.
+    // The last (up to) 32 elements live in a tail leaf outside the trie. The tail remembers how many
+    // of its slots are claimed: appending to the newest version writes into the shared tail in place,
+    // which makes building a vector one element at a time amortized O(1).
+    template<typename T>
+    class PersistentVector {
+        static constexpr std::size_t BITS = 5;
+        static constexpr std::size_t WIDTH = 1 << BITS;
+        static constexpr std::size_t MASK = WIDTH - 1;
+
+        struct Node {
+        };
+
+        struct Branch : Node {
+            std::array<std::shared_ptr<Node>, WIDTH> children{};
+        };
+
+        struct Leaf : Node {
+            std::array<T, WIDTH> values{};
+            // slots written by the newest version sharing this leaf
+            std::size_t claimed{0};
+        };
+
+    public:
+        class ConstIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            ConstIterator() = default;
+
+            ConstIterator(const PersistentVector *vector, std::size_t index) : vector{vector}, index{index} {
+                if (vector != nullptr && index < vector->count) {
+                    leaf = vector->leafFor(index);
+                }
+            }
+
+            reference operator*() const { return leaf->values[index & MASK]; }
+
+            pointer operator->() const { return &leaf->values[index & MASK]; }
+
+            ConstIterator &operator++() {
+                index++;
+                // only cross into the next leaf on a 32 elements boundary
+                if ((index & MASK) == 0 && index < vector->count) {
+                    leaf = vector->leafFor(index);
+                }
+                return *this;
+            }
+
+            ConstIterator operator++(int) {
+                auto it = *this;
+                ++*this;
+                return it;
+            }
+
+            bool operator==(const ConstIterator &other) const { return index == other.index; }
+
+            bool operator!=(const ConstIterator &other) const { return index != other.index; }
+
+        private:
+            const PersistentVector *vector{nullptr};
+            std::size_t index{0};
+            const Leaf *leaf{nullptr};
+        };
+
+        PersistentVector() = default;
+
+        template<typename It>
+        PersistentVector(It first, It last) {
+            for (; first != last; ++first) {
+                appendInPlace(*first);
+            }
+        }
+
+        std::size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        const T &operator[](std::size_t index) const {
+            return leafFor(index)->values[index & MASK];
+        }
+
+        ConstIterator begin() const { return {this, 0}; }
+
+        ConstIterator end() const { return {this, count}; }
+
+        ConstIterator iteratorAt(std::size_t index) const { return {this, index}; }
+
+        // contiguous run of elements starting at index, it ends at the next 32 elements boundary or at size()
+        std::pair<const T *, std::size_t> chunkAt(std::size_t index) const {
+            auto leaf = leafFor(index);
+            auto leafEnd = std::min((index | MASK) + 1, count);
+            return {&leaf->values[index & MASK], leafEnd - index};
+        }
+
+        PersistentVector pushBack(T value) const {
+            auto result = *this;
+            result.appendInPlace(std::move(value));
+            return result;
+        }
+
+        PersistentVector set(std::size_t index, T value) const {
+            auto result = *this;
+            if (index >= tailOffset()) {
+                auto leaf = std::make_shared<Leaf>(*tail);
+                leaf->claimed = count - tailOffset();
+                leaf->values[index & MASK] = std::move(value);
+                result.tail = std::move(leaf);
+            } else {
+                result.root = assoc(shift, root, index, std::move(value));
+            }
+            return result;
+        }
+
+        // transient update: nodes referenced only by this version are written in place, shared ones are copied
+        void setInPlace(std::size_t index, T value) {
+            if (index >= tailOffset()) {
+                if (tail.use_count() != 1) {
+                    auto leaf = std::make_shared<Leaf>();
+                    auto tailSize = count - tailOffset();
+                    std::copy_n(tail->values.begin(), tailSize, leaf->values.begin());
+                    leaf->claimed = tailSize;
+                    tail = std::move(leaf);
+                }
+                tail->values[index & MASK] = std::move(value);
+                return;
+            }
+            auto node = &root;
+            for (auto level = shift;; level -= BITS) {
+                if (node->use_count() != 1) {
+                    *node = level == 0 ? std::shared_ptr<Node>{std::make_shared<Leaf>(*static_cast<Leaf *>(node->get()))}
+                                       : std::make_shared<Branch>(*static_cast<Branch *>(node->get()));
+                }
+                if (level == 0) {
+                    static_cast<Leaf *>(node->get())->values[index & MASK] = std::move(value);
+                    return;
+                }
+                node = &static_cast<Branch *>(node->get())->children[(index >> level) & MASK];
+            }
+        }
+
+    private:
+        std::size_t tailOffset() const {
+            return count < WIDTH ? 0 : ((count - 1) >> BITS) << BITS;
+        }
+
+        const Leaf *leafFor(std::size_t index) const {
+            if (index >= tailOffset()) {
+                return tail.get();
+            }
+            auto node = root.get();
+            for (auto level = shift; level > 0; level -= BITS) {
+                node = static_cast<const Branch *>(node)->children[(index >> level) & MASK].get();
+            }
+            return static_cast<const Leaf *>(node);
+        }
+
+        void appendInPlace(T value) {
+            auto tailSize = count - tailOffset();
+            if (tail != nullptr && tailSize < WIDTH) {
+                if (tail->claimed != tailSize) {
+                    // another version already wrote past our end of this tail, detach a copy
+                    auto leaf = std::make_shared<Leaf>();
+                    std::copy_n(tail->values.begin(), tailSize, leaf->values.begin());
+                    leaf->claimed = tailSize;
+                    tail = std::move(leaf);
+                }
+                tail->values[tailSize] = std::move(value);
+                tail->claimed++;
+                count++;
+                return;
+            }
+
+            if (tail != nullptr) {
+                // full tail moves into the trie
+                if ((count >> BITS) > (std::size_t{1} << shift)) {
+                    auto newRoot = std::make_shared<Branch>();
+                    newRoot->children[0] = std::move(root);
+                    newRoot->children[1] = newPath(shift, tail);
+                    root = std::move(newRoot);
+                    shift += BITS;
+                } else {
+                    root = pushTail(shift, root, tail);
+                }
+            }
+            auto leaf = std::make_shared<Leaf>();
+            leaf->values[0] = std::move(value);
+            leaf->claimed = 1;
+            tail = std::move(leaf);
+            count++;
+        }
+
+        std::shared_ptr<Node> pushTail(std::size_t level, const std::shared_ptr<Node> &parent,
+                                       const std::shared_ptr<Leaf> &leaf) const {
+            auto subIndex = ((count - 1) >> level) & MASK;
+            auto result = parent == nullptr ? std::make_shared<Branch>()
+                                            : std::make_shared<Branch>(*static_cast<const Branch *>(parent.get()));
+            if (level == BITS) {
+                result->children[subIndex] = leaf;
+            } else {
+                auto &child = result->children[subIndex];
+                child = child != nullptr ? pushTail(level - BITS, child, leaf) : newPath(level - BITS, leaf);
+            }
+            return result;
+        }
+
+        static std::shared_ptr<Node> newPath(std::size_t level, const std::shared_ptr<Leaf> &leaf) {
+            if (level == 0) {
+                return leaf;
+            }
+            auto branch = std::make_shared<Branch>();
+            branch->children[0] = newPath(level - BITS, leaf);
+            return branch;
+        }
+
+        static std::shared_ptr<Node> assoc(std::size_t level, const std::shared_ptr<Node> &node,
+                                           std::size_t index, T value) {
+            if (level == 0) {
+                auto leaf = std::make_shared<Leaf>(*static_cast<const Leaf *>(node.get()));
+                leaf->values[index & MASK] = std::move(value);
+                return leaf;
+            }
+            auto branch = std::make_shared<Branch>(*static_cast<const Branch *>(node.get()));
+            auto subIndex = (index >> level) & MASK;
+            branch->children[subIndex] = assoc(level - BITS, branch->children[subIndex], index, std::move(value));
+            return branch;
+        }
+
+        std::size_t count{0};
+        std::size_t shift{BITS};
+        std::shared_ptr<Node> root{nullptr};
+        std::shared_ptr<Leaf> tail{nullptr};
+    };
+}
+
+#endif //GOINTERPRETER_PERSISTENTVECTOR_H
@@ -0,0 +1,687 @@
+//
+// Created by seeu on 2022/8/28.
+//
+
+#include "Simd.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GI_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace Common::Simd {
+
+    namespace scalar {
+        std::optional<std::int64_t> sum(const std::int64_t *data, std::size_t size) {
+            std::int64_t result = 0;
+            for (std::size_t i = 0; i < size; i++) {
+                if (__builtin_add_overflow(result, data[i], &result)) {
+                    return std::nullopt;
+                }
+            }
+            return result;
+        }
+
+        std::int64_t min(const std::int64_t *data, std::size_t size) {
+            return *std::min_element(data, data + size);
+        }
+
+        std::int64_t max(const std::int64_t *data, std::size_t size) {
+            return *std::max_element(data, data + size);
+        }
+
+        std::optional<std::int64_t> dot(const std::int64_t *left, const std::int64_t *right, std::size_t size) {
+            std::int64_t result = 0;
+            for (std::size_t i = 0; i < size; i++) {
+                std::int64_t product;
+                if (__builtin_mul_overflow(left[i], right[i], &product) ||
+                    __builtin_add_overflow(result, product, &result)) {
+                    return std::nullopt;
+                }
+            }
+            return result;
+        }
+
+        // adds the lane partials of a vector kernel to the result of its scalar tail
+        std::optional<std::int64_t> addLanes(const std::int64_t *lanes, std::size_t count,
+                                             std::optional<std::int64_t> tail) {
+            if (!tail.has_value()) {
+                return std::nullopt;
+            }
+            auto result = *tail;
+            for (std::size_t i = 0; i < count; i++) {
+                if (__builtin_add_overflow(result, lanes[i], &result)) {
+                    return std::nullopt;
+                }
+            }
+            return result;
+        }
+
+        bool addScalar(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+            bool overflow = false;
+            for (std::size_t i = 0; i < size; i++) {
+                overflow |= __builtin_add_overflow(data[i], value, &out[i]);
+            }
+            return !overflow;
+        }
+
+        std::size_t filterGreater(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < size; i++) {
+                out[count] = data[i];
+                count += data[i] > value;
+            }
+            return count;
+        }
+
+        void sqrt(const double *data, std::size_t size, double *out) {
+            for (std::size_t i = 0; i < size; i++) {
+                out[i] = std::sqrt(data[i]);
+            }
+        }
+
+        void floor(const double *data, std::size_t size, double *out) {
+            for (std::size_t i = 0; i < size; i++) {
+                out[i] = std::floor(data[i]);
+            }
+        }
+
+        std::size_t find(const char *haystack, std::size_t haystackSize, const char *needle, std::size_t needleSize) {
+            auto position = std::string_view{haystack, haystackSize}.find(std::string_view{needle, needleSize});
+            return position == std::string_view::npos ? haystackSize : position;
+        }
+
+        inline bool isWhitespace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        inline bool isLetter(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        inline bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        inline bool isStringEnd(char c) {
+            return c == '"' || c == '\n' || c == 0;
+        }
+
+        template<bool (*InRun)(char)>
+        std::size_t run(const char *data, std::size_t size) {
+            std::size_t i = 0;
+            while (i < size && InRun(data[i])) {
+                i++;
+            }
+            return i;
+        }
+
+        std::size_t whitespaceRun(const char *data, std::size_t size) {
+            return run<isWhitespace>(data, size);
+        }
+
+        std::size_t letterRun(const char *data, std::size_t size) {
+            return run<isLetter>(data, size);
+        }
+
+        std::size_t digitRun(const char *data, std::size_t size) {
+            return run<isDigit>(data, size);
+        }
+
+        std::size_t stringRun(const char *data, std::size_t size) {
+            std::size_t i = 0;
+            while (i < size && !isStringEnd(data[i])) {
+                i++;
+            }
+            return i;
+        }
+    }
+
+    // single bytes go to memchr, which libc already vectorizes
+    std::size_t findByte(const char *haystack, std::size_t haystackSize, char byte) {
+        auto found = static_cast<const char *>(std::memchr(haystack, byte, haystackSize));
+        return found == nullptr ? haystackSize : std::size_t(found - haystack);
+    }
+
+#ifdef GI_SIMD_X86
+    namespace sse2 {
+        // low 64 bits of a 64x64 multiply, built from 32x32->64 multiplies
+        __attribute__((target("sse2")))
+        inline __m128i mul64(__m128i a, __m128i b) {
+            auto low = _mm_mul_epu32(a, b);
+            auto cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b),
+                                       _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+            return _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+        }
+
+        // sign bit set in the lanes where left + right = sum overflowed
+        __attribute__((target("sse2")))
+        inline __m128i addOverflow(__m128i left, __m128i right, __m128i sum) {
+            return _mm_and_si128(_mm_xor_si128(left, sum), _mm_xor_si128(right, sum));
+        }
+
+        __attribute__((target("sse2")))
+        std::optional<std::int64_t> sum(const std::int64_t *data, std::size_t size) {
+            auto acc = _mm_setzero_si128();
+            auto overflow = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                auto next = _mm_add_epi64(acc, x);
+                overflow = _mm_or_si128(overflow, addOverflow(acc, x, next));
+                acc = next;
+            }
+            if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) {
+                return std::nullopt;
+            }
+            alignas(16) std::int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+            return scalar::addLanes(lanes, 2, scalar::sum(data + i, size - i));
+        }
+
+        __attribute__((target("sse2")))
+        std::optional<std::int64_t> dot(const std::int64_t *left, const std::int64_t *right, std::size_t size) {
+            // products of operands in [-2^31, 2^31) fit into an int64, larger operands take the scalar path
+            auto bias = _mm_set1_epi64x(std::int64_t{1} << 31);
+            auto range = _mm_setzero_si128();
+            auto acc = _mm_setzero_si128();
+            auto overflow = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i));
+                range = _mm_or_si128(range, _mm_or_si128(_mm_add_epi64(a, bias), _mm_add_epi64(b, bias)));
+                auto product = mul64(a, b);
+                auto next = _mm_add_epi64(acc, product);
+                overflow = _mm_or_si128(overflow, addOverflow(acc, product, next));
+                acc = next;
+            }
+            alignas(16) std::int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_srli_epi64(range, 32));
+            if ((lanes[0] | lanes[1]) != 0) {
+                return scalar::dot(left, right, size);
+            }
+            if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) {
+                return std::nullopt;
+            }
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+            return scalar::addLanes(lanes, 2, scalar::dot(left + i, right + i, size - i));
+        }
+
+        __attribute__((target("sse2")))
+        bool addScalar(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+            auto v = _mm_set1_epi64x(value);
+            auto overflow = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                auto sum = _mm_add_epi64(x, v);
+                overflow = _mm_or_si128(overflow, addOverflow(x, v, sum));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sum);
+            }
+            auto rest = scalar::addScalar(data + i, size - i, value, out + i);
+            return rest && _mm_movemask_pd(_mm_castsi128_pd(overflow)) == 0;
+        }
+
+        __attribute__((target("sse2")))
+        void sqrt(const double *data, std::size_t size, double *out) {
+            std::size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(data + i)));
+            }
+            scalar::sqrt(data + i, size - i, out + i);
+        }
+
+        // candidates are positions whose first and last byte match, only those are compared in full
+        __attribute__((target("sse2")))
+        std::size_t find(const char *haystack, std::size_t haystackSize, const char *needle, std::size_t needleSize) {
+            if (needleSize < 2 || needleSize > haystackSize) {
+                return needleSize == 1 ? findByte(haystack, haystackSize, needle[0])
+                                       : scalar::find(haystack, haystackSize, needle, needleSize);
+            }
+            auto first = _mm_set1_epi8(needle[0]);
+            auto last = _mm_set1_epi8(needle[needleSize - 1]);
+            std::size_t i = 0;
+            for (; i + needleSize - 1 + 16 <= haystackSize; i += 16) {
+                auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+                auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needleSize - 1));
+                auto mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                                                     _mm_cmpeq_epi8(blockLast, last))));
+                for (; mask != 0; mask &= mask - 1) {
+                    auto candidate = i + std::size_t(__builtin_ctz(mask));
+                    if (std::memcmp(haystack + candidate + 1, needle + 1, needleSize - 2) == 0) {
+                        return candidate;
+                    }
+                }
+            }
+            return i + scalar::find(haystack + i, haystackSize - i, needle, needleSize);
+        }
+
+        // Character classes as byte masks. Bytes above 0x7f are negative for the signed compares and so
+        // fall outside every range.
+        __attribute__((target("sse2")))
+        inline __m128i between(__m128i block, char low, char high) {
+            return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(char(low - 1))),
+                                 _mm_cmpgt_epi8(_mm_set1_epi8(char(high + 1)), block));
+        }
+
+        __attribute__((target("sse2")))
+        inline __m128i whitespace(__m128i block) {
+            return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+                                             _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))),
+                                _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')),
+                                             _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+        }
+
+        __attribute__((target("sse2")))
+        inline __m128i letter(__m128i block) {
+            // setting 0x20 folds 'A'-'Z' onto 'a'-'z', nothing else lands in that range
+            return _mm_or_si128(between(_mm_or_si128(block, _mm_set1_epi8(0x20)), 'a', 'z'),
+                                _mm_cmpeq_epi8(block, _mm_set1_epi8('_')));
+        }
+
+        __attribute__((target("sse2")))
+        inline __m128i digit(__m128i block) {
+            return between(block, '0', '9');
+        }
+
+        __attribute__((target("sse2")))
+        inline __m128i notStringEnd(__m128i block) {
+            auto end = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+                                                 _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+                                    _mm_cmpeq_epi8(block, _mm_setzero_si128()));
+            return _mm_xor_si128(end, _mm_set1_epi8(-1));
+        }
+
+        template<__m128i (*InRun)(__m128i), std::size_t (*Tail)(const char *, std::size_t)>
+        __attribute__((target("sse2")))
+        std::size_t run(const char *data, std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                auto outside = ~unsigned(_mm_movemask_epi8(InRun(block))) & 0xffffu;
+                if (outside != 0) {
+                    return i + std::size_t(__builtin_ctz(outside));
+                }
+            }
+            return i + Tail(data + i, size - i);
+        }
+    }
+
+    namespace avx2 {
+        __attribute__((target("avx2")))
+        inline __m256i load(const std::int64_t *data) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        }
+
+        __attribute__((target("avx2")))
+        inline void lanes(__m256i value, std::int64_t (&out)[4]) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), value);
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i mul64(__m256i a, __m256i b) {
+            auto low = _mm256_mul_epu32(a, b);
+            auto cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                          _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+            return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i addOverflow(__m256i left, __m256i right, __m256i sum) {
+            return _mm256_and_si256(_mm256_xor_si256(left, sum), _mm256_xor_si256(right, sum));
+        }
+
+        __attribute__((target("avx2")))
+        inline bool anyOverflow(__m256i overflow) {
+            return _mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0;
+        }
+
+        __attribute__((target("avx2")))
+        std::optional<std::int64_t> sum(const std::int64_t *data, std::size_t size) {
+            auto acc0 = _mm256_setzero_si256();
+            auto acc1 = _mm256_setzero_si256();
+            auto overflow = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                auto x0 = load(data + i);
+                auto x1 = load(data + i + 4);
+                auto next0 = _mm256_add_epi64(acc0, x0);
+                auto next1 = _mm256_add_epi64(acc1, x1);
+                overflow = _mm256_or_si256(overflow, _mm256_or_si256(addOverflow(acc0, x0, next0),
+                                                                     addOverflow(acc1, x1, next1)));
+                acc0 = next0;
+                acc1 = next1;
+            }
+            for (; i + 4 <= size; i += 4) {
+                auto x = load(data + i);
+                auto next = _mm256_add_epi64(acc0, x);
+                overflow = _mm256_or_si256(overflow, addOverflow(acc0, x, next));
+                acc0 = next;
+            }
+            if (anyOverflow(overflow)) {
+                return std::nullopt;
+            }
+            std::int64_t out0[4];
+            std::int64_t out1[4];
+            lanes(acc0, out0);
+            lanes(acc1, out1);
+            return scalar::addLanes(out0, 4, scalar::addLanes(out1, 4, scalar::sum(data + i, size - i)));
+        }
+
+        template<bool IsMin>
+        __attribute__((target("avx2")))
+        std::int64_t extreme(const std::int64_t *data, std::size_t size) {
+            if (size < 4) {
+                return IsMin ? scalar::min(data, size) : scalar::max(data, size);
+            }
+            auto acc = load(data);
+            std::size_t i = 4;
+            for (; i + 4 <= size; i += 4) {
+                auto x = load(data + i);
+                // select x where it beats the accumulator
+                auto mask = IsMin ? _mm256_cmpgt_epi64(acc, x) : _mm256_cmpgt_epi64(x, acc);
+                acc = _mm256_blendv_epi8(acc, x, mask);
+            }
+            std::int64_t out[4];
+            lanes(acc, out);
+            auto result = IsMin ? scalar::min(out, 4) : scalar::max(out, 4);
+            if (i < size) {
+                auto rest = IsMin ? scalar::min(data + i, size - i) : scalar::max(data + i, size - i);
+                result = IsMin ? std::min(result, rest) : std::max(result, rest);
+            }
+            return result;
+        }
+
+        __attribute__((target("avx2")))
+        std::optional<std::int64_t> dot(const std::int64_t *left, const std::int64_t *right, std::size_t size) {
+            // as in sse2::dot, operands outside [-2^31, 2^31) take the scalar path
+            auto bias = _mm256_set1_epi64x(std::int64_t{1} << 31);
+            auto range = _mm256_setzero_si256();
+            auto acc = _mm256_setzero_si256();
+            auto overflow = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                auto a = load(left + i);
+                auto b = load(right + i);
+                range = _mm256_or_si256(range, _mm256_or_si256(_mm256_add_epi64(a, bias), _mm256_add_epi64(b, bias)));
+                auto product = mul64(a, b);
+                auto next = _mm256_add_epi64(acc, product);
+                overflow = _mm256_or_si256(overflow, addOverflow(acc, product, next));
+                acc = next;
+            }
+            auto high = _mm256_srli_epi64(range, 32);
+            if (!_mm256_testz_si256(high, high)) {
+                return scalar::dot(left, right, size);
+            }
+            if (anyOverflow(overflow)) {
+                return std::nullopt;
+            }
+            std::int64_t out[4];
+            lanes(acc, out);
+            return scalar::addLanes(out, 4, scalar::dot(left + i, right + i, size - i));
+        }
+
+        __attribute__((target("avx2")))
+        bool addScalar(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+            auto v = _mm256_set1_epi64x(value);
+            auto overflow = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                auto x = load(data + i);
+                auto sum = _mm256_add_epi64(x, v);
+                overflow = _mm256_or_si256(overflow, addOverflow(x, v, sum));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), sum);
+            }
+            auto rest = scalar::addScalar(data + i, size - i, value, out + i);
+            return rest && !anyOverflow(overflow);
+        }
+
+        // 32-bit lane permutation moving the selected 64-bit lanes of a 4 bits mask to the front
+        constexpr std::array<std::array<int, 8>, 16> compressTable() {
+            std::array<std::array<int, 8>, 16> table{};
+            for (int mask = 0; mask < 16; mask++) {
+                int next = 0;
+                for (int lane = 0; lane < 4; lane++) {
+                    if (mask & (1 << lane)) {
+                        table[mask][next * 2] = lane * 2;
+                        table[mask][next * 2 + 1] = lane * 2 + 1;
+                        next++;
+                    }
+                }
+            }
+            return table;
+        }
+
+        constexpr auto COMPRESS_TABLE = compressTable();
+
+        __attribute__((target("avx2")))
+        void sqrt(const double *data, std::size_t size, double *out) {
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(data + i)));
+            }
+            scalar::sqrt(data + i, size - i, out + i);
+        }
+
+        __attribute__((target("avx2")))
+        void floor(const double *data, std::size_t size, double *out) {
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(out + i, _mm256_floor_pd(_mm256_loadu_pd(data + i)));
+            }
+            scalar::floor(data + i, size - i, out + i);
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t filterGreater(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+            auto v = _mm256_set1_epi64x(value);
+            std::size_t count = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                auto x = load(data + i);
+                auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, v)));
+                auto permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(COMPRESS_TABLE[mask].data()));
+                std::int64_t packed[4];
+                lanes(_mm256_permutevar8x32_epi32(x, permutation), packed);
+                auto selected = std::size_t(__builtin_popcount(mask));
+                std::memcpy(out + count, packed, selected * sizeof(std::int64_t));
+                count += selected;
+            }
+            return count + scalar::filterGreater(data + i, size - i, value, out + count);
+        }
+
+        __attribute__((target("avx2")))
+        std::size_t find(const char *haystack, std::size_t haystackSize, const char *needle, std::size_t needleSize) {
+            if (needleSize < 2 || needleSize > haystackSize) {
+                return needleSize == 1 ? findByte(haystack, haystackSize, needle[0])
+                                       : scalar::find(haystack, haystackSize, needle, needleSize);
+            }
+            auto first = _mm256_set1_epi8(needle[0]);
+            auto last = _mm256_set1_epi8(needle[needleSize - 1]);
+            std::size_t i = 0;
+            for (; i + needleSize - 1 + 32 <= haystackSize; i += 32) {
+                auto blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+                auto blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + needleSize - 1));
+                auto mask = unsigned(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first),
+                                                                           _mm256_cmpeq_epi8(blockLast, last))));
+                for (; mask != 0; mask &= mask - 1) {
+                    auto candidate = i + std::size_t(__builtin_ctz(mask));
+                    if (std::memcmp(haystack + candidate + 1, needle + 1, needleSize - 2) == 0) {
+                        return candidate;
+                    }
+                }
+            }
+            return i + scalar::find(haystack + i, haystackSize - i, needle, needleSize);
+        }
+
+        // same classes as the sse2 ones
+        __attribute__((target("avx2")))
+        inline __m256i between(__m256i block, char low, char high) {
+            return _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8(char(low - 1))),
+                                    _mm256_cmpgt_epi8(_mm256_set1_epi8(char(high + 1)), block));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i whitespace(__m256i block) {
+            return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')),
+                                                   _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\t'))),
+                                   _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n')),
+                                                   _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\r'))));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i letter(__m256i block) {
+            return _mm256_or_si256(between(_mm256_or_si256(block, _mm256_set1_epi8(0x20)), 'a', 'z'),
+                                   _mm256_cmpeq_epi8(block, _mm256_set1_epi8('_')));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i digit(__m256i block) {
+            return between(block, '0', '9');
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i notStringEnd(__m256i block) {
+            auto end = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('"')),
+                                                       _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))),
+                                       _mm256_cmpeq_epi8(block, _mm256_setzero_si256()));
+            return _mm256_xor_si256(end, _mm256_set1_epi8(-1));
+        }
+
+        // the last partial block goes through the sse2 version
+        template<__m256i (*InRun)(__m256i), std::size_t (*Tail)(const char *, std::size_t)>
+        __attribute__((target("avx2")))
+        std::size_t run(const char *data, std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                auto outside = ~unsigned(_mm256_movemask_epi8(InRun(block)));
+                if (outside != 0) {
+                    return i + std::size_t(__builtin_ctz(outside));
+                }
+            }
+            return i + Tail(data + i, size - i);
+        }
+    }
+#endif
+
+    struct Kernels {
+        std::optional<std::int64_t> (*sum)(const std::int64_t *, std::size_t);
+
+        std::int64_t (*min)(const std::int64_t *, std::size_t);
+
+        std::int64_t (*max)(const std::int64_t *, std::size_t);
+
+        std::optional<std::int64_t> (*dot)(const std::int64_t *, const std::int64_t *, std::size_t);
+
+        bool (*addScalar)(const std::int64_t *, std::size_t, std::int64_t, std::int64_t *);
+
+        std::size_t (*filterGreater)(const std::int64_t *, std::size_t, std::int64_t, std::int64_t *);
+
+        void (*sqrt)(const double *, std::size_t, double *);
+
+        void (*floor)(const double *, std::size_t, double *);
+
+        std::size_t (*find)(const char *, std::size_t, const char *, std::size_t);
+
+        std::size_t (*whitespaceRun)(const char *, std::size_t);
+
+        std::size_t (*letterRun)(const char *, std::size_t);
+
+        std::size_t (*digitRun)(const char *, std::size_t);
+
+        std::size_t (*stringRun)(const char *, std::size_t);
+
+        const char *name;
+    };
+
+    Kernels selectKernels() {
+#ifdef GI_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {avx2::sum, avx2::extreme<true>, avx2::extreme<false>, avx2::dot, avx2::addScalar,
+                    avx2::filterGreater, avx2::sqrt, avx2::floor, avx2::find,
+                    avx2::run<avx2::whitespace, sse2::run<sse2::whitespace, scalar::whitespaceRun>>,
+                    avx2::run<avx2::letter, sse2::run<sse2::letter, scalar::letterRun>>,
+                    avx2::run<avx2::digit, sse2::run<sse2::digit, scalar::digitRun>>,
+                    avx2::run<avx2::notStringEnd, sse2::run<sse2::notStringEnd, scalar::stringRun>>, "avx2"};
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return {sse2::sum, scalar::min, scalar::max, sse2::dot, sse2::addScalar, scalar::filterGreater, sse2::sqrt,
+                    scalar::floor, sse2::find, sse2::run<sse2::whitespace, scalar::whitespaceRun>,
+                    sse2::run<sse2::letter, scalar::letterRun>, sse2::run<sse2::digit, scalar::digitRun>,
+                    sse2::run<sse2::notStringEnd, scalar::stringRun>, "sse2"};
+        }
+#endif
+        return {scalar::sum, scalar::min, scalar::max, scalar::dot, scalar::addScalar, scalar::filterGreater,
+                scalar::sqrt, scalar::floor, scalar::find, scalar::whitespaceRun, scalar::letterRun, scalar::digitRun,
+                scalar::stringRun, "scalar"};
+    }
+
+    const Kernels &kernels() {
+        static const Kernels selected = selectKernels();
+        return selected;
+    }
+
+    std::optional<std::int64_t> sum(const std::int64_t *data, std::size_t size) {
+        return kernels().sum(data, size);
+    }
+
+    std::int64_t min(const std::int64_t *data, std::size_t size) {
+        return kernels().min(data, size);
+    }
+
+    std::int64_t max(const std::int64_t *data, std::size_t size) {
+        return kernels().max(data, size);
+    }
+
+    std::optional<std::int64_t> dot(const std::int64_t *left, const std::int64_t *right, std::size_t size) {
+        return kernels().dot(left, right, size);
+    }
+
+    bool addScalar(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+        return kernels().addScalar(data, size, value, out);
+    }
+
+    std::size_t filterGreater(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out) {
+        return kernels().filterGreater(data, size, value, out);
+    }
+
+    void sqrt(const double *data, std::size_t size, double *out) {
+        kernels().sqrt(data, size, out);
+    }
+
+    void floor(const double *data, std::size_t size, double *out) {
+        kernels().floor(data, size, out);
+    }
+
+    std::size_t find(const char *haystack, std::size_t haystackSize, const char *needle, std::size_t needleSize) {
+        return kernels().find(haystack, haystackSize, needle, needleSize);
+    }
+
+    std::size_t whitespaceRun(const char *data, std::size_t size) {
+        return kernels().whitespaceRun(data, size);
+    }
+
+    std::size_t letterRun(const char *data, std::size_t size) {
+        return kernels().letterRun(data, size);
+    }
+
+    std::size_t digitRun(const char *data, std::size_t size) {
+        return kernels().digitRun(data, size);
+    }
+
+    std::size_t stringRun(const char *data, std::size_t size) {
+        return kernels().stringRun(data, size);
+    }
+
+    const char *instructionSet() {
+        return kernels().name;
+    }
+}
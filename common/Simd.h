@@ -0,0 +1,64 @@
+//
+// Created by seeu on 2022/8/28.
+//
+
+#ifndef GOINTERPRETER_SIMD_H
+#define GOINTERPRETER_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Vectorized kernels over contiguous buffers. Every kernel has a scalar fallback, on x86-64 the
+// AVX2 (or SSE2) version is picked once at startup from the cpu features.
+namespace Common::Simd {
+
+    // nullopt when an intermediate sum overflowed, the exact sum may still fit into an int64
+    std::optional<std::int64_t> sum(const std::int64_t *data, std::size_t size);
+
+    // `size` must be greater than zero
+    std::int64_t min(const std::int64_t *data, std::size_t size);
+
+    // `size` must be greater than zero
+    std::int64_t max(const std::int64_t *data, std::size_t size);
+
+    // nullopt when a product or an intermediate sum overflowed, like `sum`
+    std::optional<std::int64_t> dot(const std::int64_t *left, const std::int64_t *right, std::size_t size);
+
+    // out[i] = data[i] + value, false when a sum overflowed, out then holds the wrapped values
+    bool addScalar(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out);
+
+    // copy elements greater than `value` to out, returns the number of copied elements
+    std::size_t filterGreater(const std::int64_t *data, std::size_t size, std::int64_t value, std::int64_t *out);
+
+    // out[i] = sqrt(data[i])
+    void sqrt(const double *data, std::size_t size, double *out);
+
+    // out[i] = floor(data[i])
+    void floor(const double *data, std::size_t size, double *out);
+
+    // position of the first occurrence of needle in haystack, haystackSize when there is none. Candidates
+    // are filtered on their first and last byte a whole vector at a time.
+    std::size_t find(const char *haystack, std::size_t haystackSize, const char *needle, std::size_t needleSize);
+
+    // Lexer scanning, each returns the length of the run at the start of data, `size` when the run reaches
+    // the end. Sixteen or thirty-two bytes are classified at a time.
+
+    // ' ', '\t', '\n' and '\r'
+    std::size_t whitespaceRun(const char *data, std::size_t size);
+
+    // identifier letters, 'a' to 'z', 'A' to 'Z' and '_'
+    std::size_t letterRun(const char *data, std::size_t size);
+
+    // '0' to '9'
+    std::size_t digitRun(const char *data, std::size_t size);
+
+    // string literal contents, everything up to a '"', a line break or a NUL byte. The lexer counts the line
+    // breaks inside strings between runs.
+    std::size_t stringRun(const char *data, std::size_t size);
+
+    // name of the selected instruction set, "avx2", "sse2" or "scalar"
+    const char *instructionSet();
+}
+
+#endif //GOINTERPRETER_SIMD_H
@@ -0,0 +1,26 @@
+//
+// Created by seeu on 2022/9/6.
+//
+
+#include "Symbol.h"
+#include "Builtin.h"
+
+namespace Common {
+
+    SymbolInterner::SymbolInterner() {
+        for (auto &builtin: builtinDefinitions()) {
+            intern(builtin.name);
+        }
+    }
+
+    SymbolId SymbolInterner::intern(std::string_view name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        auto &stored = names.emplace_back(name);
+        auto symbol = SymbolId(names.size() - 1);
+        ids.emplace(stored, symbol);
+        return symbol;
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by seeu on 2022/9/6.
+//
+
+#ifndef GOINTERPRETER_SYMBOL_H
+#define GOINTERPRETER_SYMBOL_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Common {
+
+    // dense id of an interned identifier
+    using SymbolId = std::uint32_t;
+
+    // Identifiers are interned by the lexer. Every program gets a table of its own unless its lexer is given
+    // one: a REPL session passes the same table to the lexer of every line, its environments and function
+    // objects outlive the program that created them and keep using its ids. The builtin names are interned
+    // first, so the id of a builtin's name is its index in the builtin table. A table is not synchronized, it
+    // is used by one parser at a time.
+    class SymbolInterner {
+    public:
+        SymbolInterner();
+
+        SymbolId intern(std::string_view name);
+
+        // name of an interned symbol, valid for the lifetime of the table
+        std::string_view name(SymbolId symbol) const { return names[symbol]; }
+
+        // number of interned symbols, every id is below it
+        std::size_t size() const { return names.size(); }
+
+    private:
+        // deque elements never move, the keys of `ids` point into them
+        std::deque<std::string> names;
+        std::unordered_map<std::string_view, SymbolId> ids;
+    };
+
+    using Symbols = std::shared_ptr<SymbolInterner>;
+}
+
+#endif //GOINTERPRETER_SYMBOL_H
@@ -0,0 +1,71 @@
+//
+// Created by seeu on 2022/9/4.
+//
+
+#include "ThreadPool.h"
+
+namespace Common {
+
+    ThreadPool::ThreadPool(std::size_t workers) {
+        for (std::size_t index = 0; index < workers; index++) {
+            threads.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock{mutex};
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool &ThreadPool::shared() {
+        static ThreadPool pool{std::max(std::thread::hardware_concurrency(), 1u) - 1};
+        return pool;
+    }
+
+    void ThreadPool::runAll(std::vector<std::function<void()>> tasks) {
+        Batch batch{tasks.size()};
+        std::unique_lock lock{mutex};
+        for (auto &task: tasks) {
+            queue.push_back({std::move(task), &batch});
+        }
+        available.notify_all();
+        while (batch.pending != 0) {
+            // help with queued tasks, possibly of other batches, before going to sleep
+            if (!runOne(lock)) {
+                available.wait(lock, [this, &batch] { return batch.pending == 0 || !queue.empty(); });
+            }
+        }
+    }
+
+    void ThreadPool::work() {
+        std::unique_lock lock{mutex};
+        while (true) {
+            available.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            runOne(lock);
+        }
+    }
+
+    bool ThreadPool::runOne(std::unique_lock<std::mutex> &lock) {
+        if (queue.empty()) {
+            return false;
+        }
+        auto task = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        task.function();
+        lock.lock();
+        if (--task.batch->pending == 0) {
+            available.notify_all();
+        }
+        return true;
+    }
+}
@@ -0,0 +1,108 @@
+//
+// Created by seeu on 2022/9/4.
+//
+
+#ifndef GOINTERPRETER_THREADPOOL_H
+#define GOINTERPRETER_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+    // below this many elements sorting is not worth splitting across threads
+    constexpr std::size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+
+    // Fixed set of worker threads. The thread calling `runAll` works on the tasks as well, so a pool of
+    // size n runs n + 1 tasks at a time and nested `runAll` calls can't starve.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(std::size_t workers);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // pool used by the builtins, one worker per additional hardware thread
+        static ThreadPool &shared();
+
+        // number of tasks that run at the same time
+        std::size_t concurrency() const { return threads.size() + 1; }
+
+        // runs all tasks and returns once every one of them finished
+        void runAll(std::vector<std::function<void()>> tasks);
+
+    private:
+        struct Batch {
+            std::size_t pending;
+        };
+
+        struct Task {
+            std::function<void()> function;
+            Batch *batch;
+        };
+
+        void work();
+
+        // pops and runs one task, false when the queue was empty. `lock` holds `mutex`.
+        bool runOne(std::unique_lock<std::mutex> &lock);
+
+        std::vector<std::thread> threads;
+        std::deque<Task> queue;
+        std::mutex mutex;
+        // signalled when tasks are queued and when a batch finished
+        std::condition_variable available;
+        bool stopping{false};
+    };
+
+    // Sorts chunks on the pool, then merges neighbouring chunks pairwise, every merge round in parallel.
+    // `less` must be a strict weak ordering that is safe to call from several threads.
+    template<typename T, typename Less>
+    void parallelSort(std::vector<T> &values, Less less, ThreadPool &pool = ThreadPool::shared()) {
+        auto chunks = std::min(pool.concurrency(), values.size() / (PARALLEL_SORT_THRESHOLD / 2));
+        if (values.size() < PARALLEL_SORT_THRESHOLD || chunks < 2) {
+            std::sort(values.begin(), values.end(), less);
+            return;
+        }
+
+        std::vector<std::size_t> bounds;
+        for (std::size_t chunk = 0; chunk <= chunks; chunk++) {
+            bounds.push_back(values.size() * chunk / chunks);
+        }
+        auto begin = values.begin();
+        std::vector<std::function<void()>> tasks;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            tasks.emplace_back([=, &less] {
+                std::sort(begin + long(bounds[chunk]), begin + long(bounds[chunk + 1]), less);
+            });
+        }
+        pool.runAll(std::move(tasks));
+
+        while (bounds.size() > 2) {
+            std::vector<std::size_t> merged;
+            tasks.clear();
+            for (std::size_t index = 0; index + 1 < bounds.size(); index += 2) {
+                merged.push_back(bounds[index]);
+                if (index + 2 < bounds.size()) {
+                    tasks.emplace_back([=, &less] {
+                        std::inplace_merge(begin + long(bounds[index]), begin + long(bounds[index + 1]),
+                                           begin + long(bounds[index + 2]), less);
+                    });
+                }
+            }
+            merged.push_back(bounds.back());
+            pool.runAll(std::move(tasks));
+            bounds = std::move(merged);
+        }
+    }
+}
+
+#endif //GOINTERPRETER_THREADPOOL_H
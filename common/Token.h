@@ -5,9 +5,15 @@
 #ifndef GOINTERPRETER_TOKEN_H
 #define GOINTERPRETER_TOKEN_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <map>
 #include <utility>
+#include "Symbol.h"
 
 
 namespace Common {
@@ -18,21 +24,29 @@ namespace Common {
 
         IDENTIFIER,
         INT,
+        FLOAT,
         STRING,
 
         ASSIGN,
+        ARROW,
         PLUS,
         MINUS,
         BANG,
         ASTERISK,
         SLASH,
+        PERCENT,
 
         LT,
         GT,
+        LT_EQ,
+        GT_EQ,
 
         EQ,
         NOT_EQ,
 
+        AND,
+        OR,
+
         COMMA,
         SEMICOLON,
         COLON,
@@ -51,16 +65,90 @@ namespace Common {
         IF,
         ELSE,
         RETURN,
+        WHILE,
+        FOR,
+        IN,
+        // last type, TOKEN_TYPE_COUNT depends on it
+        MATCH,
     };
 
+    constexpr std::size_t TOKEN_TYPE_COUNT = static_cast<std::size_t>(TokenType::MATCH) -
+                                             static_cast<std::size_t>(TokenType::START) + 1;
+
+    // position of `type` in tables indexed by token type
+    constexpr std::size_t tokenTypeIndex(TokenType type) {
+        return static_cast<std::size_t>(static_cast<int>(type) - static_cast<int>(TokenType::START));
+    }
+
+    // Text of one compilation unit. Token literals are views into it, so whatever keeps tokens or AST nodes
+    // around (the program, function objects) keeps the source alive as well.
+    using Source = std::shared_ptr<const std::string>;
+
     class Token {
     public:
         TokenType type;
-        std::string literal;
+        // 1-based position of the first character, 0 on tokens not made by a lexer. The position fields fill
+        // the padding around `literal`, a token stays at 32 bytes.
+        std::uint32_t line{0};
+        std::string_view literal;
+        // interned name, only set on IDENTIFIER tokens
+        SymbolId symbol;
+        std::uint32_t column{0};
+
+        Token(TokenType type, std::string_view literal, SymbolId symbol = 0) :
+                type{type}, literal{literal}, symbol{symbol} {}
+    };
+
+    struct Keyword {
+        std::string_view word;
+        TokenType type{TokenType::IDENTIFIER};
+    };
 
-        Token(TokenType type, std::string literal) : type{type}, literal{std::move(literal)} {}
+    constexpr std::array KEYWORDS{
+            Keyword{"fn", TokenType::FUNCTION},
+            Keyword{"let", TokenType::LET},
+            Keyword{"true", TokenType::TRUE},
+            Keyword{"false", TokenType::FALSE},
+            Keyword{"if", TokenType::IF},
+            Keyword{"else", TokenType::ELSE},
+            Keyword{"return", TokenType::RETURN},
+            Keyword{"while", TokenType::WHILE},
+            Keyword{"for", TokenType::FOR},
+            Keyword{"in", TokenType::IN},
+            Keyword{"match", TokenType::MATCH},
     };
 
+    constexpr std::size_t KEYWORD_SLOTS = 32;
+
+    // perfect hash over KEYWORDS, the static_assert below fails when a new keyword collides
+    constexpr std::size_t keywordSlot(std::string_view word) {
+        return (word.size() + static_cast<unsigned char>(word.front()) + static_cast<unsigned char>(word.back())) %
+               KEYWORD_SLOTS;
+    }
+
+    constexpr auto KEYWORD_TABLE = [] {
+        std::array<Keyword, KEYWORD_SLOTS> table{};
+        for (auto keyword: KEYWORDS) {
+            table[keywordSlot(keyword.word)] = keyword;
+        }
+        return table;
+    }();
+
+    static_assert([] {
+        for (auto keyword: KEYWORDS) {
+            if (KEYWORD_TABLE[keywordSlot(keyword.word)].word != keyword.word) {
+                return false;
+            }
+        }
+        return true;
+    }(), "keywords collide in KEYWORD_TABLE, change keywordSlot or KEYWORD_SLOTS");
+
+    // keyword type of `word`, IDENTIFIER when it is not a keyword. `word` must not be empty.
+    constexpr TokenType lookupIdentifier(std::string_view word) {
+        auto &slot = KEYWORD_TABLE[keywordSlot(word)];
+        return slot.word == word ? slot.type : TokenType::IDENTIFIER;
+    }
+
 
 }
 
@@ -3,6 +3,7 @@
 //
 
 #include "Code.h"
+#include <algorithm>
 #include <cstddef>
 #include <sstream>
 #include <string>
@@ -10,6 +11,22 @@
 #include "fmt/core.h"
 
 namespace GC {
+    void LineTable::add(int ip, std::uint32_t line) {
+        while (!runs.empty() && runs.back().ip >= ip) {
+            runs.pop_back();
+        }
+        if (runs.empty() || runs.back().line != line) {
+            runs.push_back({ip, line});
+        }
+    }
+
+    std::uint32_t LineTable::lineAt(int ip) const {
+        auto run = std::upper_bound(runs.begin(), runs.end(), ip, [](int ip, const Run &run) {
+            return ip < run.ip;
+        });
+        return run == runs.begin() ? 0 : std::prev(run)->line;
+    }
+
     string formatInstruction(Definition *definition, vector<int> operands) {
         stringstream ss;
         ss << definition->name;
@@ -9,6 +9,7 @@
 #include <string>
 #include <map>
 #include <cstddef>
+#include <cstdint>
 #include <numeric>
 
 #define OP_DEF(name) definitions.emplace(GC::OpCode::name, GC::Definition{ \
@@ -25,6 +26,23 @@ namespace GC {
 
     using Instruction = std::vector<byte>;
 
+    // Run-length encoded map from instruction offsets to source lines, one run per change of line. Filled by
+    // the compiler as it emits, the dispatch loop never reads it.
+    struct LineTable {
+        struct Run {
+            int ip;
+            std::uint32_t line;
+        };
+
+        // the instructions from `ip` on come from `line`, runs at or after `ip` were removed by the compiler
+        void add(int ip, std::uint32_t line);
+
+        // line of the instruction at `ip`, 0 when unknown
+        std::uint32_t lineAt(int ip) const;
+
+        std::vector<Run> runs;
+    };
+
     enum class OpCode : std::underlying_type_t<std::byte> {
         Constant = 0,
         Add,
@@ -55,7 +73,35 @@ namespace GC {
         GetBuiltin,
         Closure,
         GetFree,
-        CurrentClosure
+        CurrentClosure,
+        SetIndex,
+        // operands are known to be floats at compile time
+        AddFloat,
+        SubFloat,
+        MulFloat,
+        DivFloat,
+        // replaces the iterable on top of the stack with an iterator
+        IterInit,
+        // pushes the next element of the iterator below it, or pops the iterator and jumps once it is exhausted
+        IterNext,
+        Mod,
+        GreaterEqual,
+        LessThan,
+        LessEqual,
+        // a comparison feeding a conditional jump, pops both operands and jumps when the comparison is false
+        JumpIfNotEqual,
+        JumpIfEqual,
+        JumpIfNotGreater,
+        JumpIfNotGreaterEqual,
+        JumpIfNotLess,
+        JumpIfNotLessEqual,
+        // pop the match subject and jump to the arm found in the match table constant
+        JumpTable,
+        JumpHashTable,
+        // push a variable and clear it, an index assignment takes its root so the root isn't shared with the
+        // variable while it is updated. The store right after puts it back.
+        TakeGlobal,
+        TakeLocal
     };
 
 
@@ -97,11 +143,34 @@ namespace GC {
             OP_DEF_SIZE(Closure, 2, 1);
             OP_DEF_SIZE(GetFree, 1);
             OP_DEF(CurrentClosure);
+            OP_DEF_SIZE(SetIndex, 1);
+            OP_DEF(AddFloat);
+            OP_DEF(SubFloat);
+            OP_DEF(MulFloat);
+            OP_DEF(DivFloat);
+            OP_DEF(IterInit);
+            OP_DEF_SIZE(IterNext, 2);
+            OP_DEF(Mod);
+            OP_DEF(GreaterEqual);
+            OP_DEF(LessThan);
+            OP_DEF(LessEqual);
+            OP_DEF_SIZE(JumpIfNotEqual, 2);
+            OP_DEF_SIZE(JumpIfEqual, 2);
+            OP_DEF_SIZE(JumpIfNotGreater, 2);
+            OP_DEF_SIZE(JumpIfNotGreaterEqual, 2);
+            OP_DEF_SIZE(JumpIfNotLess, 2);
+            OP_DEF_SIZE(JumpIfNotLessEqual, 2);
+            OP_DEF_SIZE(JumpTable, 2);
+            OP_DEF_SIZE(JumpHashTable, 2);
+            OP_DEF_SIZE(TakeGlobal, 2);
+            OP_DEF_SIZE(TakeLocal, 1);
 
         }
 
         int readSingleInstruction(OpCode code, const Instruction &instruction, int index) {
-            return readInstructions(code, instruction, index)[0];
+            // hot path of the vm, read the operand without collecting it into a vector
+            return definitions[code].operandWidths[0] == 2 ? readUint16(instruction, index)
+                                                           : readUint8(instruction, index);
         }
 
         vector<int> readInstructions(OpCode code, const Instruction &instruction, int index) {
@@ -119,17 +188,17 @@ namespace GC {
         }
 
         int getOperandsSize(OpCode code) {
-            auto definition = definitions[code];
+            auto &definition = definitions[code];
             return std::accumulate(definition.operandWidths.begin(), definition.operandWidths.end(), 0);
         }
 
-        static int readUint16(Instruction instruction, int offset = 0) {
+        static int readUint16(const Instruction &instruction, int offset = 0) {
             int op = to_integer<int>(instruction[offset]) << 8;
             op = op | to_integer<int>(instruction[offset + 1]);
             return op;
         }
 
-        static int readUint8(Instruction instruction, int offset = 0) {
+        static int readUint8(const Instruction &instruction, int offset = 0) {
             int op = to_integer<int>(instruction[offset]);
             return op;
         }
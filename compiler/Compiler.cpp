@@ -10,20 +10,98 @@
 #include "CompilerObject.h"
 
 #include <algorithm>
+#include <optional>
 #include <utility>
 
 #define DUMB_INSTRUCTION_ADDRESS 9999
 
 namespace GC {
 
+    static std::optional<OpCode> infixOpCode(Common::InfixOperator op) {
+        switch (op) {
+            case Common::InfixOperator::Add:
+                return OpCode::Add;
+            case Common::InfixOperator::Sub:
+                return OpCode::Sub;
+            case Common::InfixOperator::Mul:
+                return OpCode::Mul;
+            case Common::InfixOperator::Div:
+                return OpCode::Div;
+            case Common::InfixOperator::Mod:
+                return OpCode::Mod;
+            case Common::InfixOperator::Equal:
+                return OpCode::Equal;
+            case Common::InfixOperator::NotEqual:
+                return OpCode::NotEqual;
+            case Common::InfixOperator::Greater:
+                return OpCode::GreaterThan;
+            case Common::InfixOperator::GreaterEqual:
+                return OpCode::GreaterEqual;
+            case Common::InfixOperator::Less:
+                return OpCode::LessThan;
+            case Common::InfixOperator::LessEqual:
+                return OpCode::LessEqual;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    static std::optional<OpCode> floatOpCode(Common::InfixOperator op) {
+        switch (op) {
+            case Common::InfixOperator::Add:
+                return OpCode::AddFloat;
+            case Common::InfixOperator::Sub:
+                return OpCode::SubFloat;
+            case Common::InfixOperator::Mul:
+                return OpCode::MulFloat;
+            case Common::InfixOperator::Div:
+                return OpCode::DivFloat;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    // jump taken when the comparison does not hold
+    static std::optional<OpCode> comparisonJump(Common::InfixOperator op) {
+        switch (op) {
+            case Common::InfixOperator::Equal:
+                return OpCode::JumpIfNotEqual;
+            case Common::InfixOperator::NotEqual:
+                return OpCode::JumpIfEqual;
+            case Common::InfixOperator::Greater:
+                return OpCode::JumpIfNotGreater;
+            case Common::InfixOperator::GreaterEqual:
+                return OpCode::JumpIfNotGreaterEqual;
+            case Common::InfixOperator::Less:
+                return OpCode::JumpIfNotLess;
+            case Common::InfixOperator::LessEqual:
+                return OpCode::JumpIfNotLessEqual;
+            default:
+                return std::nullopt;
+        }
+    }
+
     void Compiler::compile(Common::Node *node) {
+        // the instructions of a node are attributed to its line, the instructions emitted after its children
+        // as well
+        auto outerLine = line;
+        if (node->getLine() != 0) {
+            line = std::uint32_t(std::int32_t(node->getLine()) + lineShift);
+        }
+        compileNode(node);
+        line = outerLine;
+    }
+
+    void Compiler::compileNode(Common::Node *node) {
         switch (node->getType()) {
             case Common::NodeType::Program: {
                 auto program = static_cast<Common::Program *>(node);
 
-                for (auto &stmt: program->statements) {
-                    compile(stmt.get());
+                for (std::size_t index = 0; index < program->statements.size(); index++) {
+                    lineShift = index < program->origins.size() ? program->origins[index].lineShift : 0;
+                    compile(program->statements[index].get());
                 }
+                lineShift = 0;
                 break;
             }
             case Common::NodeType::ExpressionStatement: {
@@ -33,50 +111,67 @@ namespace GC {
             }
             case Common::NodeType::InfixExpression: {
                 auto expr = static_cast<Common::InfixExpression *>(node);
-                if (expr->infixOperator == "<") {
-                    compile(expr->rightExpression.get());
-                    compile(expr->leftExpression.get());
-                    emit(OpCode::GreaterThan);
-                    return;
+                if (expr->infixOperator == Common::InfixOperator::And ||
+                    expr->infixOperator == Common::InfixOperator::Or) {
+                    // compiled as a condition, the branches push the boolean
+                    auto falseJumps = compileCondition(expr);
+                    emit(OpCode::True);
+                    auto endJumpPos = emit(OpCode::Jump, {DUMB_INSTRUCTION_ADDRESS});
+                    patchJumps(falseJumps);
+                    emit(OpCode::False);
+                    changeOperand(endJumpPos, {int(instructions()->size())});
+                    break;
                 }
 
                 compile(expr->leftExpression.get());
                 compile(expr->rightExpression.get());
 
-                std::map<string, OpCode> infixActions{
-                        {"+",  OpCode::Add},
-                        {"-",  OpCode::Sub},
-                        {"*",  OpCode::Mul},
-                        {"/",  OpCode::Div},
-                        {"==", OpCode::Equal},
-                        {"!=", OpCode::NotEqual},
-                        {">",  OpCode::GreaterThan},
-                };
-                if (!infixActions.contains(expr->infixOperator)) {
-                    throw "unsupported operator: " + expr->infixOperator;
-                }
-                emit(infixActions[expr->infixOperator]);
+                if (staticType(expr->leftExpression.get()) == StaticType::Float &&
+                    staticType(expr->rightExpression.get()) == StaticType::Float) {
+                    if (auto action = floatOpCode(expr->infixOperator)) {
+                        emit(*action);
+                        break;
+                    }
+                }
+
+                auto action = infixOpCode(expr->infixOperator);
+                if (!action.has_value()) {
+                    throw fmt::format("unsupported operator: {}", operatorSymbol(expr->infixOperator));
+                }
+                emit(*action);
                 break;
             }
             case Common::NodeType::PrefixExpression: {
                 auto prefixExpr = static_cast<Common::PrefixExpression *>(node);
                 compile(prefixExpr->rightExpression.get());
-                if (prefixExpr->prefixOperator == "!") {
-                    emit(OpCode::Bang);
-                } else if (prefixExpr->prefixOperator == "-") {
-                    emit(OpCode::Minus);
-                } else {
-                    throw "unsupported operator: " + prefixExpr->prefixOperator;
+                switch (prefixExpr->prefixOperator) {
+                    case Common::PrefixOperator::Bang:
+                        emit(OpCode::Bang);
+                        break;
+                    case Common::PrefixOperator::Minus:
+                        emit(OpCode::Minus);
+                        break;
                 }
                 break;
             }
             case Common::NodeType::IntegerExpression: {
                 auto integerExpr = static_cast<Common::IntegerExpression *>(node);
+                if (integerExpr->bigValue.has_value()) {
+                    emit(OpCode::Constant, {addConstant(make_shared<Common::BigIntObject>(*integerExpr->bigValue))});
+                    break;
+                }
                 emit(OpCode::Constant, {
                         addConstant(make_unique<Common::IntegerObject>(integerExpr->value))
                 });
                 break;
             }
+            case Common::NodeType::FloatExpression: {
+                auto floatExpr = static_cast<Common::FloatExpression *>(node);
+                emit(OpCode::Constant, {
+                        addConstant(make_unique<Common::FloatObject>(floatExpr->value))
+                });
+                break;
+            }
             case Common::NodeType::BoolExpression: {
                 auto boolExpr = static_cast<Common::BoolExpression *>(node);
                 emit(boolExpr->value ? OpCode::True : OpCode::False);
@@ -84,36 +179,89 @@ namespace GC {
             }
             case Common::NodeType::IfExpression: {
                 auto ifExpr = static_cast<Common::IfExpression *>(node);
-                compile(ifExpr->condition.get());
-
-                auto jumpNotTruthyPos = emit(OpCode::JumpNotTruthy, {DUMB_INSTRUCTION_ADDRESS});
+                auto falseJumps = compileCondition(ifExpr->condition.get());
 
                 compile(ifExpr->consequence.get());
-
-                if (lastInstruction().code == OpCode::Pop) {
-                    // remove last pop code
-                    scopes[scopeIndex].instructions.pop_back();
-                }
+                keepBlockValue();
 
                 auto jumpPos = emit(OpCode::Jump, {DUMB_INSTRUCTION_ADDRESS});
-                int afterConsequencePos = currentInstructions().size();
-                changeOperand(jumpNotTruthyPos, {afterConsequencePos});
+                patchJumps(falseJumps);
 
                 if (ifExpr->alternative == nullptr) {
                     emit(OpCode::_Null);
                 } else {
                     compile(ifExpr->alternative.get());
-
-                    if (lastInstruction().code == OpCode::Pop) {
-                        // remove last pop code
-                        scopes[scopeIndex].instructions.pop_back();
-                    }
+                    keepBlockValue();
                 }
 
                 int afterAlternativePos = currentInstructions().size();
                 changeOperand(jumpPos, {afterAlternativePos});
                 break;
             }
+            case Common::NodeType::MatchExpression: {
+                auto matchExpr = static_cast<Common::MatchExpression *>(node);
+                // every pattern value with the index of its arm
+                vector<pair<shared_ptr<Common::GIObject>, int>> keys;
+                for (int arm = 0; arm < int(matchExpr->arms.size()); arm++) {
+                    for (auto &pattern: matchExpr->arms[arm].patterns) {
+                        keys.emplace_back(patternValue(pattern.get()), arm);
+                    }
+                }
+
+                auto table = make_shared<MatchTableObject>();
+                // integer patterns covering at least half of their range are looked up by offset
+                auto dense = !keys.empty() && std::all_of(keys.begin(), keys.end(), [](auto &key) {
+                    return key.first->getType() == Common::ObjectType::INTEGER;
+                });
+                if (dense) {
+                    auto [low, high] = std::minmax_element(keys.begin(), keys.end(), [](auto &left, auto &right) {
+                        return static_cast<Common::IntegerObject *>(left.first.get())->value <
+                               static_cast<Common::IntegerObject *>(right.first.get())->value;
+                    });
+                    table->low = static_cast<Common::IntegerObject *>(low->first.get())->value;
+                    auto range = std::uint64_t(static_cast<Common::IntegerObject *>(high->first.get())->value) -
+                                 std::uint64_t(table->low);
+                    dense = range < 2 * keys.size();
+                    if (dense) {
+                        table->denseTargets.resize(range + 1, -1);
+                    }
+                }
+
+                compile(matchExpr->subject.get());
+                emit(dense ? OpCode::JumpTable : OpCode::JumpHashTable, {addConstant(table)});
+
+                vector<int> armPositions(matchExpr->arms.size());
+                vector<int> endJumps;
+                Common::BlockStatement *defaultBody = nullptr;
+                for (int arm = 0; arm < int(matchExpr->arms.size()); arm++) {
+                    auto &matchArm = matchExpr->arms[arm];
+                    if (matchArm.patterns.empty()) {
+                        defaultBody = defaultBody == nullptr ? matchArm.body.get() : defaultBody;
+                        continue;
+                    }
+                    armPositions[arm] = int(instructions()->size());
+                    compile(matchArm.body.get());
+                    keepBlockValue();
+                    endJumps.push_back(emit(OpCode::Jump, {DUMB_INSTRUCTION_ADDRESS}));
+                }
+                table->defaultTarget = int(instructions()->size());
+                if (defaultBody != nullptr) {
+                    compile(defaultBody);
+                    keepBlockValue();
+                } else {
+                    emit(OpCode::_Null);
+                }
+                patchJumps(endJumps);
+
+                for (auto &[key, arm]: keys) {
+                    if (dense) {
+                        table->addDense(static_cast<Common::IntegerObject *>(key.get())->value, armPositions[arm]);
+                    } else {
+                        table->addHashed(key, armPositions[arm]);
+                    }
+                }
+                break;
+            }
             case Common::NodeType::BlockStatement: {
                 auto blockStmt = static_cast<Common::BlockStatement *>(node);
                 for (auto &stmt: blockStmt->statements) {
@@ -124,7 +272,7 @@ namespace GC {
             }
             case Common::NodeType::LetStatement: {
                 auto letStmt = static_cast<Common::LetStatement *>(node);
-                auto symbol = symbolTableManager.define(letStmt->name->value);
+                auto symbol = symbolTableManager.define(letStmt->name->symbol);
 
                 compile(letStmt->value.get());
                 if (symbol.scope == SymbolScope::Global) {
@@ -134,20 +282,97 @@ namespace GC {
                 }
                 break;
             }
+            case Common::NodeType::AssignStatement: {
+                auto assignStmt = static_cast<Common::AssignStatement *>(node);
+                std::vector<Common::Expression *> indexExprs;
+                auto target = assignStmt->target.get();
+                while (target->getType() == Common::NodeType::IndexExpression) {
+                    auto indexExpr = static_cast<Common::IndexExpression *>(target);
+                    indexExprs.push_back(indexExpr->indexExpression.get());
+                    target = indexExpr->leftExpression.get();
+                }
+                if (target->getType() != Common::NodeType::Identifier) {
+                    throw fmt::format("invalid assignment target {}", target->toString());
+                }
+                auto identifier = static_cast<Common::Identifier *>(target);
+                auto name = identifier->token.literal;
+                auto symbol = symbolTableManager.resolve(identifier->symbol);
+                if (!symbol.has_value()) {
+                    throw fmt::format("undefined variable {}", name);
+                }
+                if (symbol->scope != SymbolScope::Global && symbol->scope != SymbolScope::Local) {
+                    throw fmt::format("cannot assign to {}", name);
+                }
+
+                if (indexExprs.empty()) {
+                    compile(assignStmt->value.get());
+                } else {
+                    // stack: index..., value, root -> SetIndex leaves the updated root for the store. The root is
+                    // taken last, the indices and the value may still read the variable.
+                    std::for_each(indexExprs.rbegin(), indexExprs.rend(), [&](auto indexExpr) {
+                        compile(indexExpr);
+                    });
+                    compile(assignStmt->value.get());
+                    if (symbol->scope == SymbolScope::Global) {
+                        emit(OpCode::TakeGlobal, {symbol->index});
+                    } else {
+                        emit(OpCode::TakeLocal, {symbol->index});
+                    }
+                    emit(OpCode::SetIndex, {int(indexExprs.size())});
+                }
+                if (symbol->scope == SymbolScope::Global) {
+                    emit(OpCode::SetGlobal, {symbol->index});
+                } else {
+                    emit(OpCode::SetLocal, {symbol->index});
+                }
+                break;
+            }
+            case Common::NodeType::WhileStatement: {
+                auto whileStmt = static_cast<Common::WhileStatement *>(node);
+                int loopStartPos = instructions()->size();
+                auto exitJumps = compileCondition(whileStmt->condition.get());
+
+                compile(whileStmt->body.get());
+                emit(OpCode::Jump, {loopStartPos});
+
+                patchJumps(exitJumps);
+                break;
+            }
+            case Common::NodeType::ForStatement: {
+                auto forStmt = static_cast<Common::ForStatement *>(node);
+                // the iterator stays on the stack while the loop runs, the body leaves the stack balanced
+                compile(forStmt->iterable.get());
+                emit(OpCode::IterInit);
+
+                int loopStartPos = instructions()->size();
+                auto exitJumpPos = emit(OpCode::IterNext, {DUMB_INSTRUCTION_ADDRESS});
+                auto symbol = symbolTableManager.define(forStmt->variable->symbol);
+                if (symbol.scope == SymbolScope::Global) {
+                    emit(OpCode::SetGlobal, {symbol.index});
+                } else {
+                    emit(OpCode::SetLocal, {symbol.index});
+                }
+
+                compile(forStmt->body.get());
+                emit(OpCode::Jump, {loopStartPos});
+
+                changeOperand(exitJumpPos, {int(instructions()->size())});
+                break;
+            }
             case Common::NodeType::Identifier: {
                 auto id = static_cast<Common::Identifier *>(node);
-                auto symbol = symbolTableManager.resolve(id->value);
+                auto symbol = symbolTableManager.resolve(id->symbol);
                 if (symbol.has_value()) {
                     loadSymbol(*symbol);
                 } else {
-                    throw fmt::format("undefined variable {}", id->value);
+                    throw fmt::format("undefined variable {}", id->token.literal);
                 }
                 break;
             }
             case Common::NodeType::StringExpression: {
                 auto stringExpr = static_cast<Common::StringExpression *>(node);
                 emit(OpCode::Constant, {
-                        addConstant(make_unique<Common::StringObject>(stringExpr->value))
+                        addConstant(make_unique<Common::StringObject>(std::string{stringExpr->value()}))
                 });
                 break;
             }
@@ -192,13 +417,12 @@ namespace GC {
 
                 enterScope();
 
-                auto name = functionExpr->name;
-                if (!name.empty()) {
-                    symbolTableManager.defineFunctionName(name);
+                if (functionExpr->name.has_value()) {
+                    symbolTableManager.defineFunctionName(*functionExpr->name);
                 }
 
                 for (auto &p: functionExpr->parameters) {
-                    symbolTableManager.define(p->value);
+                    symbolTableManager.define(p->symbol);
                 }
 
                 compile(functionExpr->body.get());
@@ -211,7 +435,7 @@ namespace GC {
 
                 auto freeSymbols = symbolTableManager.symbolTable->freeSymbols;
                 auto numLocals = symbolTableManager.symbolTable->numDefinitions;;
-                auto localInstructions = leaveScope();
+                auto localScope = leaveScope();
 
                 for (auto &s: freeSymbols) {
                     auto symbol = symbolTableManager.resolve(s.name);
@@ -219,9 +443,10 @@ namespace GC {
                 }
 
                 auto fnIndex = addConstant(make_shared<GC::CompiledFunctionObject>(
-                        localInstructions,
+                        localScope.instructions,
                         functionExpr->parameters.size(),
-                        numLocals
+                        numLocals,
+                        std::make_shared<const LineTable>(std::move(localScope.lines))
                 ));
                 emit(OpCode::Closure, {fnIndex, int(freeSymbols.size())});
                 break;
@@ -252,6 +477,7 @@ namespace GC {
     int Compiler::emit(OpCode opCode, vector<int> operands) {
         auto ins = code.makeInstruction(opCode, std::move(operands));
         auto pos = addInstruction(ins);
+        scopes[scopeIndex].lines.add(pos, line);
 
         setLastInstruction(opCode, pos);
 
@@ -299,8 +525,7 @@ namespace GC {
     }
 
     void Compiler::changeOperand(int position, vector<int> operand) {
-        auto currentIns = currentInstructions();
-        auto opCode = OpCode(currentIns[position]);
+        auto opCode = OpCode((*instructions())[position]);
         auto ins = code.makeInstruction(opCode, operand);
 
         for (int i = 0; i < ins.size(); i++) {
@@ -320,19 +545,20 @@ namespace GC {
                 {
                         .instructions =  {},
                         .lastInstruction =  EmittedInstruction{},
-                        .previousInstruction =  EmittedInstruction{}
+                        .previousInstruction =  EmittedInstruction{},
+                        .lines =  {}
                 });
         scopeIndex++;
         symbolTableManager.enterScope();
     }
 
-    Instruction Compiler::leaveScope() {
-        auto instructions = scopes[scopeIndex].instructions;
+    CompilationScope Compiler::leaveScope() {
+        auto scope = std::move(scopes[scopeIndex]);
         scopes.pop_back();
         scopeIndex--;
 
         symbolTableManager.leaveScope();
-        return instructions;
+        return scope;
     }
 
 
@@ -342,6 +568,145 @@ namespace GC {
 
         scopes[scopeIndex].lastInstruction.code = OpCode::ReturnValue;
     }
+
+    shared_ptr<Common::GIObject> Compiler::patternValue(Common::Expression *pattern) {
+        switch (pattern->getType()) {
+            case Common::NodeType::IntegerExpression: {
+                auto integerExpr = static_cast<Common::IntegerExpression *>(pattern);
+                if (integerExpr->bigValue.has_value()) {
+                    return make_shared<Common::BigIntObject>(*integerExpr->bigValue);
+                }
+                return make_shared<Common::IntegerObject>(integerExpr->value);
+            }
+            case Common::NodeType::FloatExpression:
+                return make_shared<Common::FloatObject>(static_cast<Common::FloatExpression *>(pattern)->value);
+            case Common::NodeType::StringExpression:
+                return make_shared<Common::StringObject>(std::string{static_cast<Common::StringExpression *>(pattern)->value()});
+            case Common::NodeType::BoolExpression:
+                return make_shared<Common::BooleanObject>(static_cast<Common::BoolExpression *>(pattern)->value);
+            case Common::NodeType::PrefixExpression: {
+                auto prefixExpr = static_cast<Common::PrefixExpression *>(pattern);
+                if (prefixExpr->prefixOperator == Common::PrefixOperator::Minus) {
+                    auto value = patternValue(prefixExpr->rightExpression.get());
+                    if (value->getType() == Common::ObjectType::INTEGER) {
+                        auto integerObject = static_cast<Common::IntegerObject *>(value.get());
+                        return make_shared<Common::IntegerObject>(-integerObject->value);
+                    }
+                    if (value->getType() == Common::ObjectType::FLOAT) {
+                        auto floatObject = static_cast<Common::FloatObject *>(value.get());
+                        return make_shared<Common::FloatObject>(-floatObject->value);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        throw fmt::format("match pattern must be a literal, got {}", pattern->toString());
+    }
+
+    vector<int> Compiler::compileCondition(Common::Expression *condition) {
+        if (condition->getType() == Common::NodeType::InfixExpression) {
+            auto expr = static_cast<Common::InfixExpression *>(condition);
+            if (expr->infixOperator == Common::InfixOperator::And) {
+                auto falseJumps = compileCondition(expr->leftExpression.get());
+                auto rightFalseJumps = compileCondition(expr->rightExpression.get());
+                falseJumps.insert(falseJumps.end(), rightFalseJumps.begin(), rightFalseJumps.end());
+                return falseJumps;
+            }
+            if (expr->infixOperator == Common::InfixOperator::Or) {
+                auto leftFalseJumps = compileCondition(expr->leftExpression.get());
+                // the left operand holds, skip the right one
+                auto trueJumpPos = emit(OpCode::Jump, {DUMB_INSTRUCTION_ADDRESS});
+                patchJumps(leftFalseJumps);
+                auto falseJumps = compileCondition(expr->rightExpression.get());
+                changeOperand(trueJumpPos, {int(instructions()->size())});
+                return falseJumps;
+            }
+
+            // fused compare and branch, no boolean is pushed between the comparison and the jump
+            if (auto jump = comparisonJump(expr->infixOperator)) {
+                compile(expr->leftExpression.get());
+                compile(expr->rightExpression.get());
+                return {emit(*jump, {DUMB_INSTRUCTION_ADDRESS})};
+            }
+        }
+        compile(condition);
+        return {emit(OpCode::JumpNotTruthy, {DUMB_INSTRUCTION_ADDRESS})};
+    }
+
+    void Compiler::patchJumps(const vector<int> &positions) {
+        for (auto position: positions) {
+            changeOperand(position, {int(instructions()->size())});
+        }
+    }
+
+    void Compiler::keepBlockValue() {
+        if (lastInstruction().code == OpCode::Pop) {
+            // remove last pop code
+            scopes[scopeIndex].instructions.pop_back();
+        } else if (lastInstruction().code != OpCode::ReturnValue) {
+            // the block ends with a let, an assignment or a loop
+            emit(OpCode::_Null);
+        }
+    }
+    Compiler::StaticType Compiler::staticType(Common::Expression *expression) {
+        switch (expression->getType()) {
+            case Common::NodeType::IntegerExpression:
+                return StaticType::Integer;
+            case Common::NodeType::FloatExpression:
+                return StaticType::Float;
+            case Common::NodeType::PrefixExpression: {
+                auto prefixExpr = static_cast<Common::PrefixExpression *>(expression);
+                if (prefixExpr->prefixOperator == Common::PrefixOperator::Minus) {
+                    return staticType(prefixExpr->rightExpression.get());
+                }
+                return StaticType::Unknown;
+            }
+            case Common::NodeType::InfixExpression: {
+                auto infixExpr = static_cast<Common::InfixExpression *>(expression);
+                auto op = infixExpr->infixOperator;
+                if (op != Common::InfixOperator::Add && op != Common::InfixOperator::Sub &&
+                    op != Common::InfixOperator::Mul && op != Common::InfixOperator::Div &&
+                    op != Common::InfixOperator::Mod) {
+                    return StaticType::Unknown;
+                }
+                auto left = staticType(infixExpr->leftExpression.get());
+                auto right = staticType(infixExpr->rightExpression.get());
+                if (left == StaticType::Unknown || right == StaticType::Unknown) {
+                    return StaticType::Unknown;
+                }
+                // an integer mixed with a float is promoted
+                return left == StaticType::Float || right == StaticType::Float ? StaticType::Float
+                                                                               : StaticType::Integer;
+            }
+            case Common::NodeType::CallExpression: {
+                // the math builtins return a float for number arguments, any other arity is an error at runtime
+                auto callExpr = static_cast<Common::CallExpression *>(expression);
+                if (callExpr->name->getType() != Common::NodeType::Identifier) {
+                    return StaticType::Unknown;
+                }
+                auto identifier = static_cast<Common::Identifier *>(callExpr->name.get());
+                auto name = identifier->token.literal;
+                auto symbol = symbolTableManager.resolve(identifier->symbol);
+                if (!symbol.has_value() || symbol->scope != SymbolScope::Builtin ||
+                    (name != "sqrt" && name != "floor" && name != "pow")) {
+                    return StaticType::Unknown;
+                }
+                auto arity = name == "pow" ? 2u : 1u;
+                if (callExpr->arguments.size() != arity) {
+                    return StaticType::Unknown;
+                }
+                auto numbers = std::all_of(callExpr->arguments.begin(), callExpr->arguments.end(), [this](auto &arg) {
+                    return staticType(arg.get()) != StaticType::Unknown;
+                });
+                return numbers ? StaticType::Float : StaticType::Unknown;
+            }
+            default:
+                return StaticType::Unknown;
+        }
+    }
+
 }
 
 #pragma clang diagnostic pop
@@ -5,11 +5,13 @@
 #ifndef GOINTERPRETER_COMPILER_H
 #define GOINTERPRETER_COMPILER_H
 
+#include <cstdint>
 #include <vector>
 #include "Ast.h"
 #include "Code.h"
 #include "SymbolTable.h"
 #include "GIObject.h"
+#include "Builtin.h"
 
 namespace GC {
     using namespace std;
@@ -22,12 +24,14 @@ namespace GC {
         Instruction instructions;
         EmittedInstruction lastInstruction;
         EmittedInstruction previousInstruction;
+        LineTable lines;
     };
 
     using Constants = vector<shared_ptr<Common::GIObject>>;
     struct ByteCode {
         Instruction instructions;
         Constants constants;
+        LineTable lines;
     };
 
     class Compiler {
@@ -38,10 +42,14 @@ namespace GC {
                     {
                             .instructions =  {},
                             .lastInstruction =  EmittedInstruction{},
-                            .previousInstruction =  EmittedInstruction{}
+                            .previousInstruction =  EmittedInstruction{},
+                            .lines =  {}
                     });
-            // builtin function
-            symbolTableManager.defineBuiltin(0, "len");
+            // builtin function, every symbol table interns their names first
+            auto builtins = Common::builtinDefinitions();
+            for (auto index = 0; index < int(builtins.size()); index++) {
+                symbolTableManager.defineBuiltin(index, Common::SymbolId(index));
+            }
         }
 
         void compile(Common::Node *node);
@@ -51,12 +59,15 @@ namespace GC {
         ByteCode getByteCode() {
             return {
                     currentInstructions(),
-                    constants
+                    constants,
+                    scopes[scopeIndex].lines
             };
         }
 
 
     private:
+        void compileNode(Common::Node *node);
+
         int emit(OpCode opCode, vector<int> operands = {});
 
         void setLastInstruction(OpCode code, int position);
@@ -71,9 +82,22 @@ namespace GC {
 
         void replaceLastPopWithReturn();
 
+        // compiles a condition and the jumps taken when it is falsy, returns their positions for `patchJumps`.
+        // Comparisons use the fused compare and branch opcodes, && and || only jump.
+        vector<int> compileCondition(Common::Expression *condition);
+
+        // value of a literal match pattern
+        shared_ptr<Common::GIObject> patternValue(Common::Expression *pattern);
+
+        // point the jumps at the next instruction
+        void patchJumps(const vector<int> &positions);
+
+        // a block used as an expression leaves its last value on the stack, or null when it ends without one
+        void keepBlockValue();
+
         void enterScope();
 
-        Instruction leaveScope();
+        CompilationScope leaveScope();
 
         Instruction currentInstructions() {
             return scopes[scopeIndex].instructions;
@@ -93,12 +117,27 @@ namespace GC {
 
         void loadSymbol(Symbol symbol);
 
+        // what the compiler can tell about an expression's value without running it
+        enum class StaticType {
+            Unknown,
+            // INTEGER or BIG_INTEGER
+            Integer,
+            Float,
+        };
+
+        StaticType staticType(Common::Expression *expression);
+
         SymbolTableManager symbolTableManager{};
 
         Code code{};
 
         int scopeIndex{0};
         vector<CompilationScope> scopes;
+
+        // line the emitted instructions are attributed to
+        std::uint32_t line{0};
+        // correction for the lines of a top level statement reused by Parser::reparse
+        std::int32_t lineShift{0};
     };
 }
 
@@ -3,3 +3,63 @@
 //
 
 #include "CompilerObject.h"
+
+namespace GC {
+
+    bool isHashable(ObjectType type) {
+        switch (type) {
+            case ObjectType::INTEGER:
+            case ObjectType::BIG_INTEGER:
+            case ObjectType::FLOAT:
+            case ObjectType::STRING:
+            case ObjectType::BOOLEAN:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void MatchTableObject::addDense(std::int64_t key, int target) {
+        auto &slot = denseTargets[std::uint64_t(key) - std::uint64_t(low)];
+        if (slot < 0) {
+            slot = target;
+        }
+    }
+
+    void MatchTableObject::addHashed(const shared_ptr<GIObject> &key, int target) {
+        auto hashKey = key->hash();
+        auto [first, last] = hashedTargets.equal_range(hashKey);
+        for (auto it = first; it != last; ++it) {
+            if (valueEquals(it->second.first.get(), key.get())) {
+                return;
+            }
+        }
+        hashedTargets.emplace(hashKey, std::make_pair(key, target));
+    }
+
+    int MatchTableObject::denseTarget(GIObject *subject) const {
+        if (subject->getType() != ObjectType::INTEGER) {
+            return defaultTarget;
+        }
+        // wraps around for values below low, which lands past the end as well
+        auto offset = std::uint64_t(static_cast<IntegerObject *>(subject)->value) - std::uint64_t(low);
+        if (offset >= denseTargets.size() || denseTargets[offset] < 0) {
+            return defaultTarget;
+        }
+        return denseTargets[offset];
+    }
+
+    int MatchTableObject::hashedTarget(GIObject *subject) const {
+        if (!isHashable(subject->getType())) {
+            return defaultTarget;
+        }
+        auto [first, last] = hashedTargets.equal_range(subject->hash());
+        for (auto it = first; it != last; ++it) {
+            // hashes of different types may collide, like 1 and true
+            if (valueEquals(it->second.first.get(), subject)) {
+                return it->second.second;
+            }
+        }
+        return defaultTarget;
+    }
+}
@@ -7,12 +7,15 @@
 
 #include "GIObject.h"
 #include "Code.h"
+#include <cstdint>
+#include <unordered_map>
 
 using namespace Common;
 namespace GC {
     struct CompiledFunctionObject : GIObject {
-        CompiledFunctionObject(const Instruction &instructions, int numParameters, int numLocals) : numLocals(
-                numLocals), numParameters{numParameters}, instructions{instructions} {}
+        CompiledFunctionObject(const Instruction &instructions, int numParameters, int numLocals,
+                               std::shared_ptr<const LineTable> lines = nullptr) : numLocals(
+                numLocals), numParameters{numParameters}, instructions{instructions}, lines{std::move(lines)} {}
 
         ObjectType getType() override {
             return ObjectType::COMPILED_FUNCTION;
@@ -22,9 +25,16 @@ namespace GC {
             return "CompiledFunction";
         }
 
+        // source line of the instruction at `ip`, 0 when unknown
+        std::uint32_t lineAt(int ip) const {
+            return lines != nullptr ? lines->lineAt(ip) : 0;
+        }
+
         Instruction instructions;
         int numParameters;
         int numLocals;
+        // shared, frames copy the function object on every call
+        std::shared_ptr<const LineTable> lines;
     };
 
     struct ClosureObject : GIObject {
@@ -38,6 +48,32 @@ namespace GC {
 
         std::string inspect() override { return "Closure"; }
     };
+
+    // Constant lookup table of a match expression, it maps pattern values to the address of their arm.
+    // JumpTable indexes `denseTargets` with the integer subject, JumpHashTable looks the subject up by hash.
+    struct MatchTableObject : GIObject {
+        ObjectType getType() override { return Common::ObjectType::MATCH_TABLE; }
+
+        std::string inspect() override { return "MatchTable"; }
+
+        // the first arm listing a value keeps it
+        void addDense(std::int64_t key, int target);
+
+        void addHashed(const shared_ptr<GIObject> &key, int target);
+
+        int denseTarget(GIObject *subject) const;
+
+        int hashedTarget(GIObject *subject) const;
+
+        // denseTargets[i] is the arm address for low + i, -1 when no pattern has that value
+        std::int64_t low{0};
+        std::vector<int> denseTargets;
+
+        std::unordered_multimap<HashKey, std::pair<shared_ptr<GIObject>, int>> hashedTargets;
+
+        // address of the `_` arm, or of the null pushed when there is none
+        int defaultTarget{0};
+    };
 }
 
 
@@ -8,12 +8,21 @@
 #include "CompilerObject.h"
 
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
 namespace GC {
     using namespace std;
 
+    // an iterator waiting for the result of the callback running on a frame
+    struct IteratorDrive {
+        shared_ptr<Common::IteratorObject> iterator;
+        // where the for-in loop continues once the iterator is exhausted, -1 when the first element is the
+        // result of a driven builtin call
+        int exitTarget;
+    };
+
     struct Frame {
         Frame(ClosureObject closureObject, int basePointer, int ip = -1) :
                 closureObject{closureObject}, ip{ip}, basePointer(basePointer) {}
@@ -21,12 +30,14 @@ namespace GC {
         ClosureObject closureObject;
         int ip;
         int basePointer;
+        // set on frames of callbacks requested by an iterator, their return value goes back to the iterator
+        std::optional<IteratorDrive> drive{};
     };
 
     class FrameManager {
     public:
-        FrameManager(Instruction instructions) {
-            auto fn = GC::CompiledFunctionObject(instructions, 0, 0);
+        FrameManager(Instruction instructions, std::shared_ptr<const LineTable> lines = nullptr) {
+            auto fn = GC::CompiledFunctionObject(instructions, 0, 0, std::move(lines));
             auto mainFrame = Frame{
                     ClosureObject(std::move(fn), {}),
                     0
@@ -59,7 +70,7 @@ namespace GC {
             return frame;
         }
 
-        Instruction getInstructions() {
+        const Instruction &getInstructions() {
             return currentFrame()->closureObject.compiledFunctionObject.instructions;
         }
 
@@ -15,7 +15,7 @@ namespace GC {
         symbolTable = &symbolTables.back();
     }
 
-    Symbol SymbolTableManager::define(const string &name) {
+    Symbol SymbolTableManager::define(Common::SymbolId name) {
         auto st = &symbolTables.back();
         auto s = Symbol{name, SymbolScope::Global, st->numDefinitions};
         if (st->hasOuter) {
@@ -27,14 +27,14 @@ namespace GC {
     }
 
 
-    Symbol SymbolTableManager::defineBuiltin(int index, string name) {
+    Symbol SymbolTableManager::defineBuiltin(int index, Common::SymbolId name) {
         auto s = Symbol{name, SymbolScope::Builtin, index};
         auto st = &symbolTables.back();
         st->store[name] = s;
         return s;
     }
 
-    Symbol SymbolTableManager::defineFunctionName(string name) {
+    Symbol SymbolTableManager::defineFunctionName(Common::SymbolId name) {
         auto s = Symbol{name, SymbolScope::Function, 0};
         auto st = &symbolTables.back();
         st->store[name] = s;
@@ -50,14 +50,14 @@ namespace GC {
         return s;
     }
 
-    optional<Symbol> SymbolTableManager::resolve(const string &name) {
-        auto localSymbolTable = symbolTables.back();
-        if (localSymbolTable.store.contains(name)) {
-            return localSymbolTable.store[name];
+    optional<Symbol> SymbolTableManager::resolve(Common::SymbolId name) {
+        auto &localStore = symbolTables.back().store;
+        if (auto it = localStore.find(name); it != localStore.end()) {
+            return it->second;
         }
         for (auto s = symbolTables.rbegin() + 1; s != symbolTables.rend(); s++) {
-            if (s->store.contains(name)) {
-                auto symbol = s->store[name];
+            if (auto it = s->store.find(name); it != s->store.end()) {
+                auto symbol = it->second;
 
                 if (symbol.scope == SymbolScope::Global || symbol.scope == SymbolScope::Builtin) {
                     return symbol;
@@ -5,10 +5,12 @@
 #ifndef GOINTERPRETER_SYMBOLTABLE_H
 #define GOINTERPRETER_SYMBOLTABLE_H
 
-#include <map>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
+#include "Symbol.h"
 
 namespace GC {
     using namespace std;
@@ -21,7 +23,7 @@ namespace GC {
     };
 
     struct Symbol {
-        string name;
+        Common::SymbolId name;
         SymbolScope scope;
         int index;
     };
@@ -30,7 +32,7 @@ namespace GC {
     public:
         SymbolTable(bool hasOuter) : hasOuter{hasOuter} {}
 
-        std::map<string, Symbol> store{};
+        std::unordered_map<Common::SymbolId, Symbol> store{};
         int numDefinitions{0};
         std::vector<Symbol> freeSymbols{};
 
@@ -50,15 +52,15 @@ namespace GC {
 
         SymbolTable *symbolTable;
 
-        Symbol define(const string &name);
+        Symbol define(Common::SymbolId name);
 
-        Symbol defineBuiltin(int index, string name);
+        Symbol defineBuiltin(int index, Common::SymbolId name);
 
-        Symbol defineFunctionName(string name);
+        Symbol defineFunctionName(Common::SymbolId name);
 
         Symbol defineFree(Symbol original);
 
-        std::optional<Symbol> resolve(const string &name);
+        std::optional<Symbol> resolve(Common::SymbolId name);
 
     private:
         std::vector<SymbolTable> symbolTables{};
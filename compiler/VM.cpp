@@ -8,9 +8,11 @@
 #include "magic_enum.hpp"
 #include "fmt/format.h"
 #include "Builtin.h"
+#include "Arithmetic.h"
 #include <cstddef>
 #include <string>
 #include <numeric>
+#include <utility>
 
 namespace GC {
     bool isObjectTypeMatched(const shared_ptr<Common::GIObject> &object, ObjectType type) {
@@ -27,12 +29,95 @@ namespace GC {
     }
 
 
+    VM::VM(ByteCode byteCode) : constants{byteCode.constants},
+                                frameManager{byteCode.instructions,
+                                             std::make_shared<const LineTable>(std::move(byteCode.lines))} {
+        stack.reserve(STACK_SIZE);
+        globals.resize(GLOBALS_SIZE);
+        auto builtins = builtinDefinitions();
+        for (auto index = 0; index < int(builtins.size()); index++) {
+            builtinObjects.push_back(make_shared<BuiltinFunctionObject>(index, builtins[index].name));
+        }
+    }
+
     shared_ptr<Common::GIObject> VM::lastStackElem() {
-        return stack[sp];
+        return lastPopped;
     }
 
     void VM::run() {
-        while (currentFrame()->ip < int(getInstructions().size()) - 1) {
+        try {
+            execute(0);
+        } catch (const VMException &exception) {
+            auto line = currentLine();
+            if (exception.line != 0 || line == 0) {
+                throw;
+            }
+            throw VMException{exception.what(), line};
+        } catch (const std::logic_error &error) {
+            // broken invariants of the objects the VM drives, e.g. an iterator resumed out of turn
+            auto line = currentLine();
+            throw line != 0 ? VMException{error.what(), line} : VMException{error.what()};
+        }
+    }
+
+    std::uint32_t VM::currentLine() {
+        auto frame = currentFrame();
+        return frame->closureObject.compiledFunctionObject.lineAt(std::max(frame->ip, 0));
+    }
+
+    // counts a native call while it runs, also when the callee throws
+    struct NativeCallScope {
+        explicit NativeCallScope(int &depth) : depth{depth} { depth++; }
+
+        ~NativeCallScope() { depth--; }
+
+        NativeCallScope(const NativeCallScope &) = delete;
+
+        NativeCallScope &operator=(const NativeCallScope &) = delete;
+
+        int &depth;
+    };
+
+    shared_ptr<Common::GIObject> VM::call(const shared_ptr<Common::GIObject> &function,
+                                          Common::BuiltinArguments arguments) {
+        if (function->getType() == ObjectType::BUILTIN) {
+            auto &definition = builtinDefinitions()[static_cast<Common::BuiltinFunctionObject *>(function.get())->index];
+            auto result = definition.function(arguments, *this);
+            if (result == nullptr) {
+                return make_shared<Common::NullObject>();
+            }
+            if (!definition.driven || !isObjectTypeMatched(result, ObjectType::ITERATOR)) {
+                return result;
+            }
+            auto iterator = static_cast<Common::IteratorObject *>(result.get());
+            auto step = iterator->next();
+            while (step.kind == Common::IteratorStep::Kind::Call) {
+                step = iterator->resume(call(step.value, step.arguments));
+            }
+            if (step.kind == Common::IteratorStep::Kind::Done) {
+                return make_shared<Common::NullObject>();
+            }
+            return step.value;
+        }
+        if (function->getType() != ObjectType::CLOSURE) {
+            throw VMException{fmt::format("{} is not a function", magic_enum::enum_name(function->getType()))};
+        }
+        if (nativeCallDepth >= MAX_NATIVE_CALL_DEPTH) {
+            throw VMException{"maximum native call depth exceeded"};
+        }
+
+        stackPush(function);
+        for (auto &argument: arguments) {
+            stackPush(argument);
+        }
+        callClosure(static_cast<GC::ClosureObject *>(function.get()), int(arguments.size()));
+        NativeCallScope scope{nativeCallDepth};
+        execute(frameManager.frameIndex);
+        return stackPop();
+    }
+
+    void VM::execute(int baseFrameIndex) {
+        while (frameManager.frameIndex >= baseFrameIndex && currentFrame()->ip < int(getInstructions().size()) - 1) {
             currentFrame()->ip++;
             auto ip = currentFrame()->ip;
             auto instruction = getInstructions()[ip];
@@ -47,122 +132,153 @@ namespace GC {
                 case OpCode::Sub:
                 case OpCode::Mul:
                 case OpCode::Div:
+                case OpCode::Mod:
                 case OpCode::Add: {
                     auto right = stackPop();
                     auto left = stackPop();
-                    if (isObjectTypeMatched(left, ObjectType::INTEGER) &&
-                        isObjectTypeMatched(right, ObjectType::INTEGER)) {
-                        auto leftValue = static_cast<Common::IntegerObject *>(left.get())->value;
-                        auto rightValue = static_cast<Common::IntegerObject *>(right.get())->value;
-
-                        int result;
+                    if (isNumberType(left->getType()) && isNumberType(right->getType())) {
+                        ArithmeticOperator op;
                         switch (opCode) {
                             case OpCode::Add:
-                                result = leftValue + rightValue;
+                                op = ArithmeticOperator::Add;
                                 break;
                             case OpCode::Sub:
-                                result = leftValue - rightValue;
+                                op = ArithmeticOperator::Sub;
                                 break;
                             case OpCode::Mul:
-                                result = leftValue * rightValue;
+                                op = ArithmeticOperator::Mul;
                                 break;
-                            case OpCode::Div:
-                                result = leftValue / rightValue;
+                            case OpCode::Mod:
+                                op = ArithmeticOperator::Mod;
                                 break;
                             default:
-                                // unreachable
+                                op = ArithmeticOperator::Div;
                                 break;
                         }
-                        stackPush(make_shared<Common::IntegerObject>(result));
+                        auto result = numberArithmetic(op, left.get(), right.get());
+                        if (isObjectTypeMatched(result, ObjectType::ERROR)) {
+                            throw VMException{static_cast<Common::ErrorObject *>(result.get())->message};
+                        }
+                        stackPush(result);
                     } else if (isObjectTypeMatched(left, Common::ObjectType::STRING) &&
                                isObjectTypeMatched(right, Common::ObjectType::STRING)) {
                         auto leftValue = static_cast<Common::StringObject *>(left.get())->value;
                         auto rightValue = static_cast<Common::StringObject *>(right.get())->value;
                         if (opCode == OpCode::Add) {
-                            stackPush(make_shared<Common::StringObject>(leftValue + rightValue));
+                            string value;
+                            value.reserve(leftValue.size() + rightValue.size());
+                            value.append(leftValue).append(rightValue);
+                            stackPush(make_shared<Common::StringObject>(std::move(value)));
                         } else {
                             throw VMException{fmt::format("unsupported binary operation {} on string",
                                                           to_string(int(opCode)))};
                         }
+                    } else {
+                        throw VMException{fmt::format("unsupported types for binary operation: {} {}",
+                                                      magic_enum::enum_name(left->getType()),
+                                                      magic_enum::enum_name(right->getType()))};
                     }
                     break;
                 }
+                case OpCode::AddFloat:
+                case OpCode::SubFloat:
+                case OpCode::MulFloat:
+                case OpCode::DivFloat: {
+                    auto right = stackPop();
+                    auto left = stackPop();
+                    // the compiler proved both operands are floats
+                    auto leftValue = static_cast<Common::FloatObject *>(left.get())->value;
+                    auto rightValue = static_cast<Common::FloatObject *>(right.get())->value;
+                    double result;
+                    switch (opCode) {
+                        case OpCode::AddFloat:
+                            result = leftValue + rightValue;
+                            break;
+                        case OpCode::SubFloat:
+                            result = leftValue - rightValue;
+                            break;
+                        case OpCode::MulFloat:
+                            result = leftValue * rightValue;
+                            break;
+                        default:
+                            result = leftValue / rightValue;
+                            break;
+                    }
+                    stackPush(make_shared<Common::FloatObject>(result));
+                    break;
+                }
                 case OpCode::True:
                 case OpCode::False:
-                    stackPush(make_shared<Common::BooleanObject>(opCode == OpCode::True));
+                    stackPush(boolObject(opCode == OpCode::True));
                     break;
                 case OpCode::Equal:
                 case OpCode::NotEqual:
-                case OpCode::GreaterThan: {
+                case OpCode::GreaterThan:
+                case OpCode::GreaterEqual:
+                case OpCode::LessThan:
+                case OpCode::LessEqual: {
                     auto right = stackPop();
                     auto left = stackPop();
-                    if (isObjectTypeMatched(left, Common::ObjectType::INTEGER) &&
-                        isObjectTypeMatched(right, Common::ObjectType::INTEGER)) {
-                        auto leftValue = static_cast<Common::IntegerObject *>(left.get())->value;
-                        auto rightValue = static_cast<Common::IntegerObject *>(right.get())->value;
-                        switch (opCode) {
-                            case OpCode::Equal:
-                                stackPush(make_shared<Common::BooleanObject>(leftValue == rightValue));
-                                break;
-                            case OpCode::NotEqual:
-                                stackPush(make_shared<Common::BooleanObject>(leftValue != rightValue));
-                                break;
-                            case OpCode::GreaterThan:
-                                stackPush(make_shared<Common::BooleanObject>(leftValue > rightValue));
-                                break;
-                            default:
-                                // unreachable
-                                break;
-                        }
-                    } else {
-                        if (isObjectTypeMatched(left, Common::ObjectType::BOOLEAN) &&
-                            isObjectTypeMatched(right, Common::ObjectType::BOOLEAN)) {
-                            auto leftValue = static_cast<Common::BooleanObject *>(left.get())->value;
-                            auto rightValue = static_cast<Common::BooleanObject *>(right.get())->value;
-                            switch (opCode) {
-                                case OpCode::Equal:
-                                    stackPush(make_shared<Common::BooleanObject>(leftValue == rightValue));
-                                    break;
-                                case OpCode::NotEqual:
-                                    stackPush(make_shared<Common::BooleanObject>(leftValue != rightValue));
-                                    break;
-                                case OpCode::GreaterThan:
-                                    throw VMException{"unsupported greater than instruction on bool"};
-                                default:
-                                    // unreachable
-                                    break;
-                            }
-                        } else {
-                            throw VMException{fmt::format("unsupported infix operation on type: {}",
-                                                          magic_enum::enum_name(left->getType()))};
-                        }
+                    stackPush(boolObject(compare(opCode, left.get(), right.get())));
+                    break;
+                }
+                case OpCode::JumpIfNotEqual:
+                case OpCode::JumpIfEqual:
+                case OpCode::JumpIfNotGreater:
+                case OpCode::JumpIfNotGreaterEqual:
+                case OpCode::JumpIfNotLess:
+                case OpCode::JumpIfNotLessEqual: {
+                    auto insIndex = readFirstOperandAndMoveIP(opCode, ip);
 
+                    OpCode comparison;
+                    switch (opCode) {
+                        case OpCode::JumpIfNotEqual:
+                            comparison = OpCode::Equal;
+                            break;
+                        case OpCode::JumpIfEqual:
+                            comparison = OpCode::NotEqual;
+                            break;
+                        case OpCode::JumpIfNotGreater:
+                            comparison = OpCode::GreaterThan;
+                            break;
+                        case OpCode::JumpIfNotGreaterEqual:
+                            comparison = OpCode::GreaterEqual;
+                            break;
+                        case OpCode::JumpIfNotLess:
+                            comparison = OpCode::LessThan;
+                            break;
+                        default:
+                            comparison = OpCode::LessEqual;
+                            break;
+                    }
+                    auto right = stackPop();
+                    auto left = stackPop();
+                    if (!compare(comparison, left.get(), right.get())) {
+                        currentFrame()->ip = insIndex - 1;
                     }
                     break;
                 }
                 case OpCode::Bang: {
                     auto operand = stackPop();
                     if (isObjectTypeMatched(operand, ObjectType::BOOLEAN)) {
-                        auto boolObject = static_cast<Common::BooleanObject *>(operand.get());
-                        stackPush(make_shared<Common::BooleanObject>(!boolObject->value));
+                        stackPush(boolObject(!static_cast<Common::BooleanObject *>(operand.get())->value));
                     } else {
-                        stackPush(make_shared<Common::BooleanObject>(false));
+                        stackPush(boolObject(false));
                     }
 
                     break;
                 }
                 case OpCode::Minus: {
                     auto operand = stackPop();
-                    if (!isObjectTypeMatched(operand, Common::ObjectType::INTEGER)) {
+                    if (!isNumberType(operand->getType())) {
                         throw VMException{fmt::format("unsupported type for negation: {}",
                                                       magic_enum::enum_name(operand->getType()))};
                     }
-                    auto integerObject = static_cast<Common::IntegerObject *>(operand.get());
-                    stackPush(make_shared<Common::IntegerObject>(-integerObject->value));
+                    stackPush(numberNegate(operand.get()));
                     break;
                 }
                 case OpCode::Pop:
-                    stackPop();
+                    lastPopped = stackPop();
                     break;
                 case OpCode::Jump: {
                     auto insIndex = readFirstOperand(opCode, ip);
@@ -189,6 +305,18 @@ namespace GC {
 
                     break;
                 }
+                case OpCode::TakeGlobal: {
+                    auto globalIndex = readFirstOperandAndMoveIP(opCode, ip);
+
+                    stackPush(std::exchange(globals[globalIndex], nullptr));
+                    break;
+                }
+                case OpCode::TakeLocal: {
+                    auto localIndex = readFirstOperandAndMoveIP(opCode, ip);
+
+                    stackPush(std::exchange(stack[currentFrame()->basePointer + int(localIndex)], nullptr));
+                    break;
+                }
                 case OpCode::GetGlobal: {
                     auto globalIndex = readFirstOperandAndMoveIP(opCode, ip);
 
@@ -200,8 +328,9 @@ namespace GC {
 
                     vector<shared_ptr<Common::GIObject>> elements;
                     for (auto index = 0; index < numElements; index++) {
-                        elements.push_back(stack[sp - numElements + index]);
+                        elements.push_back(std::move(stack[sp - numElements + index]));
                     }
+                    sp = sp - numElements;
                     stackPush(make_shared<Common::ArrayObject>(std::move(elements)));
 
                     break;
@@ -212,17 +341,18 @@ namespace GC {
                     std::map<Common::HashKey, Common::HashPair> pairs{};
                     for (auto index = 0; index < numElements; index += 2) {
                         int keyIndex = sp - numElements + index;
-                        auto key = stack[keyIndex];
-                        auto value = stack[keyIndex + 1];
+                        auto key = std::move(stack[keyIndex]);
+                        auto value = std::move(stack[keyIndex + 1]);
 
                         auto hashKey = key->hash();
                         pairs[hashKey] = {
-                                key,
-                                value
+                                std::move(key),
+                                std::move(value)
                         };
                     }
+                    sp = sp - numElements;
 
-                    stackPush(make_shared<Common::HashObject>(pairs));
+                    stackPush(make_shared<Common::HashObject>(std::move(pairs)));
                     break;
                 }
                 case OpCode::Index: {
@@ -234,13 +364,22 @@ namespace GC {
                         auto arrayObject = static_cast<Common::ArrayObject *>(object.get());
                         auto indexValue = static_cast<Common::IntegerObject *>(index.get())->value;
 
-                        if (indexValue < 0 || indexValue >= arrayObject->elements.size()) {
+                        if (indexValue < 0 || std::uint64_t(indexValue) >= arrayObject->size()) {
                             stackPush(make_shared<Common::NullObject>());
                             break;
                         }
-                        auto elem = arrayObject->elements[indexValue];
-                        stackPush(elem);
+                        stackPush(arrayObject->at(indexValue));
 
+                    } else if (isObjectTypeMatched(object, Common::ObjectType::STRING) &&
+                               isObjectTypeMatched(index, Common::ObjectType::INTEGER)) {
+                        // one byte view into the string's buffer
+                        auto stringObject = static_cast<Common::StringObject *>(object.get());
+                        auto indexValue = static_cast<Common::IntegerObject *>(index.get())->value;
+                        if (indexValue < 0 || std::uint64_t(indexValue) >= stringObject->value.size()) {
+                            stackPush(make_shared<Common::NullObject>());
+                            break;
+                        }
+                        stackPush(stringObject->substr(indexValue, indexValue + 1));
                     } else if (isObjectTypeMatched(object, Common::ObjectType::HASH)) {
                         auto hashObject = static_cast<Common::HashObject *>(object.get());
                         auto hashKey = index->hash();
@@ -260,10 +399,14 @@ namespace GC {
 
                     auto callee = stack[sp - 1 - numArgs].get();
                     if (callee->getType() == Common::ObjectType::BUILTIN) {
-                        auto name = static_cast<Common::BuiltinFunctionObject *>(callee)->name;
-                        BuiltinArguments args{stack.begin() + sp - numArgs, stack.begin() + sp};
-                        auto result = evalBuiltin(name, args);
-                        if (result != nullptr) {
+                        auto &definition = builtinDefinitions()[static_cast<Common::BuiltinFunctionObject *>(callee)->index];
+                        auto result = definition.function({stack.data() + sp - numArgs, std::size_t(numArgs)}, *this);
+                        stackClear(sp - numArgs - 1);
+                        if (definition.driven && result != nullptr && isObjectTypeMatched(result, ObjectType::ITERATOR)) {
+                            auto iterator = static_pointer_cast<Common::IteratorObject>(std::move(result));
+                            auto step = iterator->next();
+                            advance({std::move(iterator), -1}, std::move(step));
+                        } else if (result != nullptr) {
                             stackPush(std::move(result));
                         } else {
                             stackPush(make_shared<Common::NullObject>());
@@ -271,28 +414,21 @@ namespace GC {
                         break;
                     }
 
-                    auto closureObject = static_cast<GC::ClosureObject *>(callee);
-                    if (numArgs != closureObject->compiledFunctionObject.numParameters) {
-                        throw VMException{"wrong number of arguments"};
-                    }
-                    auto basePointer = sp - numArgs;
-
-                    frameManager.framePush(Frame{*closureObject, basePointer});
-
-                    break;
-                }
-                case OpCode::ReturnValue: {
-                    auto value = stackPop();
-                    auto frame = frameManager.framePop();
-                    sp = frame.basePointer - 1;
-
-                    stackPush(value);
+                    callClosure(static_cast<GC::ClosureObject *>(callee), numArgs);
                     break;
                 }
+                case OpCode::ReturnValue:
                 case OpCode::Return: {
+                    auto value = opCode == OpCode::ReturnValue ? stackPop() : make_shared<Common::NullObject>();
                     auto frame = frameManager.framePop();
-                    sp = frame.basePointer - 1;
-                    stackPush(make_shared<Common::NullObject>());
+                    stackClear(frame.basePointer - 1);
+
+                    if (frame.drive.has_value()) {
+                        auto step = frame.drive->iterator->resume(std::move(value));
+                        advance(std::move(*frame.drive), std::move(step));
+                    } else {
+                        stackPush(value);
+                    }
                     break;
                 }
                 case OpCode::GetLocal: {
@@ -311,12 +447,9 @@ namespace GC {
                     break;
                 }
                 case OpCode::GetBuiltin: {
-                    auto localIndex = readFirstOperandAndMoveIP(opCode, ip);
-
-                    auto index = currentFrame()->basePointer + int(localIndex);
+                    auto builtinIndex = readFirstOperandAndMoveIP(opCode, ip);
 
-                    auto name = builtinIndexMap[index];
-                    stackPush(make_shared<BuiltinFunctionObject>(name));
+                    stackPush(builtinObjects[builtinIndex]);
                     break;
                 }
                 case OpCode::Closure: {
@@ -334,6 +467,55 @@ namespace GC {
                     stackPush(currentClosure.freeObjects[freeIndex]);
                     break;
                 }
+                case OpCode::SetIndex: {
+                    auto depth = readFirstOperandAndMoveIP(opCode, ip);
+
+                    // the root was taken out of its variable, a single owner means nobody can observe the mutation
+                    auto root = stackPop();
+                    auto value = stackPop();
+                    vector<shared_ptr<Common::GIObject>> indices(depth);
+                    for (auto index = depth - 1; index >= 0; index--) {
+                        indices[index] = stackPop();
+                    }
+                    auto result = Common::setIndexPath(root, indices, std::move(value), root.use_count() == 1);
+                    if (isObjectTypeMatched(result, ObjectType::ERROR)) {
+                        restoreTakenRoot(std::move(root));
+                        throw VMException{static_cast<Common::ErrorObject *>(result.get())->message};
+                    }
+                    root.reset();
+                    stackPush(result);
+                    break;
+                }
+                case OpCode::JumpTable:
+                case OpCode::JumpHashTable: {
+                    auto constIndex = readFirstOperandAndMoveIP(opCode, ip);
+
+                    auto table = static_cast<MatchTableObject *>(constants[constIndex].get());
+                    auto subject = stackPop();
+                    auto target = opCode == OpCode::JumpTable ? table->denseTarget(subject.get())
+                                                              : table->hashedTarget(subject.get());
+                    currentFrame()->ip = target - 1;
+                    break;
+                }
+                case OpCode::IterInit: {
+                    auto iterable = stackPop();
+                    auto iterator = Common::makeIterator(iterable);
+                    if (iterator == nullptr) {
+                        throw VMException{fmt::format("cannot iterate over {}",
+                                                      magic_enum::enum_name(iterable->getType()))};
+                    }
+                    iterable.reset();
+                    stackPush(iterator);
+                    break;
+                }
+                case OpCode::IterNext: {
+                    auto insIndex = readFirstOperandAndMoveIP(opCode, ip);
+
+                    auto iterator = static_pointer_cast<Common::IteratorObject>(stack[sp - 1]);
+                    auto step = iterator->next();
+                    advance({std::move(iterator), insIndex}, std::move(step));
+                    break;
+                }
                 case OpCode::CurrentClosure: {
                     auto currentClosure = currentFrame()->closureObject;
                     stackPush(make_shared<ClosureObject>(currentClosure));
@@ -346,6 +528,40 @@ namespace GC {
 
     }
 
+    bool VM::compare(OpCode comparison, Common::GIObject *left, Common::GIObject *right) {
+        std::partial_ordering order = std::partial_ordering::unordered;
+        if (left->getType() == ObjectType::INTEGER && right->getType() == ObjectType::INTEGER) {
+            order = static_cast<Common::IntegerObject *>(left)->value <=> static_cast<Common::IntegerObject *>(right)->value;
+        } else if (isNumberType(left->getType()) && isNumberType(right->getType())) {
+            order = numberCompare(left, right);
+        } else if (left->getType() == ObjectType::BOOLEAN && right->getType() == ObjectType::BOOLEAN &&
+                   (comparison == OpCode::Equal || comparison == OpCode::NotEqual)) {
+            order = static_cast<Common::BooleanObject *>(left)->value <=> static_cast<Common::BooleanObject *>(right)->value;
+        } else {
+            throw VMException{fmt::format("unsupported comparison {} on types: {} {}", magic_enum::enum_name(comparison),
+                                          magic_enum::enum_name(left->getType()),
+                                          magic_enum::enum_name(right->getType()))};
+        }
+        switch (comparison) {
+            case OpCode::Equal:
+                return order == 0;
+            case OpCode::NotEqual:
+                return order != 0;
+            case OpCode::GreaterThan:
+                return order > 0;
+            case OpCode::GreaterEqual:
+                return order >= 0;
+            case OpCode::LessThan:
+                return order < 0;
+            default:
+                return order <= 0;
+        }
+    }
+
+    const shared_ptr<Common::GIObject> &VM::boolObject(bool value) {
+        return value ? trueObject : falseObject;
+    }
+
     void VM::closurePush(int constIndex, int numFree) {
         auto constant = constants[constIndex];
         auto compiledFnObject = dynamic_cast<GC::CompiledFunctionObject *>(constant.get());
@@ -354,13 +570,66 @@ namespace GC {
         }
         vector<shared_ptr<GIObject>> freeObjects{};
         for (auto i = 0; i < numFree; i++) {
-            freeObjects.push_back(stack[sp - numFree + i]);
+            freeObjects.push_back(std::move(stack[sp - numFree + i]));
         }
         sp = sp - numFree;
 
         stackPush(make_shared<ClosureObject>(*compiledFnObject, std::move(freeObjects)));
     }
 
+    void VM::callClosure(ClosureObject *closureObject, int numArgs, std::optional<IteratorDrive> drive) {
+        if (numArgs != closureObject->compiledFunctionObject.numParameters) {
+            throw VMException{"wrong number of arguments"};
+        }
+        auto basePointer = sp - numArgs;
+
+        frameManager.framePush(Frame{*closureObject, basePointer});
+        currentFrame()->drive = std::move(drive);
+        // reserve the slots of the function's locals above its arguments
+        auto localsEnd = basePointer + closureObject->compiledFunctionObject.numLocals;
+        if (localsEnd >= STACK_SIZE) {
+            throw VMException{"Stack overflow"};
+        }
+        if (localsEnd > int(stack.size())) {
+            stack.resize(localsEnd);
+        }
+        sp = localsEnd;
+    }
+
+    void VM::advance(IteratorDrive drive, Common::IteratorStep step) {
+        while (step.kind == Common::IteratorStep::Kind::Call) {
+            auto function = step.value.get();
+            if (function->getType() == ObjectType::BUILTIN) {
+                step = drive.iterator->resume(call(step.value, step.arguments));
+                continue;
+            }
+            if (function->getType() != ObjectType::CLOSURE) {
+                throw VMException{fmt::format("{} is not a function", magic_enum::enum_name(function->getType()))};
+            }
+            auto numArgs = int(step.arguments.size());
+            stackPush(step.value);
+            for (auto &argument: step.arguments) {
+                stackPush(std::move(argument));
+            }
+            callClosure(static_cast<GC::ClosureObject *>(function), numArgs, std::move(drive));
+            return;
+        }
+
+        if (drive.exitTarget >= 0) {
+            if (step.kind == Common::IteratorStep::Kind::Done) {
+                // drop the exhausted iterator and leave the loop
+                stackPop();
+                currentFrame()->ip = drive.exitTarget - 1;
+            } else {
+                stackPush(step.value);
+            }
+        } else if (step.kind == Common::IteratorStep::Kind::Done) {
+            stackPush(make_shared<Common::NullObject>());
+        } else {
+            stackPush(step.value);
+        }
+    }
+
     void VM::stackPush(const shared_ptr<Common::GIObject> &object) {
         if (sp >= STACK_SIZE) {
             throw VMException{"Stack overflow"};
@@ -382,7 +651,26 @@ namespace GC {
 
     shared_ptr<Common::GIObject> VM::stackPop() {
         sp--;
-        return stack[sp];
+        // move out so stale slots above sp don't keep objects alive and shared
+        return std::move(stack[sp]);
+    }
+
+    void VM::stackClear(int newSp) {
+        for (auto index = newSp; index < sp; index++) {
+            stack[index].reset();
+        }
+        sp = newSp;
+    }
+
+    void VM::restoreTakenRoot(shared_ptr<Common::GIObject> root) {
+        auto ip = currentFrame()->ip + 1;
+        auto storeCode = OpCode(getInstructions()[ip]);
+        auto index = readFirstOperand(storeCode, ip);
+        if (storeCode == OpCode::SetGlobal) {
+            globals[index] = std::move(root);
+        } else {
+            stack[currentFrame()->basePointer + index] = std::move(root);
+        }
     }
 
     int VM::readFirstOperand(GC::OpCode opCode, int ip) {
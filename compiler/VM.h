@@ -5,14 +5,20 @@
 #ifndef GOINTERPRETER_VM_H
 #define GOINTERPRETER_VM_H
 
+#include <cstdint>
+#include <stdexcept>
 #include <vector>
+#include "fmt/format.h"
 #include "GIObject.h"
+#include "Builtin.h"
 #include "Code.h"
 #include "Compiler.h"
 #include "Frame.h"
 
 #define STACK_SIZE 1024
 #define GLOBALS_SIZE 65536
+// how deep native code may nest calls back into the vm, e.g. a builtin calling a closure calling a builtin
+#define MAX_NATIVE_CALL_DEPTH 64
 
 namespace GC {
     using namespace std;
@@ -21,25 +27,40 @@ namespace GC {
     class VMException : public std::runtime_error {
     public:
         explicit VMException(const string &msg) : std::runtime_error(msg) {}
+
+        // `run` adds the line of the failing instruction to the errors raised while executing
+        VMException(const string &msg, std::uint32_t line) :
+                std::runtime_error(fmt::format("line {}: {}", line, msg)), line{line} {}
+
+        // source line of the instruction that failed, 0 when unknown
+        std::uint32_t line{0};
     };
 
-    class VM {
+    class VM : public Common::FunctionCaller {
     public:
-        explicit VM(ByteCode byteCode) : constants{byteCode.constants}, frameManager{byteCode.instructions} {
-            stack.reserve(STACK_SIZE);
-            globals.reserve(GLOBALS_SIZE);
-        }
+        explicit VM(ByteCode byteCode);
 
         void run();
 
+        // source line of the instruction being executed, 0 when unknown
+        std::uint32_t currentLine();
+
+        // Re-entrant call for native code: pushes a frame for the closure and runs until that frame returns.
+        // Builtins are called directly.
+        shared_ptr<Common::GIObject> call(const shared_ptr<Common::GIObject> &function,
+                                          Common::BuiltinArguments arguments) override;
+
         shared_ptr<Common::GIObject> lastStackElem();
 
     private:
+        // executes instructions until the frame at baseFrameIndex returns, or the main frame ends
+        void execute(int baseFrameIndex);
+
         Frame *currentFrame() {
             return frameManager.currentFrame();
         }
 
-        Instruction getInstructions() {
+        const Instruction &getInstructions() {
             return frameManager.getInstructions();
         }
 
@@ -47,8 +68,28 @@ namespace GC {
 
         shared_ptr<Common::GIObject> stackPop();
 
+        // drop everything above newSp, used when a frame returns
+        void stackClear(int newSp);
+
         void closurePush(int constIndex, int numFree);
 
+        // pushes the frame of a closure called with the top numArgs stack slots as arguments
+        void callClosure(ClosureObject *closureObject, int numArgs, std::optional<IteratorDrive> drive = std::nullopt);
+
+        // Runs the callbacks the iterator asks for until it produces an element or is exhausted. A closure
+        // callback gets a frame of its own and `run` continues there, the drive is resumed when that frame
+        // returns, so callbacks never re-enter `run`.
+        void advance(IteratorDrive drive, Common::IteratorStep step);
+
+        // Equal, NotEqual, GreaterThan, GreaterEqual, LessThan or LessEqual applied to the operands
+        static bool compare(OpCode comparison, Common::GIObject *left, Common::GIObject *right);
+
+        // booleans are immutable, every true or false on the stack is one of two shared objects
+        const shared_ptr<Common::GIObject> &boolObject(bool value);
+
+        // a failed SetIndex hands the taken root back to the variable named by the store that follows it
+        void restoreTakenRoot(shared_ptr<Common::GIObject> root);
+
         int readFirstOperand(GC::OpCode opCode, int ip);
 
         int readFirstOperandAndMoveIP(OpCode code, int ip);
@@ -59,13 +100,20 @@ namespace GC {
 
         std::vector<shared_ptr<Common::GIObject>> stack{};
         int sp{0};
+        shared_ptr<Common::GIObject> lastPopped{};
         Code code{};
 
         FrameManager frameManager;
 
-        std::map<int, string> builtinIndexMap{{0, "len"}};
+        // one shared object per builtin, GetBuiltin pushes these instead of allocating
+        std::vector<shared_ptr<Common::GIObject>> builtinObjects;
 
         std::vector<shared_ptr<Common::GIObject>> globals;
+
+        int nativeCallDepth{0};
+
+        shared_ptr<Common::GIObject> trueObject{make_shared<Common::BooleanObject>(true)};
+        shared_ptr<Common::GIObject> falseObject{make_shared<Common::BooleanObject>(false)};
     };
 }
 
@@ -45,11 +45,84 @@ TEST_CASE("test compile", "[compiler]") {
                     }},
             {
              "1 < 2",
-                    {2,     1},
+                    {1,     2},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::LessThan),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "1 <= 2",
+                    {1,     2},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::LessEqual),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "1 >= 2",
+                    {1,     2},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::GreaterEqual),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "5 % 2",
+                    {5,     2},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::Mod),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "true && false",
+                    {},
+                    {
+                            // 0000
+                            code.makeInstruction(GC::OpCode::True),
+                            // 0001
+                            code.makeInstruction(GC::OpCode::JumpNotTruthy, {12}),
+                            // 0004
+                            code.makeInstruction(GC::OpCode::False),
+                            // 0005
+                            code.makeInstruction(GC::OpCode::JumpNotTruthy, {12}),
+                            // 0008
+                            code.makeInstruction(GC::OpCode::True),
+                            // 0009
+                            code.makeInstruction(GC::OpCode::Jump, {13}),
+                            // 0012
+                            code.makeInstruction(GC::OpCode::False),
+                            // 0013
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "if (1 < 2 || true) { 10 };",
+                    {1,     2, 10},
                     {
+                            // 0000
                             code.makeInstruction(GC::OpCode::Constant, {0}),
+                            // 0003
                             code.makeInstruction(GC::OpCode::Constant, {1}),
-                            code.makeInstruction(GC::OpCode::GreaterThan),
+                            // 0006
+                            code.makeInstruction(GC::OpCode::JumpIfNotLess, {12}),
+                            // 0009
+                            code.makeInstruction(GC::OpCode::Jump, {16}),
+                            // 0012
+                            code.makeInstruction(GC::OpCode::True),
+                            // 0013
+                            code.makeInstruction(GC::OpCode::JumpNotTruthy, {22}),
+                            // 0016
+                            code.makeInstruction(GC::OpCode::Constant, {2}),
+                            // 0019
+                            code.makeInstruction(GC::OpCode::Jump, {23}),
+                            // 0022
+                            code.makeInstruction(GC::OpCode::_Null),
+                            // 0023
                             code.makeInstruction(GC::OpCode::Pop),
                     }},
             {
@@ -321,6 +394,126 @@ TEST_CASE("test compile", "[compiler]") {
                             code.makeInstruction(GC::OpCode::Pop)
                     }
             },
+            // float
+            {
+             "1.5 + 2.5",
+                    {},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::AddFloat),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            {
+             "1.5 * 2",
+                    {0,     2}, // float constants are not compared
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::Mul),
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }},
+            // index assignment
+            {
+             "let a = [1]; a[0] = 2;",
+                    {1,     0,  2},
+                    {
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            code.makeInstruction(GC::OpCode::Array, {1}),
+                            code.makeInstruction(GC::OpCode::SetGlobal, {0}),
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            code.makeInstruction(GC::OpCode::Constant, {2}),
+                            code.makeInstruction(GC::OpCode::TakeGlobal, {0}),
+                            code.makeInstruction(GC::OpCode::SetIndex, {1}),
+                            code.makeInstruction(GC::OpCode::SetGlobal, {0}),
+                    }
+            },
+            // match
+            {
+             "match (2) { 1 => 10, _ => 20 }",
+                    {2,     0,  10, 20},
+                    {
+                            // 0000
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            // 0003
+                            code.makeInstruction(GC::OpCode::JumpTable, {1}),
+                            // 0006
+                            code.makeInstruction(GC::OpCode::Constant, {2}),
+                            // 0009
+                            code.makeInstruction(GC::OpCode::Jump, {15}),
+                            // 0012
+                            code.makeInstruction(GC::OpCode::Constant, {3}),
+                            // 0015
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }
+            },
+            {
+             R"(match ("a") { "a" => 10 })",
+                    {"a",   0,  10},
+                    {
+                            // 0000
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            // 0003
+                            code.makeInstruction(GC::OpCode::JumpHashTable, {1}),
+                            // 0006
+                            code.makeInstruction(GC::OpCode::Constant, {2}),
+                            // 0009
+                            code.makeInstruction(GC::OpCode::Jump, {13}),
+                            // 0012
+                            code.makeInstruction(GC::OpCode::_Null),
+                            // 0013
+                            code.makeInstruction(GC::OpCode::Pop),
+                    }
+            },
+            // loops
+            {
+             "let i = 0; while (i > 0) { i = i - 1; }",
+                    {0,     0,  1},
+                    {
+                            // 0000
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            // 0003
+                            code.makeInstruction(GC::OpCode::SetGlobal, {0}),
+                            // 0006
+                            code.makeInstruction(GC::OpCode::GetGlobal, {0}),
+                            // 0009
+                            code.makeInstruction(GC::OpCode::Constant, {1}),
+                            // 0012
+                            code.makeInstruction(GC::OpCode::JumpIfNotGreater, {28}),
+                            // 0015
+                            code.makeInstruction(GC::OpCode::GetGlobal, {0}),
+                            // 0018
+                            code.makeInstruction(GC::OpCode::Constant, {2}),
+                            // 0021
+                            code.makeInstruction(GC::OpCode::Sub),
+                            // 0022
+                            code.makeInstruction(GC::OpCode::SetGlobal, {0}),
+                            // 0025
+                            code.makeInstruction(GC::OpCode::Jump, {6}),
+                    }
+            },
+            {
+             "for (x in [1]) { x; }",
+                    {1},
+                    {
+                            // 0000
+                            code.makeInstruction(GC::OpCode::Constant, {0}),
+                            // 0003
+                            code.makeInstruction(GC::OpCode::Array, {1}),
+                            // 0006
+                            code.makeInstruction(GC::OpCode::IterInit),
+                            // 0007
+                            code.makeInstruction(GC::OpCode::IterNext, {20}),
+                            // 0010
+                            code.makeInstruction(GC::OpCode::SetGlobal, {0}),
+                            // 0013
+                            code.makeInstruction(GC::OpCode::GetGlobal, {0}),
+                            // 0016
+                            code.makeInstruction(GC::OpCode::Pop),
+                            // 0017
+                            code.makeInstruction(GC::OpCode::Jump, {7}),
+                    }
+            },
 
 
     };
@@ -677,4 +870,33 @@ TEST_CASE("compile function", "[compiler]") {
     }
 }
 
+TEST_CASE("compile line table", "[compiler]") {
+    Common::Lexer lexer{"let a = 1;\n\nlet f = fn(x) {\n  x +\n    a\n};\nf(2)"};
+    Common::Parser parser{&lexer};
+    auto program = parser.parseProgram();
+    GC::Compiler compiler;
+    compiler.compile(program.get());
+
+    GC::Code code{};
+    auto byteCode = compiler.getByteCode();
+    std::vector<std::uint32_t> lines;
+    for (int ip = 0; ip < int(byteCode.instructions.size()); ip++) {
+        auto opCode = GC::OpCode(byteCode.instructions[ip]);
+        lines.push_back(byteCode.lines.lineAt(ip));
+        for (auto width: code.definitions[opCode].operandWidths) {
+            ip += width;
+        }
+    }
+    // constant and set global, closure and set global, get global, constant, call and pop
+    REQUIRE(lines == std::vector<std::uint32_t>{1, 1, 3, 3, 7, 7, 7, 7});
+    // runs only where the line changes
+    REQUIRE(byteCode.lines.runs.size() == 3);
+
+    auto function = static_cast<GC::CompiledFunctionObject *>(compiler.constants[1].get());
+    // get local x, get global a, add and return
+    REQUIRE(function->lineAt(0) == 4);
+    REQUIRE(function->lineAt(2) == 5);
+    REQUIRE(function->lineAt(5) == 4);
+}
+
 #pragma clang diagnostic pop
@@ -168,7 +168,7 @@ TEST_CASE("test vm array", "[vm]") {
 
         auto arrayObject = static_cast<Common::ArrayObject *>(vm.lastStackElem().get());
         vector<int> result{};
-        std::transform(arrayObject->elements.begin(), arrayObject->elements.end(), back_inserter(result),
+        std::transform(arrayObject->begin(), arrayObject->end(), back_inserter(result),
                        [](const shared_ptr<Common::GIObject> &item) {
                            auto obj = static_cast<Common::IntegerObject *>(item.get());
                            return obj->value;
@@ -281,8 +281,50 @@ TEST_CASE("test vm function", "[vm]") {
             },
             // builtin
             {       R"(len(""))",            0},
+            {       R"(puts("hello"))",      0 // null
+            },
             {       R"(len("four"))",        4},
             {       R"(len("hello world"))", 11},
+            {       R"(len(slice([1, 2, 3, 4], 1, 3)))", 2},
+            {       R"(slice([1, 2, 3, 4], 1)[2])", 4},
+            {       R"(len(substr("hello world", 6)))", 5},
+            {       R"(first(rest(push([1, 2], 3))))", 2},
+            {       R"(last(push([1, 2], 3)))", 3},
+            {       R"(sum(map_add([1, 2, 3], 1)))", 9},
+            {       R"(dot(filter_gt([1, 5, 2, 6], 4), [2, 3]))", 28},
+            {       R"(max(push([1, 2], 7)) - min([4, 3]))", 4},
+            {
+                    R"(let build = fn(arr, n) {
+                        if (n == 0) { return arr; }
+                        build(push(arr, n), n - 1);
+                    };
+                    len(build([], 100));)",
+                                             100
+            },
+            {
+                    R"(let sum = fn(arr) {
+                        if (len(arr) == 0) { return 0; }
+                        arr[0] + sum(slice(arr, 1));
+                    };
+                    sum([1, 2, 3, 4]);)",
+                                             10
+            },
+            // index assignment
+            {       R"(let a = [1, 2, 3]; a[1] = 5; a[1])", 5},
+            {       R"(let a = [1, 2, 3]; let b = a; b[0] = 9; a[0])", 1},
+            {       R"(let a = [1, 2, 3]; let b = a; a[0] = 9; b[0])", 1},
+            {       R"(let a = [1, 2, 3]; a[len(a) - 1] = a[0] + 5; a[2])", 6},
+            {       R"(let f = fn() { let a = [1, 2]; let b = a; a[0] = a[1]; b[0] * 10 + a[0] }; f())", 12},
+            {       R"(let a = [1]; let f = fn() { a }; a[0] = 2; f()[0] * 10 + a[0])", 22},
+            {       R"(let h = {"a": 1}; h["b"] = 2; h["a"] + h["b"])", 3},
+            {       R"(let m = [[1, 2], [3, 4]]; let row = m[1]; m[1][0] = 7; row[0] + m[1][0])", 10},
+            {
+                    R"(let swap = fn(arr) { let tmp = arr[0]; arr[0] = arr[1]; arr[1] = tmp; arr };
+                    let a = [1, 2];
+                    let b = swap(a);
+                    b[0] * 10 + a[0])",
+                                             21
+            },
             {
                     R"(let returnsOne = fn() { 1; };
                     let returnsOneReturner = fn() { returnsOne; };
@@ -322,4 +364,357 @@ TEST_CASE("test vm function", "[vm]") {
     }
 }
 
+TEST_CASE("test vm index assignment errors", "[vm]") {
+    REQUIRE_THROWS_AS(runVM("let a = [1]; a[1] = 2;"), GC::VMException);
+    REQUIRE_THROWS_AS(runVM("let f = fn(a) { fn() { a[0] = 1; } }; f([0])();"), std::string);
+}
+
+TEST_CASE("test vm comparison and logic", "[vm]") {
+    struct TestCase {
+        string input;
+        bool expected;
+    };
+
+    vector<TestCase> cases = {
+            {"1 <= 1",                             true},
+            {"2 <= 1",                             false},
+            {"1 >= 2",                             false},
+            {"2.5 >= 2",                           true},
+            {"1 < 2 && 2 < 3",                     true},
+            {"1 < 2 && 3 < 2",                     false},
+            {"1 > 2 || 2 > 1",                     true},
+            {"false || false",                     false},
+            {"1 && 0",                             true},
+            {"if (1 <= 2 && 2 >= 2) { true } else { false }", true},
+            {"if (1 == 2 || 1 != 1) { true } else { false }", false},
+            {"if (true == true) { true } else { false }",     true},
+            {"let x = 0.0 / 0.0; if (x == x) { true } else { false }", false},
+            {"let x = 0.0 / 0.0; if (x != x) { true } else { false }", true},
+            {"7 % 3 == 1 && -7 % 3 == -1",         true},
+            {"7.5 % 2 == 1.5",                     true},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::BOOLEAN);
+        REQUIRE(static_cast<Common::BooleanObject *>(vm.lastStackElem().get())->value == testCase.expected);
+    }
+
+    // the right operand is skipped once the left one decides the result
+    auto vm = runVM("let a = [0]; let f = fn() { a[0] = 1; true }; false && f(); true || f(); a[0]");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 0);
+    // operands are evaluated left to right
+    vm = runVM("let a = [0]; let f = fn(v) { a[0] = a[0] * 10 + v; v }; f(1) < f(2); a[0]");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 12);
+    vm = runVM("let i = 0; let n = 0; while (i < 100 && n >= 0) { if (i % 2 == 0) { n = n + i; } i = i + 1; } n");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 2450);
+
+    REQUIRE_THROWS_AS(runVM("1 % 0"), GC::VMException);
+    REQUIRE_THROWS_AS(runVM("true > false"), GC::VMException);
+    REQUIRE_THROWS_AS(runVM("if (true < false) { 1 }"), GC::VMException);
+}
+
+TEST_CASE("test vm match", "[vm]") {
+    struct TestCase {
+        string input;
+        int expected;
+    };
+
+    vector<TestCase> cases = {
+            {"match (2) { 1 => 10, 2 => 20, _ => 30 }",                          20},
+            {"match (5) { 1 => 10, 2 => 20, _ => 30 }",                          30},
+            {"match (0) { 1 => 10, 2 => 20, _ => 30 }",                          30},
+            {"match (-3) { 1, -3 => 10, _ => 30 }",                              10},
+            {"match (1000) { 1 => 10, 1000 => 20, _ => 30 }",                    20},
+            {R"(match ("b") { "a" => 1, "b" => { let x = 2; x * 3 } })",         6},
+            {R"(match ("c") { "a" => 1, "b" => 2, _ => 3 })",                    3},
+            {"match (1) { _ => 0, 1 => 1 }",                                     1},
+            {"match (1) { 1 => 1, 1 => 2 }",                                     1},
+            {"match (true) { 1 => 1, true => 2 }",                               2},
+            {"match (2.5) { 2.5 => 1, _ => 2 }",                                 1},
+            {"match ([1]) { 1 => 1, _ => 2 }",                                   2},
+            {"let f = fn(x) { match (x % 3) { 0 => { return 0; }, _ => 1 }; 2 }; f(3) + f(4)", 2},
+            {"let n = 0; for (x in [0, 1, 2, 1]) { n = n + match (x) { 0 => 1, 1 => 10, 2 => 100 }; } n", 121},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::INTEGER);
+        REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == testCase.expected);
+    }
+
+    auto vm = runVM("match (3) { 1 => 1 }");
+    REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::_NULL);
+    // equal values of different types don't match
+    vm = runVM("match (1.0) { 1 => 1 }");
+    REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::_NULL);
+    REQUIRE_THROWS_AS(runVM("1 + match (3) { 1 => 1 }"), GC::VMException);
+}
+
+TEST_CASE("test vm loops", "[vm]") {
+    struct TestCase {
+        string input;
+        int expected;
+    };
+
+    vector<TestCase> cases = {
+            {"let i = 0; while (i < 10) { i = i + 1; } i",                                   10},
+            {"let i = 0; while (false) { i = 1; } i",                                        0},
+            {"let sum = 0; for (x in [1, 2, 3]) { sum = sum + x; } sum",                     6},
+            {"let sum = 0; for (x in []) { sum = 1; } sum",                                  0},
+            {"let f = fn() { let i = 0; while (true) { if (i == 5) { return i; } i = i + 1; } }; f()", 5},
+            {"let f = fn(arr) { for (x in arr) { if (x > 1) { return x; } } 0 }; f([1, 5, 2])", 5},
+            {"let f = fn(arr) { let sum = 0; for (x in arr) { for (y in arr) { sum = sum + x * y; } } sum }; f([1, 2])", 9},
+            {"let a = [1, 2, 3]; let sum = 0; for (x in a) { a[0] = 10; sum = sum + x; } sum + a[0]", 16},
+            {"let x = if (true) { let y = 1; }; if (x) { 2 } else { 1 }",                  1},
+            {"let i = 0; let n = 0; while (i < 100000) { i = i + 1; n = n + 2; } n",         200000},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        auto integerObject = static_cast<Common::IntegerObject *>(vm.lastStackElem().get());
+        REQUIRE(integerObject->value == testCase.expected);
+    }
+
+    // a long loop over an array keeps the stack flat
+    auto vm = runVM("let a = []; let i = 0; while (i < 5000) { a = push(a, i); i = i + 1; } "
+                    "let sum = 0; for (x in a) { sum = sum + x; } sum");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 12497500);
+
+    REQUIRE_THROWS_AS(runVM("for (x in 1) { x }"), GC::VMException);
+    REQUIRE_THROWS_AS(runVM("let f = fn(a) { fn() { a = 1; } }; f(0)();"), std::string);
+}
+
+TEST_CASE("test vm lazy iterators", "[vm]") {
+    struct TestCase {
+        string input;
+        int expected;
+    };
+
+    vector<TestCase> cases = {
+            {"reduce(range(5), fn(a, b) { a + b }, 0)",                                          10},
+            {"reduce(imap(ifilter(range(10), fn(x) { x % 2 == 0 }), fn(x) { x * x }), fn(a, b) { a + b }, 0)", 120},
+            {"let s = 0; for (x in take(imap(range(1, 100), fn(x) { x * 3 }), 4)) { s = s + x; } s", 30},
+            {"let s = 0; for (x in range(10, 0, -3)) { s = s + x; } s",                          22},
+            {R"(reduce(imap(["a", "bb", ""], len), fn(a, b) { a + b }, 0))",                     3},
+            {"len(collect(ifilter(range(5), fn(x) { false })))",                                 0},
+            {"collect(imap([1, 2, 3], fn(x) { x + 1 }))[2]",                                     4},
+            {"reduce([], fn(a, b) { a }, 7)",                                                    7},
+            {"let it = range(3); let a = collect(it); len(a) + len(collect(it))",                3},
+            // callbacks that drive iterators of their own
+            {"let f = fn(x) { reduce(range(x), fn(a, b) { a + b }, 0) }; reduce(imap(range(4), f), fn(a, b) { a + b }, 0)", 4},
+            {"let f = fn() { for (x in imap(range(10), fn(x) { x * 2 })) { if (x > 5) { return x; } } }; f()", 6},
+            {"len(collect(imap([[1], [2, 3]], collect))[1])",                                    2},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        auto integerObject = static_cast<Common::IntegerObject *>(vm.lastStackElem().get());
+        REQUIRE(integerObject->value == testCase.expected);
+    }
+
+    // a million element pipeline runs without materializing arrays or growing the stack
+    auto vm = runVM("reduce(ifilter(imap(range(1000000), fn(x) { x * 2 }), fn(x) { x % 3 == 0 }), "
+                    "fn(a, b) { a + 1 }, 0)");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 333334);
+
+    REQUIRE_THROWS_AS(runVM("collect(imap(range(2), fn(a, b) { a }))"), GC::VMException);
+}
+
+TEST_CASE("test vm native calls", "[vm]") {
+    struct TestCase {
+        string input;
+        int expected;
+    };
+
+    vector<TestCase> cases = {
+            {"map([1, 2, 3], fn(x) { x * 2 })[2]",                                              6},
+            {"let k = 10; map([1, 2], fn(x) { x + k })[1]",                                     12},
+            {R"(map(["a", "bb"], len)[1])",                                                     2},
+            {"map([[1], [2, 3]], fn(a) { sum(map(a, fn(x) { x * x })) })[1]",                   13},
+            {"len(map([], fn(x) { x }))",                                                       0},
+            // a callback that returns early and one that drives a lazy iterator
+            {"map([1, 5], fn(x) { if (x > 2) { return 0; } x })[1]",                            0},
+            {"map([4], fn(n) { reduce(range(n), fn(a, b) { a + b }, 0) })[0]",                  6},
+            {"let depth = fn(n) { if (n == 0) { return 0; } map([n - 1], depth)[0] + 1 }; depth(60)", 60},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        auto integerObject = static_cast<Common::IntegerObject *>(vm.lastStackElem().get());
+        REQUIRE(integerObject->value == testCase.expected);
+    }
+
+    // the stack is balanced after native calls
+    auto vm = runVM("let a = map([1, 2, 3], fn(x) { let y = x + 1; y }); let b = 7; b + a[0]");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 9);
+
+    REQUIRE_THROWS_AS(runVM("let depth = fn(n) { if (n == 0) { return 0; } map([n - 1], depth)[0] + 1 }; depth(100)"),
+                      GC::VMException);
+    REQUIRE_THROWS_AS(runVM("map([1], fn(a, b) { a })"), GC::VMException);
+
+    // a callback that throws leaves the native call depth as it was
+    auto sorter = runVM("fn(a) { sort(a, fn(x, y) { x / 0 }) }");
+    auto function = sorter.lastStackElem();
+    vector<shared_ptr<Common::GIObject>> arguments{runVM("[2, 1]").lastStackElem()};
+    for (auto i = 0; i <= MAX_NATIVE_CALL_DEPTH; i++) {
+        REQUIRE_THROWS_WITH(sorter.call(function, arguments), Catch::Matchers::EndsWith("division by zero"));
+    }
+
+    // a failed index assignment leaves its variable in place
+    auto assigner = runVM("let a = [1]; let g = fn() { len(a) }; let f = fn() { a[9] = 1 }; [f, g]");
+    auto functions = static_cast<Common::ArrayObject *>(assigner.lastStackElem().get());
+    REQUIRE_THROWS_WITH(assigner.call(functions->at(0), {}), Catch::Matchers::EndsWith("array index out of range: 9"));
+    REQUIRE(assigner.call(functions->at(1), {})->inspect() == "1");
+}
+
+TEST_CASE("test vm sort", "[vm]") {
+    struct TestCase {
+        string input;
+        string expected;
+    };
+
+    vector<TestCase> cases = {
+            {"sort([3, 1, 2])",                                  "[1, 2, 3, ]"},
+            {R"(sort(["b", "c", "a"]))",                         "[a, b, c, ]"},
+            {"sort([2.5, 1, -3])",                               "[-3, 1, 2.5, ]"},
+            {"sort([3, 1, 2], fn(a, b) { a > b })",              "[3, 2, 1, ]"},
+            {"let by = fn(key) { fn(a, b) { a[key] < b[key] } }; sort([[2, 0], [1, 1]], by(1))", "[[2, 0, ], [1, 1, ], ]"},
+            {"let a = [2, 1]; let b = sort(a); a",               "[2, 1, ]"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(runVM(testCase.input).lastStackElem()->inspect() == testCase.expected);
+    }
+
+    // large enough to take the parallel path
+    auto vm = runVM("let a = []; let i = 0; while (i < 100000) { a = push(a, (i * 7919) % 100003); i = i + 1; } "
+                    "let s = sort(a); let ok = true; i = 1; "
+                    "while (i < 100000) { if (s[i - 1] > s[i]) { ok = false; } i = i + 1; } ok");
+    REQUIRE(static_cast<Common::BooleanObject *>(vm.lastStackElem().get())->value);
+
+    REQUIRE(runVM("sort([1, true])").lastStackElem()->getType() == Common::ObjectType::ERROR);
+    REQUIRE_THROWS_AS(runVM("sort([1, 2], fn(a, b) { a + true })"), GC::VMException);
+}
+
+TEST_CASE("test vm string builtins", "[vm]") {
+    struct TestCase {
+        string input;
+        string expected;
+    };
+
+    vector<TestCase> cases = {
+            {R"(split("x -> y -> z", " -> "))",                  "[x, y, z, ]"},
+            {R"(join(split("a b c", " "), "-"))",                "a-b-c"},
+            {R"(replace("a.b.c", ".", "::"))",                   "a::b::c"},
+            {"trim(\"  \t padded \n\")",                     "padded"},
+            {R"(let s = "hello"; s[0] + s[4])",                  "ho"},
+            {R"(find("error: disk full", "disk"))",              "7"},
+            {R"(contains("error: disk full", "full"))",          "1"},
+            // a small log line filter
+            {"let lines = split(\"ok a\nerror b\nok c\nerror d\", \"\n\"); "
+             R"(join(map(collect(ifilter(lines, fn(l) { contains(l, "error") })), fn(l) { split(l, " ")[1] }), ","))",
+             "b,d"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(runVM(testCase.input).lastStackElem()->inspect() == testCase.expected);
+    }
+    REQUIRE(runVM(R"("abc"[5])").lastStackElem()->getType() == Common::ObjectType::_NULL);
+}
+
+TEST_CASE("test vm string builder", "[vm]") {
+    struct TestCase {
+        string input;
+        string expected;
+    };
+
+    vector<TestCase> cases = {
+            {R"(let b = builder(); append(b, "n = ", 42, ", x = ", -7); build(b))",  "n = 42, x = -7"},
+            {R"(let b = builder(); let c = b; append(c, "x"); build(b))",          "x"},
+            {R"(let f = fn(b, n) { append(b, "<", n, ">") }; let b = builder(); f(b, 1); f(b, 2); build(b))",
+             "<1><2>"},
+            {"build(append(builder(), 9223372036854775807, \" \", -9223372036854775807 - 1))",
+             "9223372036854775807 -9223372036854775808"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(runVM(testCase.input).lastStackElem()->inspect() == testCase.expected);
+    }
+
+    auto vm = runVM("let b = builder(); let i = 0; while (i < 10000) { append(b, i, \",\"); i = i + 1; } "
+                    "len(build(b))");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 48890);
+}
+
+TEST_CASE("test vm float", "[vm]") {
+    struct TestCase {
+        string input;
+        double expected;
+    };
+
+    vector<TestCase> cases = {
+            {"1.5 + 2.25",                    3.75},
+            {"1.5 - 2.25 * 2.0",              -3},
+            {"10.0 / 4.0",                    2.5},
+            {"1 + 0.5",                       1.5},
+            {"let x = 2; x * 1.25",           2.5},
+            {"-sqrt(2.25) + floor(2.5)",      0.5},
+            {"pow(3, 2) + 0.5",               9.5},
+            {"sqrt([1, 4, 9])[2] * 2.0",      6},
+    };
+    for (auto &testCase: cases) {
+        auto vm = runVM(testCase.input);
+        REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::FLOAT);
+        REQUIRE(static_cast<Common::FloatObject *>(vm.lastStackElem().get())->value == testCase.expected);
+    }
+
+    auto vm = runVM("1 < 1.5 == true");
+    REQUIRE(static_cast<Common::BooleanObject *>(vm.lastStackElem().get())->value);
+
+    // a math builtin called with the wrong arity returns an error, not a float
+    for (auto input: {"sqrt(1, 2) + 1.0", "sqrt() + 1.0", "pow(2) + 1.0"}) {
+        REQUIRE_THROWS_WITH(runVM(input), Catch::Matchers::EndsWith("unsupported types for binary operation: ERROR FLOAT"));
+    }
+}
+
+TEST_CASE("test vm integer overflow", "[vm]") {
+    auto vm = runVM("9223372036854775807 + 1");
+    REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::BIG_INTEGER);
+    REQUIRE(vm.lastStackElem()->inspect() == "9223372036854775808");
+
+    vm = runVM("let big = 4294967296 * 4294967296; -big / 4294967296");
+    auto integerObject = static_cast<Common::IntegerObject *>(vm.lastStackElem().get());
+    REQUIRE(integerObject->value == -4294967296);
+
+    // literals that don't fit into an int64
+    vm = runVM("99999999999999999999 + 1");
+    REQUIRE(vm.lastStackElem()->getType() == Common::ObjectType::BIG_INTEGER);
+    REQUIRE(vm.lastStackElem()->inspect() == "100000000000000000000");
+    vm = runVM("-9223372036854775808");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == INT64_MIN);
+    vm = runVM("match (9223372036854775808) { 9223372036854775808 => 1, _ => 2 }");
+    REQUIRE(static_cast<Common::IntegerObject *>(vm.lastStackElem().get())->value == 1);
+
+    // the integer array builtins promote like +
+    vm = runVM("sum([9223372036854775807, 1])");
+    REQUIRE(vm.lastStackElem()->inspect() == "9223372036854775808");
+    vm = runVM("let a = []; let i = 0; while (i < 40) { a = push(a, 9223372036854775807); i = i + 1; } "
+               "sum(a) == 40 * 9223372036854775807");
+    REQUIRE(static_cast<Common::BooleanObject *>(vm.lastStackElem().get())->value);
+    vm = runVM("dot([4294967296, 1], [4294967296, 1])");
+    REQUIRE(vm.lastStackElem()->inspect() == "18446744073709551617");
+
+    vm = runVM("let fact = fn(n) { if (n == 0) { return 1; } n * fact(n - 1) }; fact(25)");
+    REQUIRE(vm.lastStackElem()->inspect() == "15511210043330985984000000");
+
+    REQUIRE_THROWS_AS(runVM("1 / 0"), GC::VMException);
+}
+
+TEST_CASE("test vm error lines", "[vm]") {
+    auto lineOf = [](const string &input) -> std::uint32_t {
+        try {
+            runVM(input);
+        } catch (const GC::VMException &exception) {
+            return exception.line;
+        }
+        return 0;
+    };
+    REQUIRE(lineOf("let a = 1;\nlet b = a % 0;") == 2);
+    REQUIRE(lineOf("let f = fn(x) {\n  x / 0\n};\nf(1)") == 2);
+    REQUIRE_THROWS_WITH(runVM("1;\n\n1 / 0"), Catch::Matchers::StartsWith("line 3: "));
+}
+
 #pragma clang diagnostic pop
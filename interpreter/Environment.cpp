@@ -5,14 +5,23 @@
 #include "Environment.h"
 
 namespace Common {
-    void Environment::setValue(std::string name, std::shared_ptr<GIObject> value) {
-        store[name] = std::move(value);
+    void Environment::setValue(SymbolId name, std::shared_ptr<GIObject> value) {
+        define(0, name) = std::move(value);
     }
 
-    std::shared_ptr<GIObject> Environment::getValue(std::string name) {
-        if (store.contains(name)) {
-            return store[name];
+    std::shared_ptr<GIObject> Environment::getValue(SymbolId name) {
+        auto slot = find(0, name);
+        return slot != nullptr ? *slot : nullptr;
+    }
+
+    std::shared_ptr<GIObject> &Environment::define(std::uint32_t depth, std::uint32_t slot) {
+        auto environment = this;
+        for (; depth != 0; depth--) {
+            environment = environment->outer.get();
+        }
+        if (slot >= environment->values.size()) {
+            environment->values.resize(slot + 1);
         }
-        return outer != nullptr ? outer->getValue(name) : nullptr;
+        return environment->values[slot];
     }
 }
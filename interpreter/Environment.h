@@ -5,24 +5,41 @@
 #ifndef GOINTERPRETER_ENVIRONMENT_H
 #define GOINTERPRETER_ENVIRONMENT_H
 
+#include <cstdint>
 #include <vector>
 #include "GIObject.h"
+#include "Symbol.h"
 
 namespace Common {
     class GIObject;
 
+    // Bindings live in slots. A call gets an environment with one slot per parameter and local of the function, the
+    // global environment is indexed by symbol and grows as globals are defined. A slot holding nullptr is unbound.
     class Environment {
     public:
-        Environment(std::shared_ptr<Environment> outer) : outer{std::move(outer)} {}
+        Environment(std::size_t slots, std::shared_ptr<Environment> outer) : outer{std::move(outer)}, values(slots) {}
 
         Environment() : outer{nullptr} {}
 
-        void setValue(std::string name, std::shared_ptr<GIObject> value);
+        // global bindings
+        void setValue(SymbolId name, std::shared_ptr<GIObject> value);
 
-        std::shared_ptr<GIObject> getValue(std::string name);
+        std::shared_ptr<GIObject> getValue(SymbolId name);
+
+        // slot `depth` environments up, nullptr when a global environment hasn't grown to it yet
+        std::shared_ptr<GIObject> *find(std::uint32_t depth, std::uint32_t slot) {
+            auto environment = this;
+            for (; depth != 0; depth--) {
+                environment = environment->outer.get();
+            }
+            return slot < environment->values.size() ? &environment->values[slot] : nullptr;
+        }
+
+        // like find, but grows the global environment to the slot
+        std::shared_ptr<GIObject> &define(std::uint32_t depth, std::uint32_t slot);
 
         std::shared_ptr<Environment> outer;
-        std::map<std::string, std::shared_ptr<GIObject>> store;
+        std::vector<std::shared_ptr<GIObject>> values;
 
     };
 }
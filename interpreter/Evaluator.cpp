@@ -8,6 +8,8 @@
 
 #include "Evaluator.h"
 #include "InterpreterObject.h"
+#include "Resolver.h"
+#include "Arithmetic.h"
 #include "fmt/format.h"
 #include "magic_enum.hpp"
 #include <typeindex>
@@ -47,6 +49,7 @@ namespace GI {
     std::shared_ptr<GIObject> evalProgram(Program *program,
                                           const std::shared_ptr<Environment> &environment
     ) {
+        resolve(program);
         std::shared_ptr<GIObject> result;
         for (auto &stmt: program->statements) {
             result = eval(stmt.get(), environment);
@@ -65,94 +68,103 @@ namespace GI {
         return std::make_unique<BooleanObject>(!isTruthy(object.get()));
     }
 
-    std::unique_ptr<GIObject> evalMinusPrefixOperatorExpression(const std::shared_ptr<GIObject> &object) {
-        if (object->getType() != ObjectType::INTEGER) {
+    std::shared_ptr<GIObject> evalMinusPrefixOperatorExpression(const std::shared_ptr<GIObject> &object) {
+        if (!isNumberType(object->getType())) {
             return std::make_unique<ErrorObject>(
                     fmt::format("unknown operator: -{}", magic_enum::enum_name(object->getType())));
         }
-        auto integerObject = static_cast<IntegerObject *>(object.get());
-        return std::make_unique<IntegerObject>(-integerObject->value);
+        return numberNegate(object.get());
     }
 
-    std::unique_ptr<GIObject>
-    evalPrefixExpression(const std::string &prefixOperator, const std::shared_ptr<GIObject> &right) {
-        if (prefixOperator == "!") {
-            return evalBangOperatorExpression(right);
-        } else if (prefixOperator == "-") {
-            return evalMinusPrefixOperatorExpression(right);
-        } else {
-            return std::make_unique<ErrorObject>(
-                    fmt::format("unknown operator: {}{}", prefixOperator, magic_enum::enum_name(right->getType())));
+    std::shared_ptr<GIObject>
+    evalPrefixExpression(PrefixOperator prefixOperator, const std::shared_ptr<GIObject> &right) {
+        switch (prefixOperator) {
+            case PrefixOperator::Bang:
+                return evalBangOperatorExpression(right);
+            case PrefixOperator::Minus:
+                return evalMinusPrefixOperatorExpression(right);
         }
+        return std::make_unique<ErrorObject>(
+                fmt::format("unknown operator: {}{}", operatorSymbol(prefixOperator),
+                            magic_enum::enum_name(right->getType())));
     }
 
     std::unique_ptr<GIObject>
-    evalStringInfixExpression(const std::string &infixOperator, const std::shared_ptr<GIObject> &left,
+    evalStringInfixExpression(InfixOperator infixOperator, const std::shared_ptr<GIObject> &left,
                               const std::shared_ptr<GIObject> &right) {
 
         auto leftString = static_cast<StringObject *>(left.get());
         auto rightString = static_cast<StringObject *>(right.get());
-        if (infixOperator == "+") {
-            return std::make_unique<StringObject>(leftString->value + rightString->value);
+        if (infixOperator == InfixOperator::Add) {
+            std::string value;
+            value.reserve(leftString->value.size() + rightString->value.size());
+            value.append(leftString->value).append(rightString->value);
+            return std::make_unique<StringObject>(std::move(value));
         } else {
             std::stringstream ss;
             ss << "unknown infix operator with string: ";
             ss << leftString->value << " ";
-            ss << infixOperator << " ";
+            ss << operatorSymbol(infixOperator) << " ";
             ss << rightString->value;
             return makeErrorObject(ss.str());
         }
     }
 
     std::shared_ptr<GIObject>
-    evalIntegerInfixExpression(const std::string &infixOperator, const std::shared_ptr<GIObject> &left,
+    evalIntegerInfixExpression(InfixOperator infixOperator, const std::shared_ptr<GIObject> &left,
                                const std::shared_ptr<GIObject> &right) {
-        auto leftInt = static_cast<IntegerObject *>(left.get());
-        auto rightInt = static_cast<IntegerObject *>(right.get());
-
-        if (infixOperator == "+") {
-            return std::make_unique<IntegerObject>(leftInt->value + rightInt->value);
-        } else if (infixOperator == "-") {
-            return std::make_unique<IntegerObject>(leftInt->value - rightInt->value);
-        } else if (infixOperator == "*") {
-            return std::make_unique<IntegerObject>(leftInt->value * rightInt->value);
-        } else if (infixOperator == "/") {
-            return std::make_unique<IntegerObject>(leftInt->value / rightInt->value);
-        } else if (infixOperator == "<") {
-            return makeBoolObject(leftInt->value < rightInt->value);
-        } else if (infixOperator == ">") {
-            return makeBoolObject(leftInt->value > rightInt->value);
-        } else if (infixOperator == "==") {
-            return makeBoolObject(leftInt->value == rightInt->value);
-        } else if (infixOperator == "!=") {
-            return makeBoolObject(leftInt->value != rightInt->value);
-        } else {
-            std::stringstream ss;
-            ss << "unknown infix operator with integer: ";
-            ss << leftInt->value << " ";
-            ss << infixOperator << " ";
-            ss << rightInt->value;
-            return makeErrorObject(ss.str());
+        // dense enum, compiled to a jump table
+        switch (infixOperator) {
+            case InfixOperator::Add:
+                return numberArithmetic(ArithmeticOperator::Add, left.get(), right.get());
+            case InfixOperator::Sub:
+                return numberArithmetic(ArithmeticOperator::Sub, left.get(), right.get());
+            case InfixOperator::Mul:
+                return numberArithmetic(ArithmeticOperator::Mul, left.get(), right.get());
+            case InfixOperator::Div:
+                return numberArithmetic(ArithmeticOperator::Div, left.get(), right.get());
+            case InfixOperator::Mod:
+                return numberArithmetic(ArithmeticOperator::Mod, left.get(), right.get());
+            case InfixOperator::Less:
+                return makeBoolObject(numberCompare(left.get(), right.get()) < 0);
+            case InfixOperator::Greater:
+                return makeBoolObject(numberCompare(left.get(), right.get()) > 0);
+            case InfixOperator::LessEqual:
+                return makeBoolObject(numberCompare(left.get(), right.get()) <= 0);
+            case InfixOperator::GreaterEqual:
+                return makeBoolObject(numberCompare(left.get(), right.get()) >= 0);
+            case InfixOperator::Equal:
+                return makeBoolObject(numberCompare(left.get(), right.get()) == 0);
+            case InfixOperator::NotEqual:
+                return makeBoolObject(numberCompare(left.get(), right.get()) != 0);
+            default: {
+                std::stringstream ss;
+                ss << "unknown infix operator with integer: ";
+                ss << left->inspect() << " ";
+                ss << operatorSymbol(infixOperator) << " ";
+                ss << right->inspect();
+                return makeErrorObject(ss.str());
+            }
         }
     }
 
     std::shared_ptr<GIObject>
-    evalInfixExpression(const std::string &infixOperator, const std::shared_ptr<GIObject> &left,
+    evalInfixExpression(InfixOperator infixOperator, const std::shared_ptr<GIObject> &left,
                         const std::shared_ptr<GIObject> &right) {
+        if (isNumberType(left->getType()) && isNumberType(right->getType())) {
+            return evalIntegerInfixExpression(infixOperator, left, right);
+        }
         if (left->getType() != right->getType()) {
             return std::make_unique<ErrorObject>(
-                    fmt::format("type mismatch: {} {} {}", magic_enum::enum_name(left->getType()), infixOperator,
-                                magic_enum::enum_name(right->getType())));
+                    fmt::format("type mismatch: {} {} {}", magic_enum::enum_name(left->getType()),
+                                operatorSymbol(infixOperator), magic_enum::enum_name(right->getType())));
         }
         switch (left->getType()) {
-            case ObjectType::INTEGER:
-                return evalIntegerInfixExpression(infixOperator, left, right);
-
             case ObjectType::BOOLEAN: {
-                if (infixOperator == "==") {
+                if (infixOperator == InfixOperator::Equal) {
                     return makeBoolObject(static_cast<BooleanObject *>(left.get())->value ==
                                           static_cast<BooleanObject *>(right.get())->value);
-                } else if (infixOperator == "!=") {
+                } else if (infixOperator == InfixOperator::NotEqual) {
                     return makeBoolObject(static_cast<BooleanObject *>(left.get())->value !=
                                           static_cast<BooleanObject *>(right.get())->value);
                 } else {
@@ -160,9 +172,9 @@ namespace GI {
                 }
             }
             case ObjectType::_NULL: {
-                if (infixOperator == "==") {
+                if (infixOperator == InfixOperator::Equal) {
                     return makeBoolObject(true);
-                } else if (infixOperator == "!=") {
+                } else if (infixOperator == InfixOperator::NotEqual) {
                     return makeBoolObject(false);
                 } else {
                     break;
@@ -176,8 +188,8 @@ namespace GI {
         }
         return makeErrorObject(
                 fmt::format(
-                        "unknown operator: {} {} {}", magic_enum::enum_name(left->getType()), infixOperator,
-                        magic_enum::enum_name(right->getType())));
+                        "unknown operator: {} {} {}", magic_enum::enum_name(left->getType()),
+                        operatorSymbol(infixOperator), magic_enum::enum_name(right->getType())));
     }
 
     std::shared_ptr<GIObject> evalIfExpression(IfExpression *node, const std::shared_ptr<Environment> &environment) {
@@ -194,13 +206,115 @@ namespace GI {
     }
 
 
+    std::shared_ptr<GIObject> evalMatchExpression(MatchExpression *node, const std::shared_ptr<Environment> &environment) {
+        auto subject = eval(node->subject.get(), environment);
+        if (isError(subject.get())) {
+            return subject;
+        }
+        BlockStatement *defaultBody = nullptr;
+        for (auto &arm: node->arms) {
+            if (arm.patterns.empty()) {
+                defaultBody = defaultBody == nullptr ? arm.body.get() : defaultBody;
+                continue;
+            }
+            for (auto &pattern: arm.patterns) {
+                auto value = eval(pattern.get(), environment);
+                if (isError(value.get())) {
+                    return value;
+                }
+                if (valueEquals(subject.get(), value.get())) {
+                    return eval(arm.body.get(), environment);
+                }
+            }
+        }
+        if (defaultBody != nullptr) {
+            return eval(defaultBody, environment);
+        }
+        return nullptr;
+    }
+
+    bool isBlockInterrupted(const std::shared_ptr<GIObject> &result) {
+        return result != nullptr &&
+               (result->getType() == ObjectType::RETURN_VALUE || result->getType() == ObjectType::ERROR);
+    }
+
+    std::shared_ptr<GIObject> evalWhileStatement(WhileStatement *node, const std::shared_ptr<Environment> &environment) {
+        while (true) {
+            auto condition = eval(node->condition.get(), environment);
+            if (isError(condition.get())) {
+                return condition;
+            }
+            if (!isTruthy(condition.get())) {
+                return nullptr;
+            }
+            auto result = evalBlockStatement(node->body.get(), environment);
+            if (isBlockInterrupted(result)) {
+                return result;
+            }
+        }
+    }
+
+    std::shared_ptr<GIObject> applyFunction(GIObject *function, std::vector<std::shared_ptr<GIObject>> args);
+
+    // builtins call back into Monkey functions through the evaluator
+    struct EvaluatorCaller : FunctionCaller {
+        std::shared_ptr<GIObject> call(const std::shared_ptr<GIObject> &function, // NOLINT(misc-no-recursion)
+                                       BuiltinArguments arguments) override {
+            auto result = applyFunction(function.get(), {arguments.begin(), arguments.end()});
+            return result != nullptr ? result : std::make_shared<NullObject>();
+        }
+    };
+
+    // runs the functions the iterator asks for until it produces an element or is exhausted. An error
+    // returned by one of those functions comes back as the element.
+    IteratorStep driveIterator(IteratorObject *iterator, IteratorStep step) { // NOLINT(misc-no-recursion)
+        while (step.kind == IteratorStep::Kind::Call) {
+            auto result = applyFunction(step.value.get(), std::move(step.arguments));
+            if (isError(result.get())) {
+                return IteratorStep::element(std::move(result));
+            }
+            step = iterator->resume(result != nullptr ? std::move(result) : std::make_shared<NullObject>());
+        }
+        return step;
+    }
+
+    std::shared_ptr<GIObject> evalForStatement(ForStatement *node, const std::shared_ptr<Environment> &environment) {
+        auto iterable = eval(node->iterable.get(), environment);
+        if (isError(iterable.get())) {
+            return iterable;
+        }
+        auto iterator = makeIterator(iterable);
+        if (iterator == nullptr) {
+            return makeErrorObject(fmt::format("cannot iterate over {}", magic_enum::enum_name(iterable->getType())));
+        }
+        iterable.reset();
+        while (true) {
+            auto step = driveIterator(iterator.get(), iterator->next());
+            if (step.kind == IteratorStep::Kind::Done) {
+                return nullptr;
+            }
+            if (isError(step.value.get())) {
+                return step.value;
+            }
+            environment->define(node->variable->depth, node->variable->slot) = std::move(step.value);
+            auto result = evalBlockStatement(node->body.get(), environment);
+            if (isBlockInterrupted(result)) {
+                return result;
+            }
+        }
+    }
+
     std::shared_ptr<GIObject>
     evalIdentifierExpression(Identifier *node, const std::shared_ptr<Environment> &environment) {
-        auto value = environment->getValue(node->value);
-        if (value == nullptr) {
-            return makeErrorObject("identifier not found: " + node->value);
+        if (auto slot = environment->find(node->depth, node->slot); slot != nullptr && *slot != nullptr) {
+            return *slot;
+        }
+        // builtins are values too, e.g. imap(array, len). Their names are interned first, the symbol of a
+        // builtin name is its index.
+        if (auto builtins = builtinDefinitions(); node->symbol < builtins.size()) {
+            return std::make_shared<BuiltinFunctionObject>(int(node->symbol), builtins[node->symbol].name);
         }
-        return value;
+        return makeErrorObject(fmt::format("identifier not found: {}", node->token.literal));
     }
 
     std::vector<std::shared_ptr<GIObject>>
@@ -217,64 +331,73 @@ namespace GI {
         return args;
     }
 
-    std::shared_ptr<GIObject> evalCallExpression(CallExpression *node, std::shared_ptr<Environment> environment) {
-        auto evalFunction = [&]( // NOLINT(misc-no-recursion)
-                FunctionObject *functionObject) -> std::shared_ptr<GIObject> {
-            auto args = evalFunctionArguments(node, environment);
-
-            Environment env{functionObject->environment};
-            if (functionObject->parameters.size() != args.size()) {
-                return makeErrorObject("unexpected call arguments size");
-            }
-            for (int i = 0; i < functionObject->parameters.size(); i++) {
-                env.setValue(functionObject->parameters[i]->value, std::move(args[i]));
-            }
-
-            auto result = eval(functionObject->body.get(), std::make_shared<Environment>(env));
-            if (result->getType() == ObjectType::RETURN_VALUE) {
-                return result;
-            }
-            return result;
-        };
-        // iife
-        if (node->name->getType() != NodeType::Identifier) {
-            auto object = eval(node->name.get(), environment);
-            if (isError(object.get())) {
-                return object;
-            } else if (object->getType() != ObjectType::FUNCTION) {
-                return makeErrorObject("unexpected call expression name");
-            }
-            auto functionObject = static_cast<FunctionObject *>(object.get());
-            return evalFunction(functionObject);
-        } else {
-            auto identifier = static_cast<Identifier *>(node->name.get());
-            auto fun = environment->getValue(identifier->value);
-            if (fun == nullptr) {
-                auto args = evalFunctionArguments(node, environment);
-                auto result = evalBuiltin(identifier->value, args);
-                if (result == nullptr) {
-                    return makeErrorObject("identifier not found: " + identifier->value);
-                }
+    std::shared_ptr<GIObject> applyFunction( // NOLINT(misc-no-recursion)
+            GIObject *function, std::vector<std::shared_ptr<GIObject>> args) {
+        if (function->getType() == ObjectType::BUILTIN) {
+            auto &definition = builtinDefinitions()[static_cast<BuiltinFunctionObject *>(function)->index];
+            EvaluatorCaller caller;
+            auto result = definition.function(args, caller);
+            if (!definition.driven || result == nullptr || result->getType() != ObjectType::ITERATOR) {
                 return result;
             }
-            if (fun->getType() != ObjectType::FUNCTION) {
-                return makeErrorObject(fmt::format("{} is not a function", magic_enum::enum_name(fun->getType())));
+            auto iterator = static_cast<IteratorObject *>(result.get());
+            auto step = driveIterator(iterator, iterator->next());
+            if (step.kind == IteratorStep::Kind::Done) {
+                return std::make_shared<NullObject>();
             }
-            auto functionObject = static_cast<FunctionObject *>(fun.get());
-            return evalFunction(functionObject);
+            return step.value;
+        }
+        if (function->getType() != ObjectType::FUNCTION) {
+            return makeErrorObject(fmt::format("{} is not a function", magic_enum::enum_name(function->getType())));
         }
 
+        auto functionObject = static_cast<FunctionObject *>(function);
+        if (functionObject->parameters.size() != args.size()) {
+            return makeErrorObject("unexpected call arguments size");
+        }
+        // parameters take the first slots
+        auto env = std::make_shared<Environment>(std::max<std::size_t>(functionObject->slots, args.size()),
+                                                 functionObject->environment);
+        std::move(args.begin(), args.end(), env->values.begin());
+
+        auto result = eval(functionObject->body.get(), env);
+        if (result != nullptr && result->getType() == ObjectType::RETURN_VALUE) {
+            return static_cast<ReturnValueObject *>(result.get())->value;
+        }
+        return result;
     }
 
+    std::shared_ptr<GIObject> evalCallExpression(CallExpression *node, const std::shared_ptr<Environment> &environment) {
+        auto function = eval(node->name.get(), environment);
+        if (isError(function.get())) {
+            return function;
+        }
+        // iife
+        if (node->name->getType() != NodeType::Identifier && function->getType() != ObjectType::FUNCTION) {
+            return makeErrorObject("unexpected call expression name");
+        }
+        auto args = evalFunctionArguments(node, environment);
+        if (function->getType() == ObjectType::BUILTIN && !args.empty() && isError(args.back().get())) {
+            return args.back();
+        }
+        return applyFunction(function.get(), std::move(args));
+    }
 
     std::shared_ptr<GIObject> evalExpression(Node *node, const std::shared_ptr<Environment> &environment) {
         switch (node->getType()) {
-            case NodeType::IntegerExpression:
-                return std::make_unique<IntegerObject>(static_cast<IntegerExpression *>(node)->value);
+            case NodeType::IntegerExpression: {
+                auto integerExpression = static_cast<IntegerExpression *>(node);
+                if (integerExpression->bigValue.has_value()) {
+                    return std::make_unique<BigIntObject>(*integerExpression->bigValue);
+                }
+                return std::make_unique<IntegerObject>(integerExpression->value);
+            }
+            case NodeType::FloatExpression:
+                return std::make_unique<FloatObject>(static_cast<FloatExpression *>(node)->value);
             case NodeType::BoolExpression:
                 return std::make_unique<BooleanObject>(static_cast<BoolExpression *>(node)->value);
             case NodeType::StringExpression:
-                return std::make_unique<StringObject>(static_cast<StringExpression *>(node)->value);
+                return std::make_unique<StringObject>(std::string{static_cast<StringExpression *>(node)->value()});
             case NodeType::ArrayExpression: {
                 auto arrayExpr = static_cast<ArrayExpression *>(node);
                 std::vector<std::shared_ptr<GIObject>> elems{};
@@ -321,13 +444,17 @@ namespace GI {
                 if (left->getType() == ObjectType::ARRAY && index->getType() == ObjectType::INTEGER) {
                     auto arrayObject = static_cast<ArrayObject *>(left.get());
                     auto indexObject = static_cast<IntegerObject *>(index.get());
-                    if (indexObject->value < 0 || indexObject->value >= arrayObject->elements.size()) {
+                    if (indexObject->value < 0 || std::uint64_t(indexObject->value) >= arrayObject->size()) {
                         return nullptr;
                     }
-                    auto elem = arrayObject->elements[indexObject->value].get();
-                    if (elem->getType() == ObjectType::INTEGER) {
-                        return make_unique<IntegerObject>(static_cast<IntegerObject *>(elem)->value);
+                    return arrayObject->at(indexObject->value);
+                } else if (left->getType() == ObjectType::STRING && index->getType() == ObjectType::INTEGER) {
+                    auto stringObject = static_cast<StringObject *>(left.get());
+                    auto indexValue = static_cast<IntegerObject *>(index.get())->value;
+                    if (indexValue < 0 || std::uint64_t(indexValue) >= stringObject->value.size()) {
+                        return std::make_shared<NullObject>();
                     }
+                    return stringObject->substr(indexValue, indexValue + 1);
                 } else if (left->getType() == ObjectType::HASH) {
                     auto hashObject = static_cast<HashObject *>(left.get());
                     auto hashKey = index->hash();
@@ -354,21 +481,39 @@ namespace GI {
                 if (isError(left.get())) {
                     return left;
                 }
+                auto infixOperator = infixExpression->infixOperator;
+                if (infixOperator == InfixOperator::And || infixOperator == InfixOperator::Or) {
+                    // the right operand is only evaluated when the left one doesn't decide the result
+                    if (isTruthy(left.get()) == (infixOperator == InfixOperator::Or)) {
+                        return makeBoolObject(isTruthy(left.get()));
+                    }
+                    auto right = eval(infixExpression->rightExpression.get(), environment);
+                    if (isError(right.get())) {
+                        return right;
+                    }
+                    return makeBoolObject(isTruthy(right.get()));
+                }
                 auto right = eval(infixExpression->rightExpression.get(), environment);
                 if (isError(right.get())) {
                     return right;
                 }
-                return evalInfixExpression(infixExpression->infixOperator, left, right);
+                return evalInfixExpression(infixOperator, left, right);
             }
             case NodeType::IfExpression:
                 return evalIfExpression(static_cast<IfExpression *>(node), environment);
+            case NodeType::MatchExpression:
+                return evalMatchExpression(static_cast<MatchExpression *>(node), environment);
             case NodeType::Identifier:
                 return evalIdentifierExpression(static_cast<Identifier *>(node), environment);
             case NodeType::FunctionExpression: {
                 auto fnExpression = static_cast<FunctionExpression *>(node);
-                return std::make_unique<FunctionObject>(
-                        std::move(fnExpression->parameters),
-                        std::move(fnExpression->body), environment);
+                std::vector<std::string_view> parameters;
+                parameters.reserve(fnExpression->parameters.size());
+                for (auto &parameter: fnExpression->parameters) {
+                    parameters.push_back(parameter->token.literal);
+                }
+                return std::make_unique<FunctionObject>(std::move(parameters), fnExpression->slots, fnExpression->body,
+                                                        environment);
             }
             case NodeType::CallExpression:
                 return evalCallExpression(static_cast<CallExpression *>(node), environment);
@@ -404,7 +549,50 @@ namespace GI {
                 if (isError(value.get())) {
                     return value;
                 }
-                environment->setValue(letStatement->name->value, value);
+                environment->define(letStatement->name->depth, letStatement->name->slot) = std::move(value);
+                return nullptr;
+            }
+            case NodeType::WhileStatement:
+                return evalWhileStatement(static_cast<WhileStatement *>(node), environment);
+            case NodeType::ForStatement:
+                return evalForStatement(static_cast<ForStatement *>(node), environment);
+            case NodeType::AssignStatement: {
+                auto assignStatement = static_cast<AssignStatement *>(node);
+                // a[i][j] = v is evaluated as root `a` with the index path [i, j], a = v has an empty path
+                std::vector<Expression *> indexExpressions;
+                auto target = assignStatement->target.get();
+                while (target->getType() == NodeType::IndexExpression) {
+                    auto indexExpression = static_cast<IndexExpression *>(target);
+                    indexExpressions.push_back(indexExpression->indexExpression.get());
+                    target = indexExpression->leftExpression.get();
+                }
+                if (target->getType() != NodeType::Identifier) {
+                    return makeErrorObject(fmt::format("invalid assignment target: {}", target->toString()));
+                }
+                std::reverse(indexExpressions.begin(), indexExpressions.end());
+                std::vector<std::shared_ptr<GIObject>> indices;
+                for (auto indexExpression: indexExpressions) {
+                    auto index = eval(indexExpression, environment);
+                    if (isError(index.get())) {
+                        return index;
+                    }
+                    indices.push_back(std::move(index));
+                }
+                auto value = eval(assignStatement->value.get(), environment);
+                if (isError(value.get())) {
+                    return value;
+                }
+                auto name = static_cast<Identifier *>(target);
+                auto slot = environment->find(name->depth, name->slot);
+                if (slot == nullptr || *slot == nullptr) {
+                    return makeErrorObject(fmt::format("identifier not found: {}", name->token.literal));
+                }
+                // the environment holding the only reference means nobody else can observe the mutation
+                auto result = setIndexPath(*slot, indices, std::move(value), slot->use_count() == 1);
+                if (isError(result.get())) {
+                    return result;
+                }
+                *slot = std::move(result);
                 return nullptr;
             }
             default:
@@ -12,31 +12,36 @@ namespace GI {
     using namespace Common;
 
     struct FunctionObject : GIObject {
+        // the body is shared with the function expression, evaluating the expression again (in a loop or a
+        // called function) creates another function over the same body. The body keeps the storage of the
+        // program it was parsed from alive, the parameter names point into its source.
         FunctionObject(
-                std::vector<std::unique_ptr<Identifier>> parameters,
-                std::unique_ptr<BlockStatement> body,
+                std::vector<std::string_view> parameters,
+                std::uint32_t slots,
+                std::shared_ptr<BlockStatement> body,
                 std::shared_ptr<Environment> environment
-        ) : parameters{std::move(parameters)}, body{std::move(body)}, environment{std::move(environment)} {}
+        ) : parameters{std::move(parameters)}, slots{slots}, body{std::move(body)},
+            environment{std::move(environment)} {}
 
         ObjectType getType() override { return ObjectType::FUNCTION; }
 
         std::string inspect() override {
             std::stringstream ss;
 
-            std::vector<std::string> params;
-            for (auto &param: parameters) {
-                params.push_back(param->toString());
+            ss << "(";
+            for (auto parameter: parameters) {
+                ss << parameter << ", ";
             }
-            std::stringstream paramsStream;
-            std::copy(params.begin(), params.end() - 1, std::ostream_iterator<std::string>(paramsStream, ", "));
-            ss << "(" << paramsStream.str() << ")";
+            ss << ")";
             ss << " {" << std::endl;
             ss << body->toString() << std::endl << "}";
             return ss.str();
         }
 
-        std::vector<std::unique_ptr<Identifier>> parameters;
-        std::unique_ptr<BlockStatement> body;
+        std::vector<std::string_view> parameters;
+        // size of the environment of a call
+        std::uint32_t slots;
+        std::shared_ptr<BlockStatement> body;
         std::shared_ptr<Environment> environment;
     };
 }
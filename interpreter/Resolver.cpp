@@ -0,0 +1,183 @@
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "cppcoreguidelines-pro-type-static-cast-downcast"
+#endif
+//
+// Created by seeu on 2022/9/10.
+//
+
+#include "Resolver.h"
+
+namespace GI {
+
+    void resolve(Program *program) {
+        Resolver{}.resolve(program);
+    }
+
+    void Resolver::resolve(Program *program) {
+        scopes.clear();
+        scopes.emplace_back();
+        for (auto &stmt: program->statements) {
+            resolveNode(stmt.get());
+        }
+        resolveFunctions(scopes.back());
+    }
+
+    void Resolver::resolveFunctions(Scope &scope) { // NOLINT(misc-no-recursion)
+        // resolving a body appends to `scopes`, which may move `scope`
+        auto functions = std::move(scope.functions);
+        for (auto function: functions) {
+            scopes.emplace_back();
+            for (auto &parameter: function->parameters) {
+                declareParameter(parameter.get());
+            }
+            resolveNode(function->body.get());
+            function->slots = scopes.back().size;
+            resolveFunctions(scopes.back());
+            scopes.pop_back();
+        }
+    }
+
+    void Resolver::declare(Identifier *identifier) {
+        if (scopes.size() == 1) {
+            identifier->depth = 0;
+            identifier->slot = identifier->symbol;
+            return;
+        }
+        auto &scope = scopes.back();
+        auto [it, inserted] = scope.slots.try_emplace(identifier->symbol, scope.size);
+        if (inserted) {
+            scope.size++;
+        }
+        identifier->depth = 0;
+        identifier->slot = it->second;
+    }
+
+    void Resolver::declareParameter(Identifier *identifier) {
+        auto &scope = scopes.back();
+        scope.slots[identifier->symbol] = scope.size;
+        identifier->depth = 0;
+        identifier->slot = scope.size++;
+    }
+
+    void Resolver::lookup(Identifier *identifier) {
+        for (auto scope = scopes.size() - 1; scope != 0; scope--) {
+            auto &slots = scopes[scope].slots;
+            if (auto it = slots.find(identifier->symbol); it != slots.end()) {
+                identifier->depth = std::uint32_t(scopes.size() - 1 - scope);
+                identifier->slot = it->second;
+                return;
+            }
+        }
+        identifier->depth = std::uint32_t(scopes.size() - 1);
+        identifier->slot = identifier->symbol;
+    }
+
+    void Resolver::resolveNode(Node *node) { // NOLINT(misc-no-recursion)
+        if (node == nullptr) {
+            return;
+        }
+        switch (node->getType()) {
+            case NodeType::Identifier:
+                lookup(static_cast<Identifier *>(node));
+                break;
+            case NodeType::ArrayExpression:
+                for (auto &elem: static_cast<ArrayExpression *>(node)->elements) {
+                    resolveNode(elem.get());
+                }
+                break;
+            case NodeType::HashExpression:
+                for (auto &p: static_cast<HashExpression *>(node)->pairs) {
+                    resolveNode(p.first.get());
+                    resolveNode(p.second.get());
+                }
+                break;
+            case NodeType::IndexExpression: {
+                auto indexExpression = static_cast<IndexExpression *>(node);
+                resolveNode(indexExpression->leftExpression.get());
+                resolveNode(indexExpression->indexExpression.get());
+                break;
+            }
+            case NodeType::PrefixExpression:
+                resolveNode(static_cast<PrefixExpression *>(node)->rightExpression.get());
+                break;
+            case NodeType::InfixExpression: {
+                auto infixExpression = static_cast<InfixExpression *>(node);
+                resolveNode(infixExpression->leftExpression.get());
+                resolveNode(infixExpression->rightExpression.get());
+                break;
+            }
+            case NodeType::IfExpression: {
+                auto ifExpression = static_cast<IfExpression *>(node);
+                resolveNode(ifExpression->condition.get());
+                resolveNode(ifExpression->consequence.get());
+                resolveNode(ifExpression->alternative.get());
+                break;
+            }
+            case NodeType::MatchExpression: {
+                auto matchExpression = static_cast<MatchExpression *>(node);
+                resolveNode(matchExpression->subject.get());
+                for (auto &arm: matchExpression->arms) {
+                    for (auto &pattern: arm.patterns) {
+                        resolveNode(pattern.get());
+                    }
+                    resolveNode(arm.body.get());
+                }
+                break;
+            }
+            case NodeType::FunctionExpression:
+                scopes.back().functions.push_back(static_cast<FunctionExpression *>(node));
+                break;
+            case NodeType::CallExpression: {
+                auto callExpression = static_cast<CallExpression *>(node);
+                resolveNode(callExpression->name.get());
+                for (auto &arg: callExpression->arguments) {
+                    resolveNode(arg.get());
+                }
+                break;
+            }
+            case NodeType::LetStatement: {
+                // the value is resolved first, `let x = x + 1` reads an outer x
+                auto letStatement = static_cast<LetStatement *>(node);
+                resolveNode(letStatement->value.get());
+                declare(letStatement->name.get());
+                break;
+            }
+            case NodeType::BlockStatement:
+                for (auto &stmt: static_cast<BlockStatement *>(node)->statements) {
+                    resolveNode(stmt.get());
+                }
+                break;
+            case NodeType::ReturnStatement:
+                resolveNode(static_cast<ReturnStatement *>(node)->returnValue.get());
+                break;
+            case NodeType::ExpressionStatement:
+                resolveNode(static_cast<ExpressionStatement *>(node)->expression.get());
+                break;
+            case NodeType::AssignStatement: {
+                auto assignStatement = static_cast<AssignStatement *>(node);
+                resolveNode(assignStatement->target.get());
+                resolveNode(assignStatement->value.get());
+                break;
+            }
+            case NodeType::WhileStatement: {
+                auto whileStatement = static_cast<WhileStatement *>(node);
+                resolveNode(whileStatement->condition.get());
+                resolveNode(whileStatement->body.get());
+                break;
+            }
+            case NodeType::ForStatement: {
+                auto forStatement = static_cast<ForStatement *>(node);
+                resolveNode(forStatement->iterable.get());
+                declare(forStatement->variable.get());
+                resolveNode(forStatement->body.get());
+                break;
+            }
+            default:
+                // literals
+                break;
+        }
+    }
+}
+
+#pragma clang diagnostic pop
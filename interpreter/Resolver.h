@@ -0,0 +1,49 @@
+//
+// Created by seeu on 2022/9/10.
+//
+
+#ifndef GOINTERPRETER_RESOLVER_H
+#define GOINTERPRETER_RESOLVER_H
+
+#include <unordered_map>
+#include <vector>
+#include "Ast.h"
+
+namespace GI {
+    using namespace Common;
+
+    // Gives every identifier the depth and slot of its binding before the program is evaluated. Locals of a
+    // function, parameters first, get slots in the environment of a call in the order they are declared. Blocks
+    // don't open scopes. A name that isn't a local of an enclosing function is a global.
+    class Resolver {
+    public:
+        void resolve(Program *program);
+
+    private:
+        struct Scope {
+            std::unordered_map<SymbolId, std::uint32_t> slots;
+            std::uint32_t size{0};
+            // function expressions declared in this scope, resolved once all its locals are known since
+            // their bodies run later
+            std::vector<FunctionExpression *> functions;
+        };
+
+        void resolveNode(Node *node);
+
+        void resolveFunctions(Scope &scope);
+
+        void declare(Identifier *identifier);
+
+        // every parameter gets a slot of its own, a repeated name refers to the last one
+        void declareParameter(Identifier *identifier);
+
+        void lookup(Identifier *identifier);
+
+        // the outermost scope holds the functions declared at the top level
+        std::vector<Scope> scopes;
+    };
+
+    void resolve(Program *program);
+}
+
+#endif //GOINTERPRETER_RESOLVER_H
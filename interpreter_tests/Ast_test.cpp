@@ -10,15 +10,16 @@ using namespace Common;
 
 TEST_CASE("Ast", "[ast]") {
     SECTION("let expression") {
-        std::vector<std::unique_ptr<Statement>> stmts{};
-        auto stmt = std::make_unique<LetStatement>(Token(TokenType::LET, "let"),
-                                                   std::make_unique<Identifier>(
-                                                           Token{TokenType::IDENTIFIER, "myVar"}, "myVar"),
-                                                   std::make_unique<Identifier>(
-                                                           Token{TokenType::IDENTIFIER, "anotherVar"},
-                                                           "anotherVar"));
-        stmts.push_back(std::move(stmt));
-        auto program = Program{std::move(stmts)};
+        auto symbols = std::make_shared<SymbolInterner>();
+        auto storage = std::make_shared<SyntaxStorage>(std::make_shared<const std::string>(), symbols);
+        std::vector<NodePtr<Statement>> stmts{};
+        stmts.emplace_back(storage->allocate<LetStatement>(
+                Token(TokenType::LET, "let"),
+                NodePtr<Identifier>{storage->allocate<Identifier>(Token{TokenType::IDENTIFIER, "myVar"},
+                                                                  symbols->intern("myVar"))},
+                NodePtr<Identifier>{storage->allocate<Identifier>(Token{TokenType::IDENTIFIER, "anotherVar"},
+                                                                  symbols->intern("anotherVar"))}));
+        auto program = Program{storage, std::move(stmts)};
         REQUIRE(program.toString() == "let myVar = anotherVar;");
     }
 }
@@ -0,0 +1,82 @@
+//
+// Created by seeu on 2022/8/30.
+//
+
+#include <cstdint>
+#include "catch2/catch_all.hpp"
+#include "BigInt.h"
+
+using namespace Common;
+
+static BigInt power(std::int64_t base, int exponent) {
+    BigInt result{1};
+    for (auto i = 0; i < exponent; i++) {
+        result = result * BigInt{base};
+    }
+    return result;
+}
+
+TEST_CASE("big int to string", "[big int]") {
+    REQUIRE(BigInt{0}.toString() == "0");
+    REQUIRE(BigInt{-42}.toString() == "-42");
+    REQUIRE(BigInt{INT64_MIN}.toString() == "-9223372036854775808");
+    REQUIRE(power(2, 200).toString() == "1606938044258990275541962092341162602522202993782792835301376");
+
+    BigInt factorial{1};
+    for (auto i = 2; i <= 50; i++) {
+        factorial = factorial * BigInt{i};
+    }
+    REQUIRE(factorial.toString() == "30414093201713378043612608166064768844377641568960512000000000000");
+}
+
+TEST_CASE("big int from decimal", "[big int]") {
+    REQUIRE(BigInt::fromDecimal("0") == BigInt{0});
+    REQUIRE(BigInt::fromDecimal("9223372036854775807") == BigInt{INT64_MAX});
+    REQUIRE(BigInt::fromDecimal("1606938044258990275541962092341162602522202993782792835301376") == power(2, 200));
+    REQUIRE_FALSE(BigInt::fromDecimal("").has_value());
+    REQUIRE_FALSE(BigInt::fromDecimal("12a").has_value());
+}
+
+TEST_CASE("big int int64 range", "[big int]") {
+    REQUIRE(BigInt{INT64_MAX}.toInt64() == INT64_MAX);
+    REQUIRE(BigInt{INT64_MIN}.toInt64() == INT64_MIN);
+    REQUIRE_FALSE((BigInt{INT64_MAX} + BigInt{1}).toInt64().has_value());
+    REQUIRE_FALSE((BigInt{INT64_MIN} - BigInt{1}).toInt64().has_value());
+    REQUIRE((BigInt{INT64_MAX} + BigInt{1} - BigInt{1}).toInt64() == INT64_MAX);
+}
+
+TEST_CASE("big int arithmetic", "[big int]") {
+    auto big = power(10, 30);
+    REQUIRE((big - big).isZero());
+    REQUIRE((BigInt{5} - big + big) == BigInt{5});
+    REQUIRE(-big < BigInt{0});
+    REQUIRE(big > BigInt{INT64_MAX});
+
+    auto [quotient, remainder] = BigInt::divMod(big + BigInt{7}, BigInt{-1000});
+    REQUIRE(quotient == -power(10, 27));
+    REQUIRE(remainder == BigInt{7});
+    auto [negativeQuotient, negativeRemainder] = BigInt::divMod(-big - BigInt{7}, BigInt{1000});
+    REQUIRE(negativeQuotient == -power(10, 27));
+    REQUIRE(negativeRemainder == BigInt{-7});
+}
+
+TEST_CASE("big int karatsuba multiplication", "[big int]") {
+    // operands above the karatsuba threshold, checked against division
+    auto left = power(3, 2000) + BigInt{12345};
+    auto right = power(7, 1500) - BigInt{1};
+    auto product = left * right;
+    REQUIRE(product == right * left);
+
+    auto [quotient, remainder] = BigInt::divMod(product + BigInt{99}, right);
+    REQUIRE(quotient == left);
+    REQUIRE(remainder == BigInt{99});
+
+    // unbalanced operands
+    auto small = power(5, 100);
+    auto [smallQuotient, smallRemainder] = BigInt::divMod(left * small, small);
+    REQUIRE(smallQuotient == left);
+    REQUIRE(smallRemainder.isZero());
+
+    // (a + b)^2 = a^2 + 2ab + b^2
+    REQUIRE((left + right) * (left + right) == left * left + BigInt{2} * product + right * right);
+}
@@ -6,6 +6,7 @@
 #include "Lexer.h"
 #include "Parser.h"
 #include "Evaluator.h"
+#include "Resolver.h"
 #include <iostream>
 #include <string>
 #include <memory>
@@ -125,11 +126,11 @@ TEST_CASE("eval array expression", "[evaluator]") {
     string input{"[1, 2 * 2, 3 + 3, -4]"};
     auto result = testEval(input);
     auto object = static_cast<ArrayObject *>(result.get());
-    REQUIRE(object->elements.size() == 4);
-    REQUIRE(static_cast<IntegerObject *>(object->elements[0].get())->value == 1);
-    REQUIRE(static_cast<IntegerObject *>(object->elements[1].get())->value == 4);
-    REQUIRE(static_cast<IntegerObject *>(object->elements[2].get())->value == 6);
-    REQUIRE(static_cast<IntegerObject *>(object->elements[3].get())->value == -4);
+    REQUIRE(object->size() == 4);
+    REQUIRE(static_cast<IntegerObject *>(object->at(0).get())->value == 1);
+    REQUIRE(static_cast<IntegerObject *>(object->at(1).get())->value == 4);
+    REQUIRE(static_cast<IntegerObject *>(object->at(2).get())->value == 6);
+    REQUIRE(static_cast<IntegerObject *>(object->at(3).get())->value == -4);
 }
 
 TEST_CASE("eval array index", "[evaluator]") {
@@ -432,6 +433,9 @@ TEST_CASE("function", "[evaluator]") {
     }
 
     testExpression<StringObject>("fn(x) { x; }(\"hello\")", "hello");
+
+    // the function outlives the program and its source, its body still prints
+    REQUIRE(testEval("fn(x) { x * 2.5 }")->inspect() == "(x, ) {\n(x * 2.5)\n}");
 }
 
 TEST_CASE("enclosing env", "[evaluator]") {
@@ -451,6 +455,51 @@ TEST_CASE("enclosing env", "[evaluator]") {
     testExpression<IntegerObject>(input, 70);
 }
 
+TEST_CASE("resolved slots", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"let x = 1; let f = fn() { let x = x + 1; x }; f() + x",                               3},
+            {"let f = fn(x) { let x = x * 2; x }; f(4)",                                            8},
+            {"let f = fn() { let g = fn(n) { if (n == 0) { 0 } else { n + g(n - 1) } }; g(4) }; f()", 10},
+            {"let f = fn() { let g = fn() { h() }; let h = fn() { 7 }; g() }; f()",                  7},
+            {"let counter = fn() { let n = 0; fn() { n = n + 1; n } }; let c = counter(); c(); c()",  2},
+            {"let f = fn(a) { fn(b) { fn(c) { a + b + c } } }; f(1)(2)(3)",                          6},
+            {"let f = fn() { let s = 0; for (x in [1, 2, 3]) { let y = x * 2; s = s + y; } s }; f()", 12},
+            {"let f = fn() { g() }; let g = fn() { 5 }; f()",                                       5},
+            {"let f = fn(a, a) { a }; f(1, 2)",                                                     2},
+            {"let f = fn(a, b, a) { let c = b; a + c }; f(1, 2, 3)",                                5},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval("let f = fn(c) { if (c) { let y = 1; } y }; f(false)")->getType() == ObjectType::ERROR);
+
+    Lexer lexer{"let a = 1; fn(b) { let c = a; fn() { b + c } }"};
+    Parser parser{&lexer};
+    auto program = parser.parseProgram();
+    resolve(program.get());
+    auto outer = static_cast<FunctionExpression *>(
+            static_cast<ExpressionStatement *>(program->statements[1].get())->expression.get());
+    REQUIRE(outer->slots == 2);
+    auto let = static_cast<LetStatement *>(outer->body->statements[0].get());
+    auto a = static_cast<Identifier *>(let->value.get());
+    REQUIRE((let->name->depth == 0 && let->name->slot == 1));
+    REQUIRE((a->depth == 1 && a->slot == lexer.getSymbols()->intern("a")));
+    auto inner = static_cast<FunctionExpression *>(
+            static_cast<ExpressionStatement *>(outer->body->statements[1].get())->expression.get());
+    auto sum = static_cast<InfixExpression *>(
+            static_cast<ExpressionStatement *>(inner->body->statements[0].get())->expression.get());
+    auto b = static_cast<Identifier *>(sum->leftExpression.get());
+    auto c = static_cast<Identifier *>(sum->rightExpression.get());
+    REQUIRE(inner->slots == 0);
+    REQUIRE((b->depth == 1 && b->slot == 0));
+    REQUIRE((c->depth == 1 && c->slot == 1));
+}
+
 TEST_CASE("builtin functions", "[evaluator]") {
     struct TestCase {
         std::string input;
@@ -465,4 +514,461 @@ TEST_CASE("builtin functions", "[evaluator]") {
     for (auto &testCase: cases) {
         testExpression<IntegerObject>(testCase.input, testCase.expected);
     }
+    REQUIRE(testEval(R"(puts("hello", 1))")->getType() == ObjectType::_NULL);
+    REQUIRE(testEval("len(1)")->getType() == ObjectType::ERROR);
+
+    // the builtin index is the position in the table
+    auto builtins = builtinDefinitions();
+    for (auto index = 0; index < int(builtins.size()); index++) {
+        REQUIRE(lookupBuiltin(builtins[index].name) == index);
+    }
+    REQUIRE_FALSE(lookupBuiltin("unknown").has_value());
+}
+
+TEST_CASE("slice builtin functions", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"len(slice([1, 2, 3, 4], 1, 3))",                      2},
+            {"slice([1, 2, 3, 4], 1, 3)[0]",                        2},
+            {"slice([1, 2, 3, 4], 1)[2]",                           4},
+            {"len(slice([1, 2, 3], 2, 99))",                        1},
+            {"len(slice([1, 2, 3], 3, 1))",                         0},
+            {"slice(slice([1, 2, 3, 4, 5], 1, 5), 1, 3)[1]",        4},
+            {"len(substr(\"hello world\", 6, 11))",                 5},
+            {R"(
+                let sum = fn(arr) {
+                    if (len(arr) == 0) { return 0; }
+                    arr[0] + sum(slice(arr, 1));
+                };
+                sum([1, 2, 3, 4]);)",                               10},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+
+    testExpression<StringObject>(R"(substr("hello world", 6))", "world");
+    testExpression<StringObject>(R"(substr(substr("hello world", 4, 9), 1, 3))", " w");
+
+    auto slice = testEval("slice([1, 2, 3, 4], 1, 3)");
+    auto sliceObject = static_cast<ArrayObject *>(slice.get());
+    REQUIRE(sliceObject->isPacked());
+    REQUIRE(sliceObject->packedStorage.size() == 4);
+    REQUIRE(sliceObject->offset == 1);
+    REQUIRE(sliceObject->size() == 2);
+}
+
+TEST_CASE("array builtin functions", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"first([1, 2, 3])",                            1},
+            {"last([1, 2, 3])",                             3},
+            {"len(rest([1, 2, 3]))",                        2},
+            {"rest([1, 2, 3])[0]",                          2},
+            {"push([1, 2], 3)[2]",                          3},
+            {"let a = [1, 2]; let b = push(a, 3); len(a)",  2},
+            {"let a = [1, 2]; push(a, 3); push(a, 4)[2]",   4},
+            {"push(slice([1, 2, 3], 0, 1), 4)[1]",          4},
+            {R"(
+                let build = fn(arr, n) {
+                    if (n == 0) { return arr; }
+                    build(push(arr, n), n - 1);
+                };
+                let sum = fn(arr, acc) {
+                    if (len(arr) == 0) { return acc; }
+                    sum(rest(arr), acc + first(arr));
+                };
+                sum(build([], 100), 0);)",                  5050},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+
+    REQUIRE(testEval("first([])")->getType() == ObjectType::_NULL);
+    REQUIRE(testEval("rest([])")->getType() == ObjectType::_NULL);
+}
+
+TEST_CASE("packed integer arrays", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"sum([1, 2, 3, 4, 5, 6, 7, 8, 9])",                  45},
+            {"sum([])",                                           0},
+            {"min([5, -2, 9, 3, 7])",                             -2},
+            {"max([5, -2, 9, 3, 7])",                             9},
+            {"dot([1, 2, 3, 4, 5], [5, 4, 3, 2, 1])",             35},
+            {"map_add([1, 2, 3, 4, 5], 10)[4]",                   15},
+            {"len(filter_gt([5, -2, 9, 3, 7], 4))",               3},
+            {"filter_gt([5, -2, 9, 3, 7], 4)[2]",                 7},
+            {"sum(slice([1, 2, 3, 4, 5], 1, 4))",                 9},
+            {"sum(push([1, 2], 3))",                              6},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval(R"(sum(push([1, 2], "a")))")->getType() == ObjectType::ERROR);
+
+    auto packed = testEval("push([1, 2], 3)");
+    REQUIRE(static_cast<ArrayObject *>(packed.get())->isPacked());
+
+    // a non integer element falls back to boxed storage
+    auto boxed = testEval(R"(push([1, 2], "three"))");
+    auto boxedArray = static_cast<ArrayObject *>(boxed.get());
+    REQUIRE_FALSE(boxedArray->isPacked());
+    REQUIRE(boxedArray->size() == 3);
+    REQUIRE(static_cast<IntegerObject *>(boxedArray->at(1).get())->value == 2);
+    REQUIRE(static_cast<StringObject *>(boxedArray->at(2).get())->value == "three");
+
+    // boxed arrays holding only integers still work with the integer builtins
+    testExpression<IntegerObject>(R"(sum(slice([1, "a", 2, 3], 2)))", 5);
+
+    // like +, overflowing sums are big integers
+    REQUIRE(testEval("sum([9223372036854775807, 1])")->inspect() == "9223372036854775808");
+    testExpression<BooleanObject>("let a = []; let i = 0; while (i < 40) { a = push(a, 9223372036854775807); i = i + 1; } "
+                                  "sum(a) == 40 * 9223372036854775807", true);
+    REQUIRE(testEval("dot([4294967296, 1], [4294967296, 1])")->inspect() == "18446744073709551617");
+    REQUIRE(testEval("dot([9223372036854775807, 2], [2, -9223372036854775807])")->inspect() == "0");
+    testExpression<IntegerObject>("sum([9223372036854775807, 1, -2])", INT64_MAX - 1);
+    REQUIRE(testEval("map_add([9223372036854775807], 1)")->inspect() == "[9223372036854775808, ]");
+    REQUIRE(testEval("map_add([1, -9223372036854775807, 2], -2)")->inspect() == "[-1, -9223372036854775809, 0, ]");
+    testExpression<IntegerObject>("map_add([9223372036854775807, 5], 1)[0] - 1", INT64_MAX);
+}
+
+TEST_CASE("index assignment", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"let a = [1, 2, 3]; a[1] = 5; a[1]",                          5},
+            {"let a = [1, 2, 3]; a[1] = 5; a[0] + a[2]",                   4},
+            {"let a = [1, 2, 3]; let b = a; b[0] = 9; a[0]",               1},
+            {"let a = [1, 2, 3]; let b = a; b[0] = 9; b[0]",               9},
+            {R"(let h = {"a": 1}; h["b"] = 2; h["a"] + h["b"])",           3},
+            {R"(let h = {"a": 1}; let g = h; g["a"] = 2; h["a"])",         1},
+            {"let m = [[1, 2], [3, 4]]; let row = m[1]; m[1][0] = 7; row[0]", 3},
+            {"let m = [[1, 2], [3, 4]]; m[1][0] = 7; m[1][0]",             7},
+            {"let set = fn(arr) { arr[0] = 5; arr }; let a = [1]; set(a)[0] + a[0]", 6},
+            {R"(let a = [1, 2]; a[0] = "x"; a[1])",                        2},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval("let a = [1]; a[1] = 2;")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("[1][0] = 2;")->getType() == ObjectType::ERROR);
+
+    // an array bound to a single name is updated in place
+    // the programs of a session share their symbols
+    auto symbols = std::make_shared<SymbolInterner>();
+    Lexer lexer{"let a = [1, 2, 3];", symbols};
+    Parser parser{&lexer};
+    auto program = parser.parseProgram();
+    auto env = std::make_shared<Environment>();
+    eval(program.get(), env);
+    auto before = env->getValue(symbols->intern("a")).get();
+    Lexer assignLexer{"a[0] = 4;", symbols};
+    Parser assignParser{&assignLexer};
+    auto assignProgram = assignParser.parseProgram();
+    eval(assignProgram.get(), env);
+    REQUIRE(env->getValue(symbols->intern("a")).get() == before);
+    REQUIRE(static_cast<IntegerObject *>(static_cast<ArrayObject *>(before)->at(0).get())->value == 4);
+}
+
+TEST_CASE("integer overflow", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"9223372036854775807 + 1",                          "9223372036854775808"},
+            {"-9223372036854775807 - 2",                         "-9223372036854775809"},
+            {"4294967296 * 4294967296",                          "18446744073709551616"},
+            {"4294967296 * 4294967296 * 4294967296 / 4294967296", "18446744073709551616"},
+            {"-(-9223372036854775807 - 1)",                      "9223372036854775808"},
+            {"(-9223372036854775807 - 1) / -1",                  "9223372036854775808"},
+            {"99999999999999999999",                             "99999999999999999999"},
+            {"-99999999999999999999 - 1",                        "-100000000000000000000"},
+            {"9223372036854775808",                              "9223372036854775808"},
+    };
+    for (auto &testCase: cases) {
+        auto result = testEval(testCase.input);
+        REQUIRE(result->getType() == ObjectType::BIG_INTEGER);
+        REQUIRE(result->inspect() == testCase.expected);
+    }
+
+    // results that fit again are plain integers
+    testExpression<IntegerObject>("9223372036854775807 + 1 - 1", INT64_MAX);
+    testExpression<IntegerObject>("4294967296 * 4294967296 / 4294967296", 4294967296);
+    testExpression<IntegerObject>("-9223372036854775808", INT64_MIN);
+    testExpression<IntegerObject>("18446744073709551616 / 4294967296", 4294967296);
+    testExpression<IntegerObject>("match (9223372036854775808) { 9223372036854775808 => 1, _ => 2 }", 1);
+    testExpression<BooleanObject>("9223372036854775807 + 1 > 9223372036854775807", true);
+    testExpression<BooleanObject>("9223372036854775807 * 2 == 9223372036854775807 + 9223372036854775807", true);
+    REQUIRE(testEval("1 / 0")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("float expression", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        double expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"1.5",                      1.5},
+            {"-2.5",                     -2.5},
+            {"1.5 + 2.25",               3.75},
+            {"1 + 0.5",                  1.5},
+            {"3 / 2.0",                  1.5},
+            {"2.5 * 4",                  10},
+            {"1e3 - 1",                  999},
+            {"sqrt(16)",                 4},
+            {"floor(-1.5)",              -2},
+            {"pow(2, 10)",               1024},
+            {"sqrt([4, 9.0, 16])[1]",    3},
+            {"floor([1.5, 2.5])[1]",     2},
+            {"pow([1, 2, 3], 2)[2]",     9},
+    };
+    for (auto &testCase: cases) {
+        testExpression<FloatObject>(testCase.input, testCase.expected);
+    }
+    testExpression<BooleanObject>("1 < 1.5", true);
+    testExpression<BooleanObject>("2 == 2.0", true);
+    testExpression<BooleanObject>("0.1 + 0.2 != 0.3", true);
+    testExpression<BooleanObject>("9223372036854775807 + 1 > 1.5", true);
+    REQUIRE(testEval("3.0")->inspect() == "3.0");
+    REQUIRE(testEval("sqrt(\"a\")")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("1.5 + \"a\"")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("loops", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"let i = 0; while (i < 10) { i = i + 1; } i",                                   10},
+            {"let i = 0; while (false) { i = 1; } i",                                        0},
+            {"let sum = 0; for (x in [1, 2, 3]) { sum = sum + x; } sum",                     6},
+            {"let sum = 0; for (x in []) { sum = 1; } sum",                                  0},
+            {R"(let n = 0; for (x in [1, "a", [2]]) { n = n + 1; } n)",                      3},
+            {"let f = fn() { let i = 0; while (true) { if (i == 5) { return i; } i = i + 1; } }; f()", 5},
+            {"let f = fn(arr) { for (x in arr) { if (x > 1) { return x; } } 0 }; f([1, 5, 2])", 5},
+            {"let a = [1, 2, 3]; let sum = 0; for (x in a) { a[0] = 10; sum = sum + x; } sum + a[0]", 16},
+            {"let i = 0; let n = 0; while (i < 100000) { i = i + 1; n = n + 2; } n",         200000},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval("for (x in 1) { x }")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("while (y) { 1 }")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("y = 1;")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("comparison and logic", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        bool expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"1 <= 1",                     true},
+            {"2 <= 1",                     false},
+            {"1 >= 2",                     false},
+            {"2.5 >= 2",                   true},
+            {"1 < 2 && 2 < 3",             true},
+            {"1 < 2 && 3 < 2",             false},
+            {"1 > 2 || 2 > 1",             true},
+            {"false || false",             false},
+            {"1 && 0",                     true},
+            {"false && undefined",         false},
+            {"true || undefined",          true},
+            {"7 % 3 == 1",                 true},
+            {"-7 % 3 == -1",               true},
+            {"7.5 % 2 == 1.5",             true},
+    };
+    for (auto &testCase: cases) {
+        testExpression<BooleanObject>(testCase.input, testCase.expected);
+    }
+    testExpression<IntegerObject>("(-9223372036854775807 - 1) % -1", 0);
+    testExpression<IntegerObject>("(9223372036854775807 + 10) % 10", 7);
+    REQUIRE(testEval("1 % 0")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("true && undefined")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("match expression", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"match (2) { 1 => 10, 2 => 20, _ => 30 }",                          20},
+            {"match (5) { 1 => 10, 2 => 20, _ => 30 }",                          30},
+            {"match (-3) { 1, -3 => 10, _ => 30 }",                              10},
+            {R"(match ("b") { "a" => 1, "b" => { let x = 2; x * 3 } })",         6},
+            {"match (1) { _ => 0, 1 => 1 }",                                     1},
+            {"match (1) { 1 => 1, 1 => 2 }",                                     1},
+            {"match (true) { 1 => 1, true => 2 }",                               2},
+            {"let f = fn(x) { match (x % 3) { 0 => { return 0; }, _ => 1 }; 2 }; f(3) + f(4)", 2},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    // patterns match on type and value
+    REQUIRE(testEval("match (1.0) { 1 => 1 }") == nullptr);
+    REQUIRE(testEval("match ([1]) { 1 => 1 }") == nullptr);
+}
+
+TEST_CASE("lazy iterators", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"reduce(range(5), fn(a, b) { a + b }, 0)",                                          10},
+            {"reduce(imap(ifilter(range(10), fn(x) { x % 2 == 0 }), fn(x) { x * x }), fn(a, b) { a + b }, 0)", 120},
+            {"let s = 0; for (x in take(imap(range(1, 100), fn(x) { x * 3 }), 4)) { s = s + x; } s", 30},
+            {"let s = 0; for (x in range(10, 0, -3)) { s = s + x; } s",                          22},
+            {R"(reduce(imap(["a", "bb", ""], len), fn(a, b) { a + b }, 0))",                     3},
+            {"len(collect(ifilter(range(5), fn(x) { false })))",                                 0},
+            {"collect(imap([1, 2, 3], fn(x) { x + 1 }))[2]",                                     4},
+            {"reduce([], fn(a, b) { a }, 7)",                                                    7},
+            {"let it = range(3); let a = collect(it); len(a) + len(collect(it))",                3},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval("range(1, 2, 0)")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("imap(1, len)")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("ifilter([1], 2)")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("collect(imap([1], fn(x) { x + undefined }))")->getType() == ObjectType::ERROR);
+
+    // only iterators that asked for a call can be resumed
+    auto iterator = makeIterator(testEval("[1]"));
+    REQUIRE_THROWS_AS(iterator->resume(std::make_shared<NullObject>()), std::logic_error);
+}
+
+TEST_CASE("native calls", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        int expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"map([1, 2, 3], fn(x) { x * 2 })[2]",                                              6},
+            {"let k = 10; map([1, 2], fn(x) { x + k })[1]",                                     12},
+            {R"(map(["a", "bb"], len)[1])",                                                     2},
+            {"map([[1], [2, 3]], fn(a) { sum(map(a, fn(x) { x * x })) })[1]",                   13},
+            {"map([4], fn(n) { reduce(range(n), fn(a, b) { a + b }, 0) })[0]",                  6},
+            // a function expression evaluated again creates a working function every time
+            {"let make = fn() { fn(x) { x * 2 } }; make()(1) + make()(2)",                      6},
+    };
+    for (auto &testCase: cases) {
+        testExpression<IntegerObject>(testCase.input, testCase.expected);
+    }
+    REQUIRE(testEval("map([1], fn(x) { x + undefined })")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("map([1], 1)")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("sort", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {"sort([3, 1, 2])",                                  "[1, 2, 3, ]"},
+            {"sort([])",                                         "[]"},
+            {R"(sort(["b", "c", "a"]))",                         "[a, b, c, ]"},
+            {"sort([2.5, 1, -3])",                               "[-3, 1, 2.5, ]"},
+            {"sort([3, 1, 2], fn(a, b) { a > b })",              "[3, 2, 1, ]"},
+            {R"(sort(["bb", "a", "ccc"], fn(a, b) { len(a) > len(b) }))", "[ccc, bb, a, ]"},
+            // the input is not modified
+            {"let a = [2, 1]; let b = sort(a); a",               "[2, 1, ]"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(testEval(testCase.input)->inspect() == testCase.expected);
+    }
+    testExpression<IntegerObject>("let a = []; let i = 0; while (i < 100000) { a = push(a, (i * 7919) % 100003); "
+                                  "i = i + 1; } let s = sort(a); s[0] + s[99999]", 100002);
+    REQUIRE(testEval("sort([1, \"a\"])")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("sort([1, 2], fn(a, b) { 1 })")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("sort(1)")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("string builtins", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {R"(split("a,b,,c", ","))",                          "[a, b, , c, ]"},
+            {R"(split("GET /index HTTP", " -> "))",              "[GET /index HTTP, ]"},
+            {R"(split("x -> y -> z", " -> "))",                  "[x, y, z, ]"},
+            {R"(join(["a", "b", "c"], ", "))",                   "a, b, c"},
+            {R"(join([], ", "))",                                ""},
+            {R"(join(split("a b c", " "), "-"))",                "a-b-c"},
+            {R"(replace("a.b.c", ".", "::"))",                   "a::b::c"},
+            {R"(replace("aaa", "aa", "b"))",                     "ba"},
+            {R"(replace("abc", "x", "y"))",                      "abc"},
+            {"trim(\"  \t padded \n\")",                           "padded"},
+            {R"(trim("   "))",                                   ""},
+            {R"("hello"[1])",                                    "e"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(testEval(testCase.input)->inspect() == testCase.expected);
+    }
+    testExpression<IntegerObject>(R"(find("error: disk full", "disk"))", 7);
+    testExpression<IntegerObject>(R"(find("error", "warn"))", -1);
+    testExpression<IntegerObject>(R"(find("abc", ""))", 0);
+    testExpression<BooleanObject>(R"(contains("error: disk full", "full"))", true);
+    testExpression<BooleanObject>(R"(contains("error", "rr:"))", false);
+    // out of range is null, a value that can be stored like any other
+    REQUIRE(testEval(R"("abc"[3])")->getType() == ObjectType::_NULL);
+    REQUIRE(testEval(R"("abc"[-1])")->getType() == ObjectType::_NULL);
+    REQUIRE(testEval(R"(let s = "abc"; [s[9]])")->inspect() == "[null, ]");
+    REQUIRE(testEval(R"(let s = "abc"; let c = s[9]; c)")->getType() == ObjectType::_NULL);
+    REQUIRE(testEval(R"(split("abc", ""))")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval(R"(join([1, 2], ","))")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval(R"(find("abc", 1))")->getType() == ObjectType::ERROR);
+}
+
+TEST_CASE("string builder", "[evaluator]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+
+    std::vector<TestCase> cases = {
+            {R"(let b = builder(); append(b, "n = ", 42, ", x = ", -7); build(b))",  "n = 42, x = -7"},
+            {R"(build(append(append(builder(), "a"), "b", 1.5, [1])))",            "ab1.5[1, ]"},
+            {"build(builder())",                                                   ""},
+            // builders are shared, not copied
+            {R"(let b = builder(); let c = b; append(c, "x"); build(b))",          "x"},
+            // build hands the text over and starts over
+            {R"(let b = builder(); append(b, "a"); let s = build(b); append(b, "b"); s + build(b))", "ab"},
+            {"append(builder(), 9223372036854775807, -9223372036854775807 - 1)",  "<builder>"},
+    };
+    for (auto &testCase: cases) {
+        REQUIRE(testEval(testCase.input)->inspect() == testCase.expected);
+    }
+    testExpression<IntegerObject>("let b = builder(); for (i in range(10000)) { append(b, i, \",\"); } "
+                                  "len(build(b))", 48890);
+    REQUIRE(testEval("append(1, 2)")->getType() == ObjectType::ERROR);
+    REQUIRE(testEval("build(builder(), 1)")->getType() == ObjectType::ERROR);
 }
@@ -2,8 +2,11 @@
 // Created by seeu on 2022/7/3.
 //
 #include "catch2/catch_all.hpp"
+#include <chrono>
 #include <iostream>
+#include "Builtin.h"
 #include "Lexer.h"
+#include "Simd.h"
 
 TEST_CASE("Lexer", "[lexer]") {
     const char *input = R"(
@@ -144,3 +147,206 @@ TEST_CASE("Lexer", "[lexer]") {
         REQUIRE(t.literal == token.value);
     }
 }
+
+TEST_CASE("Lexer numbers", "[lexer]") {
+    struct Expected {
+        Common::TokenType type;
+        std::string value;
+    };
+    std::vector<Expected> tokens = {
+            {Common::TokenType::INT,        "12"},
+            {Common::TokenType::FLOAT,      "3.25"},
+            {Common::TokenType::FLOAT,      "1e9"},
+            {Common::TokenType::FLOAT,      "2.5E-3"},
+            {Common::TokenType::INT,        "7"},
+            {Common::TokenType::IDENTIFIER, "e"},
+            {Common::TokenType::IDENTIFIER, "arr"},
+            {Common::TokenType::LBRACKET,   "["},
+            {Common::TokenType::INT,        "1"},
+            {Common::TokenType::RBRACKET,   "]"},
+            {Common::TokenType::_EOF,       ""},
+    };
+
+    Common::Lexer lexer{"12 3.25 1e9 2.5E-3 7e arr[1]"};
+    for (auto &token: tokens) {
+        auto t = lexer.nextToken();
+        REQUIRE(t.type == token.type);
+        REQUIRE(t.literal == token.value);
+    }
+}
+
+TEST_CASE("Lexer loops", "[lexer]") {
+    struct Expected {
+        Common::TokenType type;
+        std::string value;
+    };
+    std::vector<Expected> tokens = {
+            {Common::TokenType::WHILE,      "while"},
+            {Common::TokenType::LPAREN,     "("},
+            {Common::TokenType::IDENTIFIER, "x"},
+            {Common::TokenType::RPAREN,     ")"},
+            {Common::TokenType::LBRACE,     "{"},
+            {Common::TokenType::FOR,        "for"},
+            {Common::TokenType::LPAREN,     "("},
+            {Common::TokenType::IDENTIFIER, "i"},
+            {Common::TokenType::IN,         "in"},
+            {Common::TokenType::IDENTIFIER, "items"},
+            {Common::TokenType::RPAREN,     ")"},
+            {Common::TokenType::LBRACE,     "{"},
+            {Common::TokenType::RBRACE,     "}"},
+            {Common::TokenType::RBRACE,     "}"},
+            {Common::TokenType::_EOF,       ""},
+    };
+
+    Common::Lexer lexer{"while (x) { for (i in items) {} }"};
+    for (auto &token: tokens) {
+        auto t = lexer.nextToken();
+        REQUIRE(t.type == token.type);
+        REQUIRE(t.literal == token.value);
+    }
+}
+
+TEST_CASE("Lexer operators", "[lexer]") {
+    struct Expected {
+        Common::TokenType type;
+        std::string value;
+    };
+    std::vector<Expected> tokens = {
+            {Common::TokenType::LT_EQ,   "<="},
+            {Common::TokenType::GT_EQ,   ">="},
+            {Common::TokenType::LT,      "<"},
+            {Common::TokenType::GT,      ">"},
+            {Common::TokenType::AND,     "&&"},
+            {Common::TokenType::OR,      "||"},
+            {Common::TokenType::PERCENT, "%"},
+            {Common::TokenType::ILLEGAL, "&"},
+            {Common::TokenType::MATCH,   "match"},
+            {Common::TokenType::ARROW,   "=>"},
+            {Common::TokenType::EQ,      "=="},
+            {Common::TokenType::_EOF,    ""},
+    };
+
+    Common::Lexer lexer{"<= >= < > && || % & match => =="};
+    for (auto &token: tokens) {
+        auto t = lexer.nextToken();
+        REQUIRE(t.type == token.type);
+        REQUIRE(t.literal == token.value);
+    }
+}
+
+TEST_CASE("Lexer literals", "[lexer]") {
+    Common::Lexer lexer{R"(let name = "text"; a != 12.5;)"};
+    auto &source = *lexer.getSource();
+    std::vector<std::string> literals;
+    for (auto t = lexer.nextToken(); t.type != Common::TokenType::_EOF; t = lexer.nextToken()) {
+        // literals are views into the lexer's source, not copies
+        REQUIRE(t.literal.data() >= source.data());
+        REQUIRE(t.literal.data() + t.literal.size() <= source.data() + source.size());
+        literals.emplace_back(t.literal);
+    }
+    REQUIRE(literals == std::vector<std::string>{"let", "name", "=", "text", ";", "a", "!=", "12.5", ";"});
+}
+
+TEST_CASE("Lexer keywords", "[lexer]") {
+    for (auto keyword: Common::KEYWORDS) {
+        REQUIRE(Common::lookupIdentifier(keyword.word) == keyword.type);
+    }
+    static_assert(Common::lookupIdentifier("return") == Common::TokenType::RETURN);
+    for (auto word: {"f", "fnn", "lets", "tru", "False", "iff", "els", "in_", "x", "matches", "_"}) {
+        REQUIRE(Common::lookupIdentifier(word) == Common::TokenType::IDENTIFIER);
+    }
+}
+
+TEST_CASE("Lexer symbols", "[lexer]") {
+    Common::Lexer lexer{"first second first len fn"};
+    auto first = lexer.nextToken();
+    auto second = lexer.nextToken();
+    REQUIRE(first.symbol != second.symbol);
+    REQUIRE(lexer.nextToken().symbol == first.symbol);
+    REQUIRE(lexer.getSymbols()->name(first.symbol) == "first");
+    // builtin names come first, their symbol is their index
+    REQUIRE(lexer.nextToken().symbol == Common::SymbolId(*Common::lookupBuiltin("len")));
+    REQUIRE(Common::lookupIdentifier("fn") == Common::TokenType::FUNCTION);
+
+    // lexers given the same table share its symbols, any other lexer starts a table of its own
+    Common::Lexer shared{"second", lexer.getSymbols()};
+    REQUIRE(shared.nextToken().symbol == second.symbol);
+    Common::Lexer other{"third second"};
+    REQUIRE(other.nextToken().symbol == second.symbol);
+    REQUIRE(other.nextToken().symbol != second.symbol);
+    REQUIRE(lexer.getSymbols()->size() == other.getSymbols()->size() - 1);
+}
+
+TEST_CASE("Lexer positions", "[lexer]") {
+    auto source = std::make_shared<const std::string>("let a = 1;\n  \"two\nlines\" +\r\n\tb");
+    auto symbols = std::make_shared<Common::SymbolInterner>();
+    Common::Lexer lexer{source, 0, 1, symbols};
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> positions;
+    for (auto t = lexer.nextToken(); t.type != Common::TokenType::_EOF; t = lexer.nextToken()) {
+        positions.emplace_back(t.line, t.column);
+    }
+    REQUIRE(positions == std::vector<std::pair<std::uint32_t, std::uint32_t>>{
+            {1, 1}, {1, 5}, {1, 7}, {1, 9}, {1, 10}, {2, 3}, {3, 8}, {4, 2}});
+
+    // a lexer starting inside the source continues the line numbering it is given
+    Common::Lexer resumed{source, unsigned(source->find('+')), 3, symbols};
+    auto plus = resumed.nextToken();
+    REQUIRE(plus.type == Common::TokenType::PLUS);
+    REQUIRE((plus.line == 3 && plus.column == 8));
+}
+
+TEST_CASE("Lexer long runs", "[lexer]") {
+    // runs longer than a vector, ending right at the end of the input
+    std::string identifier(70, 'x');
+    std::string digits(40, '7');
+    std::string text(50, 'y');
+    Common::Lexer lexer{std::string(45, ' ') + identifier + "\n\t\r " + digits + "." + digits + "e+" + digits +
+                        std::string(33, '\n') + '"' + text + "\" \"" + text};
+    std::vector<std::pair<Common::TokenType, std::string>> expected{
+            {Common::TokenType::IDENTIFIER, identifier},
+            {Common::TokenType::FLOAT,      digits + "." + digits + "e+" + digits},
+            {Common::TokenType::STRING,     text},
+            // unterminated
+            {Common::TokenType::STRING,     text},
+            {Common::TokenType::_EOF,       ""},
+    };
+    for (auto &[type, literal]: expected) {
+        auto t = lexer.nextToken();
+        REQUIRE(t.type == type);
+        REQUIRE(t.literal == literal);
+    }
+}
+
+// not run by default, select it with `interpreter_tests "[benchmark]"`
+TEST_CASE("Lexer throughput", "[.][benchmark]") {
+    auto measure = [](const std::string &name, const std::string &chunk) {
+        std::string input;
+        while (input.size() < (std::size_t{16} << 20)) {
+            input += chunk;
+        }
+        Common::Lexer lexer{input};
+        std::size_t tokens = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (lexer.nextToken().type != Common::TokenType::_EOF) {
+            tokens++;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE(tokens > 0);
+        std::cout << name << " (" << Common::Simd::instructionSet() << "): "
+                  << double(input.size()) / (1 << 20) / elapsed.count() << " MB/s, "
+                  << double(tokens) / elapsed.count() / 1e6 << " M tokens/s" << std::endl;
+    };
+
+    measure("code", R"(
+    let accumulated_total_value = fn(first_argument, second_argument) {
+        let intermediate_result = first_argument * 1234567 + second_argument / 89.125;
+        if (intermediate_result >= 1000000) { return "a generated string literal"; }
+        return intermediate_result % 97;
+    };
+)");
+    // generated data: deep indentation, long keys and long string values
+    measure("data", R"(
+                        {"generated_configuration_entry_identifier": "a long generated string value, as found in fixtures and templates",
+                         "another_generated_configuration_entry": 123456789012345678},
+)");
+}
@@ -6,6 +6,9 @@
 
 #include "catch2/catch_all.hpp"
 #include "Parser.h"
+#include "fmt/format.h"
+#include <chrono>
+#include <iostream>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -20,18 +23,19 @@ unique_ptr<Program> testParse(string input) {
     return parser.parseProgram();
 }
 
-unique_ptr<Statement> testSingleStatement(string input) {
-    auto program = testParse(std::move(input));
+// the statement keeps its program alive, token literals point into the program's source
+shared_ptr<Statement> testSingleStatement(string input) {
+    shared_ptr<Program> program = testParse(std::move(input));
     REQUIRE(program->statements.size() == 1);
-    return std::move(program->statements[0]);
+    return {program, program->statements[0].get()};
 }
 
-static void testExpression(std::unique_ptr<Expression> expression, int value) {
+static void testExpression(NodePtr<Expression> expression, int value) {
     auto intExpr = static_cast<IntegerExpression *>(expression.get());
     REQUIRE(intExpr->value == value);
 }
 
-static void testExpression(std::unique_ptr<Expression> expression, bool value) {
+static void testExpression(NodePtr<Expression> expression, bool value) {
     auto boolExpr = static_cast<BoolExpression *>(expression.get());
     if (value) {
         REQUIRE(boolExpr->value);
@@ -40,13 +44,13 @@ static void testExpression(std::unique_ptr<Expression> expression, bool value) {
     }
 }
 
-static void testExpression(std::unique_ptr<Expression> expression, std::string value) {
+static void testExpression(NodePtr<Expression> expression, std::string value) {
     if (expression->getType() == Common::NodeType::Identifier) {
         auto identifier = static_cast<Identifier *>(expression.get());
-        REQUIRE(identifier->value == value);
+        REQUIRE(identifier->token.literal == value);
     } else {
         auto stringExpr = static_cast<StringExpression *>(expression.get());
-        REQUIRE(stringExpr->value == value);
+        REQUIRE(stringExpr->value() == value);
     }
 }
 
@@ -68,7 +72,7 @@ TEST_CASE("let statement", "[parser]") {
     for (auto &testCase: cases) {
         auto stmt = testSingleStatement(testCase.input);
         auto letStatement = static_cast<LetStatement *>(stmt.get());
-        REQUIRE(letStatement->name->value == testCase.name);
+        REQUIRE(letStatement->name->token.literal == testCase.name);
         REQUIRE(letStatement->token.literal == "let");
 
         std::visit([&](auto v) {
@@ -145,7 +149,7 @@ TEST_CASE("prefix expression", "[parser]") {
         auto stmt = testSingleStatement(testCase.input);
         auto expressionStatement = static_cast<ExpressionStatement *>(stmt.get());
         auto prefixExpression = static_cast<PrefixExpression *>(expressionStatement->expression.get());
-        REQUIRE(prefixExpression->prefixOperator == testCase.prefix);
+        REQUIRE(operatorSymbol(prefixExpression->prefixOperator) == testCase.prefix);
 
         std::visit([&](auto v) {
             testExpression(std::move(prefixExpression->rightExpression), v);
@@ -197,6 +201,81 @@ TEST_CASE("hashmap", "[parser]") {
         REQUIRE(p.second->getType() == Common::NodeType::IntegerExpression);
     }
 }
+TEST_CASE("index assignment", "[parser]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+    std::vector<TestCase> cases{
+            {"arr[0] = 1;",           "(arr[0]) = 1;"},
+            {"h[\"a\"][1] = 2 * 3",   "((h[a])[1]) = (2 * 3);"},
+            {"arr[i + 1] = arr[i];", "(arr[(i + 1)]) = (arr[i]);"},
+            {"x = x + 1;",           "x = (x + 1);"},
+    };
+    for (auto &testCase: cases) {
+        auto stmt = testSingleStatement(testCase.input);
+        REQUIRE(stmt->getType() == Common::NodeType::AssignStatement);
+        REQUIRE(stmt->toString() == testCase.expected);
+    }
+}
+
+TEST_CASE("loop statements", "[parser]") {
+    struct TestCase {
+        std::string input;
+        Common::NodeType type;
+        std::string expected;
+    };
+    std::vector<TestCase> cases{
+            {"while (i < 10) { i = i + 1; }", Common::NodeType::WhileStatement, "while (i < 10) i = (i + 1);"},
+            {"while (true) { };",             Common::NodeType::WhileStatement, "while true "},
+            {"for (x in [1, 2]) { x }",       Common::NodeType::ForStatement,   "for (x in [1, 2]) x"},
+            {"for (x in f(a)) { puts(x); }",  Common::NodeType::ForStatement,   "for (x in f(a)) puts(x)"},
+    };
+    for (auto &testCase: cases) {
+        auto stmt = testSingleStatement(testCase.input);
+        REQUIRE(stmt->getType() == testCase.type);
+        REQUIRE(stmt->toString() == testCase.expected);
+    }
+}
+
+TEST_CASE("logical operator precedence", "[parser]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+    std::vector<TestCase> cases{
+            {"a || b && c",          "(a || (b && c))"},
+            {"a && b || c",          "((a && b) || c)"},
+            {"a < b && c >= d",      "((a < b) && (c >= d))"},
+            {"a == b || a % 2 <= 1", "((a == b) || ((a % 2) <= 1))"},
+    };
+    for (auto &testCase: cases) {
+        auto stmt = testSingleStatement(testCase.input);
+        REQUIRE(stmt->toString() == testCase.expected);
+    }
+}
+
+TEST_CASE("match expression", "[parser]") {
+    struct TestCase {
+        std::string input;
+        std::string expected;
+    };
+    std::vector<TestCase> cases{
+            {"match (x) { 1 => a, 2, -3 => { b; c }, _ => d }", "match (x) { 1 => a, 2, (-3) => bc, _ => d }"},
+            {R"(match (f(x)) { "a" => 1, true => 2.5 })",       "match (f(x)) { a => 1, true => 2.5 }"},
+            {"match (x) { }",                                   "match (x) {  }"},
+    };
+    for (auto &testCase: cases) {
+        auto stmt = testSingleStatement(testCase.input);
+        auto expression = static_cast<ExpressionStatement *>(stmt.get())->expression.get();
+        REQUIRE(expression->getType() == Common::NodeType::MatchExpression);
+        REQUIRE(expression->toString() == testCase.expected);
+    }
+
+    // patterns must be literals
+    auto program = testParse("match (x) { y => 1 }");
+    REQUIRE(static_cast<ExpressionStatement *>(program->statements[0].get())->expression == nullptr);
+}
 
 TEST_CASE("infix expression", "[parser]") {
     struct TestCase {
@@ -214,6 +293,11 @@ TEST_CASE("infix expression", "[parser]") {
             {"5 < 5;",                  5,        "<",  5},
             {"5 == 5;",                 5,        "==", 5},
             {"5 != 5;",                 5,        "!=", 5},
+            {"5 <= 5;",                 5,        "<=", 5},
+            {"5 >= 5;",                 5,        ">=", 5},
+            {"5 % 5;",                  5,        "%",  5},
+            {"true && false;",          true,     "&&", false},
+            {"true || false;",          true,     "||", false},
             {"foobar + barfoo;",        "foobar", "+",  "barfoo"},
             {"foobar - barfoo;",        "foobar", "-",  "barfoo"},
             {"foobar * barfoo;",        "foobar", "*",  "barfoo"},
@@ -233,7 +317,7 @@ TEST_CASE("infix expression", "[parser]") {
         auto stmt = testSingleStatement(testCase.input);
         auto expressionStatement = static_cast<ExpressionStatement *>(stmt.get());
         auto infixExpression = static_cast<InfixExpression *>(expressionStatement->expression.get());
-        REQUIRE(infixExpression->infixOperator == testCase.infix);
+        REQUIRE(operatorSymbol(infixExpression->infixOperator) == testCase.infix);
 
         std::visit([&](auto v) {
             testExpression(std::move(infixExpression->leftExpression), v);
@@ -245,4 +329,130 @@ TEST_CASE("infix expression", "[parser]") {
     }
 };
 
+TEST_CASE("incremental reparse", "[parser]") {
+    const std::string text = R"(let a = 1;
+let add = fn(x, y) { x + y };
+let s = "some text";
+a
+add(a, 2);
+let last = [1, 2, 3];)";
+
+    // the edited program must equal a full parse of the edited text
+    auto reparse = [&](std::size_t offset, std::size_t removed, const std::string &inserted) {
+        auto previous = testParse(text);
+        auto symbols = previous->storage->symbols;
+        auto program = Parser::reparse(std::move(previous), {offset, removed, inserted});
+        auto edited = text;
+        edited.replace(offset, removed, inserted);
+        auto expected = testParse(edited);
+        REQUIRE(program->toString() == expected->toString());
+        REQUIRE(*program->storage->source == edited);
+        REQUIRE(program->errors == expected->errors);
+        REQUIRE(program->storage->symbols == symbols);
+        REQUIRE(program->origins.size() == expected->origins.size());
+        for (std::size_t index = 0; index < expected->origins.size(); index++) {
+            auto &origin = program->origins[index];
+            REQUIRE(origin.offset == expected->origins[index].offset);
+            REQUIRE(origin.line == expected->origins[index].line);
+            // lines recorded in reused statements are corrected by the shift
+            REQUIRE(program->statements[index]->getLine() + origin.lineShift ==
+                    expected->statements[index]->getLine());
+        }
+        return program;
+    };
+
+    SECTION("statements away from the edit are reused") {
+        auto previous = testParse(text);
+        std::vector<Statement *> statements;
+        for (auto &statement: previous->statements) {
+            statements.push_back(statement.get());
+        }
+        auto offset = text.find("2);");
+        auto program = Parser::reparse(std::move(previous), {offset, 1, "a * 2"});
+        REQUIRE(program->statements.size() == statements.size());
+        // the statement before the edited one is parsed again as well
+        for (std::size_t index = 0; index < 3; index++) {
+            REQUIRE(program->statements[index].get() == statements[index]);
+        }
+        REQUIRE(program->statements[4].get() != statements[4]);
+        REQUIRE(program->statements[4]->toString() == "add(a, (a * 2))");
+        REQUIRE(program->statements[5].get() == statements[5]);
+    }
+
+    SECTION("edits") {
+        reparse(0, 0, "let z = 0; ");
+        reparse(0, 4, "");
+        reparse(text.size(), 0, " a + 1");
+        reparse(text.find("some"), 4, "other");
+        reparse(text.find("let s"), 0, "\n\nlet t = 1;\n");
+        reparse(text.find("let add"), text.find("a\nadd") - text.find("let add"), "");
+        // the edited statement continues the one before it
+        reparse(text.find("add(a, 2)"), 0, "+ ");
+        // the statement before the edit grows into it
+        reparse(text.find("\nadd(a, 2)"), 1, "");
+        reparse(text.find("let s"), text.find("add(a") - text.find("let s"), "");
+        // an unclosed string swallows the rest of the program
+        reparse(text.find("let s"), 0, "\"");
+    }
+
+    SECTION("edits in a row") {
+        auto program = testParse("let a = 1;");
+        for (auto name: {"b", "c", "d"}) {
+            auto &source = *program->storage->source;
+            program = Parser::reparse(std::move(program), {source.size(), 0, fmt::format(" let {} = 2;", name)});
+        }
+        REQUIRE(program->toString() == "let a = 1;let b = 2;let c = 2;let d = 2;");
+        auto &source = *program->storage->source;
+        program = Parser::reparse(std::move(program), {source.find("let c"), 10, ""});
+        REQUIRE(program->toString() == "let a = 1;let b = 2;let d = 2;");
+    }
+
+    SECTION("syntax errors") {
+        auto program = reparse(text.find("= \"some"), 1, "");
+        REQUIRE(program->errors == std::vector<std::string>{"expected next token to be ASSIGN, got STRING instead"});
+        reparse(text.find("= [1"), 1, "");
+
+        // an error stays reported after edits elsewhere and goes away once it is fixed
+        program = Parser::reparse(std::move(program), {0, 0, "let z = 0;\n"});
+        REQUIRE(program->errors.size() == 1);
+        auto &source = *program->storage->source;
+        program = Parser::reparse(std::move(program), {source.find(" \"some"), 0, " ="});
+        REQUIRE(program->errors.empty());
+        REQUIRE(program->toString() == testParse("let z = 0;\n" + text)->toString());
+    }
+}
+
+// not run by default, select it with `interpreter_tests "[benchmark]"`
+TEST_CASE("Parser throughput", "[.][benchmark]") {
+    const std::string chunk = R"(
+    let accumulated_total_value = fn(first_argument, second_argument) {
+        let intermediate_result = first_argument * 1234567 + second_argument / 89.125 - -3;
+        if (intermediate_result >= 1000000 && !(second_argument == 0)) { return [1, 2, intermediate_result][2]; }
+        return {"remainder": intermediate_result % 97, "flag": true || false}["remainder"];
+    };
+    accumulated_total_value(1, 2) + accumulated_total_value(3, 4) * (5 - 6);
+)";
+    std::string input;
+    std::size_t chunks = 0;
+    while (input.size() < (std::size_t{16} << 20)) {
+        input += chunk;
+        chunks++;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto program = testParse(input);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(program->statements.size() == chunks * 2);
+    std::cout << "parser: " << double(input.size()) / (1 << 20) / elapsed.count() << " MB/s, "
+              << double(program->statements.size()) / elapsed.count() / 1e6 << " M statements/s" << std::endl;
+
+    // an edit in the middle only parses the statements around it again
+    auto offset = input.find("89.125", input.size() / 2);
+    start = std::chrono::steady_clock::now();
+    program = Parser::reparse(std::move(program), {offset, 6, "0.5"});
+    elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(program->statements.size() == chunks * 2);
+    std::cout << "reparse: " << elapsed.count() * 1e3 << " ms" << std::endl;
+}
+
 #pragma clang diagnostic pop
@@ -0,0 +1,89 @@
+//
+// Created by seeu on 2022/8/27.
+//
+
+#include <vector>
+#include <numeric>
+#include "catch2/catch_all.hpp"
+#include "PersistentVector.h"
+
+using namespace Common;
+
+TEST_CASE("persistent vector push back", "[persistent vector]") {
+    // cross the tail, one and two trie levels
+    for (std::size_t size: {0, 1, 31, 32, 33, 1024, 1025, 1056, 1057, 40000}) {
+        PersistentVector<int> vector{};
+        for (int i = 0; i < int(size); i++) {
+            vector = vector.pushBack(i);
+        }
+        REQUIRE(vector.size() == size);
+        for (int i = 0; i < int(size); i++) {
+            REQUIRE(vector[i] == i);
+        }
+        std::vector<int> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        REQUIRE(std::vector<int>(vector.begin(), vector.end()) == expected);
+    }
+}
+
+TEST_CASE("persistent vector keeps old versions", "[persistent vector]") {
+    std::vector<int> input(100);
+    std::iota(input.begin(), input.end(), 0);
+    PersistentVector<int> base{input.begin(), input.end()};
+
+    auto first = base.pushBack(100);
+    auto second = base.pushBack(200);
+    REQUIRE(base.size() == 100);
+    REQUIRE(first[100] == 100);
+    REQUIRE(second[100] == 200);
+
+    auto updated = second.set(3, -3).set(99, -99).set(100, -100);
+    REQUIRE(updated[3] == -3);
+    REQUIRE(updated[99] == -99);
+    REQUIRE(updated[100] == -100);
+    REQUIRE(second[3] == 3);
+    REQUIRE(second[99] == 99);
+    REQUIRE(second[100] == 200);
+    REQUIRE(base[3] == 3);
+
+    // base was not claimed past its tail by `updated`
+    auto third = updated.pushBack(300);
+    REQUIRE(third[101] == 300);
+    REQUIRE(second.pushBack(1)[101] == 1);
+    REQUIRE(third[101] == 300);
+}
+
+TEST_CASE("persistent vector set in place", "[persistent vector]") {
+    std::vector<int> input(100);
+    std::iota(input.begin(), input.end(), 0);
+    PersistentVector<int> vector{input.begin(), input.end()};
+
+    auto snapshot = vector;
+    vector.setInPlace(3, -3);
+    vector.setInPlace(99, -99);
+    // nodes shared with the snapshot are copied before writing
+    REQUIRE(vector[3] == -3);
+    REQUIRE(vector[99] == -99);
+    REQUIRE(snapshot[3] == 3);
+    REQUIRE(snapshot[99] == 99);
+
+    auto chunk = vector.chunkAt(0).first;
+    vector.setInPlace(4, -4);
+    // the leaf is no longer shared, so it is written in place
+    REQUIRE(vector.chunkAt(0).first == chunk);
+    REQUIRE(vector[4] == -4);
+    REQUIRE(snapshot[4] == 4);
+    REQUIRE(vector.pushBack(100)[100] == 100);
+}
+
+TEST_CASE("persistent vector chunks", "[persistent vector]") {
+    std::vector<int> input(70);
+    std::iota(input.begin(), input.end(), 0);
+    PersistentVector<int> vector{input.begin(), input.end()};
+
+    auto [data, size] = vector.chunkAt(30);
+    REQUIRE(size == 2);
+    REQUIRE(data[0] == 30);
+    REQUIRE(data[1] == 31);
+    REQUIRE(vector.chunkAt(64).second == 6);
+}
@@ -0,0 +1,154 @@
+//
+// Created by seeu on 2022/8/28.
+//
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include "catch2/catch_all.hpp"
+#include "Simd.h"
+
+using namespace Common;
+
+TEST_CASE("simd integer kernels", "[simd]") {
+    // sizes around the vector widths to cover the scalar tails
+    for (std::size_t size: {1, 2, 3, 4, 5, 7, 8, 9, 31, 32, 33, 1000}) {
+        std::vector<std::int64_t> data(size);
+        for (std::size_t i = 0; i < size; i++) {
+            data[i] = std::int64_t(i * 7919 % 1013) - 500 + (std::int64_t(i) << 33);
+        }
+        std::vector<std::int64_t> other(size);
+        for (std::size_t i = 0; i < size; i++) {
+            other[i] = std::int64_t(i % 13) - 6;
+        }
+
+        REQUIRE(Simd::sum(data.data(), size) == std::accumulate(data.begin(), data.end(), std::int64_t{0}));
+        REQUIRE(Simd::dot(other.data(), other.data(), size) ==
+                std::inner_product(other.begin(), other.end(), other.begin(), std::int64_t{0}));
+        REQUIRE(Simd::min(data.data(), size) == *std::min_element(data.begin(), data.end()));
+        REQUIRE(Simd::max(data.data(), size) == *std::max_element(data.begin(), data.end()));
+        REQUIRE(Simd::dot(data.data(), other.data(), size) ==
+                std::inner_product(data.begin(), data.end(), other.begin(), std::int64_t{0}));
+
+        std::vector<std::int64_t> added(size);
+        REQUIRE(Simd::addScalar(data.data(), size, -3, added.data()));
+        for (std::size_t i = 0; i < size; i++) {
+            REQUIRE(added[i] == data[i] - 3);
+        }
+
+        std::vector<std::int64_t> filtered(size);
+        auto count = Simd::filterGreater(other.data(), size, 0, filtered.data());
+        std::vector<std::int64_t> expected{};
+        std::copy_if(other.begin(), other.end(), std::back_inserter(expected), [](auto v) { return v > 0; });
+        filtered.resize(count);
+        REQUIRE(filtered == expected);
+    }
+}
+
+TEST_CASE("simd integer kernels overflow", "[simd]") {
+    for (std::size_t size: {2, 3, 4, 5, 8, 9, 33}) {
+        std::vector<std::int64_t> data(size, INT64_MAX / 2 + 1);
+        REQUIRE_FALSE(Simd::sum(data.data(), size).has_value());
+        REQUIRE_FALSE(Simd::dot(data.data(), data.data(), size).has_value());
+
+        // large operands whose products still fit
+        std::vector<std::int64_t> large(size, std::int64_t{1} << 40);
+        std::vector<std::int64_t> small(size, -3);
+        REQUIRE(Simd::dot(large.data(), small.data(), size) == -3 * (std::int64_t{1} << 40) * std::int64_t(size));
+
+        // products that fit, their sum doesn't
+        std::vector<std::int64_t> half(size, std::int64_t{1} << 31);
+        std::vector<std::int64_t> quarter(size, -(std::int64_t{1} << 31));
+        REQUIRE_FALSE(Simd::dot(half.data(), half.data(), size).has_value());
+        REQUIRE_FALSE(Simd::dot(quarter.data(), quarter.data(), size).has_value());
+        REQUIRE(Simd::dot(quarter.data(), quarter.data(), 1) == std::int64_t{1} << 62);
+
+        // a single element past the vector lanes or in the tail overflows the whole call
+        std::vector<std::int64_t> added(size);
+        std::vector<std::int64_t> ones(size, 1);
+        REQUIRE(Simd::addScalar(ones.data(), size, INT64_MAX - 1, added.data()));
+        ones[size - 1] = 2;
+        REQUIRE_FALSE(Simd::addScalar(ones.data(), size, INT64_MAX - 1, added.data()));
+        ones[size - 1] = 1;
+        ones[0] = -2;
+        REQUIRE_FALSE(Simd::addScalar(ones.data(), size, INT64_MIN + 1, added.data()));
+    }
+    std::vector<std::int64_t> data{INT64_MAX, -1, INT64_MIN, 1};
+    REQUIRE(Simd::sum(data.data(), data.size()) == -1);
+}
+
+TEST_CASE("simd float kernels", "[simd]") {
+    for (std::size_t size: {1, 2, 3, 4, 5, 8, 9, 33}) {
+        std::vector<double> data(size);
+        for (std::size_t i = 0; i < size; i++) {
+            data[i] = double(i) * 1.75 - 3.5;
+        }
+        std::vector<double> floored(size);
+        Simd::floor(data.data(), size, floored.data());
+        std::vector<double> roots(size);
+        Simd::sqrt(data.data(), size, roots.data());
+        for (std::size_t i = 0; i < size; i++) {
+            REQUIRE(floored[i] == std::floor(data[i]));
+            if (data[i] < 0) {
+                REQUIRE(std::isnan(roots[i]));
+            } else {
+                REQUIRE(roots[i] == std::sqrt(data[i]));
+            }
+        }
+    }
+}
+
+TEST_CASE("simd string find", "[simd]") {
+    // a haystack full of near misses, needles of every length up to past the vector width
+    std::string haystack;
+    for (std::size_t i = 0; i < 300; i++) {
+        haystack += char('a' + i * 7 % 5);
+    }
+    for (std::size_t size: {0, 1, 15, 16, 17, 31, 32, 33, 64, 100, 300}) {
+        std::string_view text{haystack.data(), size};
+        for (std::size_t needleSize = 0; needleSize <= 40; needleSize++) {
+            for (std::size_t from: {std::size_t{0}, size / 2, size > needleSize ? size - needleSize : 0}) {
+                if (from + needleSize > haystack.size()) {
+                    continue;
+                }
+                auto needle = std::string_view{haystack}.substr(from, needleSize);
+                auto expected = text.find(needle);
+                REQUIRE(Simd::find(text.data(), text.size(), needle.data(), needle.size()) ==
+                        (expected == std::string_view::npos ? size : expected));
+            }
+        }
+        std::string missing = "zz";
+        REQUIRE(Simd::find(text.data(), text.size(), missing.data(), missing.size()) == size);
+    }
+}
+
+TEST_CASE("simd lexer scanning", "[simd]") {
+    struct Class {
+        std::size_t (*run)(const char *, std::size_t);
+        std::string members;
+        // bytes next to or outside the class ranges, each one ends a run
+        std::string stoppers;
+    };
+    std::vector<Class> classes{
+            {Simd::whitespaceRun, " \t\n\r",                  "a\v\f\x01\x80\xff"},
+            {Simd::letterRun,     "abcxyzABCXYZ_",             "@[`{09 \x80\xc1\xfa\xff"},
+            {Simd::digitRun,      "0123456789",                "/:a \x80\xb0\xff"},
+            {Simd::stringRun,     "abc 123 {}\\'\t\r\x80\xff", std::string{"\"\n\0", 3}},
+    };
+    for (auto &characterClass: classes) {
+        for (std::size_t size: {0, 1, 15, 16, 17, 31, 32, 33, 47, 64, 65, 100}) {
+            std::string run;
+            for (std::size_t i = 0; i < size; i++) {
+                run += characterClass.members[i * 7 % characterClass.members.size()];
+            }
+            REQUIRE(characterClass.run(run.data(), run.size()) == size);
+            for (auto stopper: characterClass.stoppers) {
+                auto text = run + stopper + characterClass.members;
+                REQUIRE(characterClass.run(text.data(), text.size()) == size);
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+//
+// Created by seeu on 2022/9/4.
+//
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include "catch2/catch_all.hpp"
+#include "ThreadPool.h"
+
+using namespace Common;
+
+TEST_CASE("thread pool runs every task", "[thread pool]") {
+    ThreadPool pool{3};
+    std::atomic<int> sum{0};
+    std::vector<std::function<void()>> tasks;
+    for (int i = 1; i <= 100; i++) {
+        tasks.emplace_back([&sum, i] { sum += i; });
+    }
+    pool.runAll(std::move(tasks));
+    REQUIRE(sum == 5050);
+    pool.runAll({});
+}
+
+TEST_CASE("parallel sort", "[thread pool]") {
+    ThreadPool pool{3};
+    // sizes below and around the threshold, and chunk counts that leave an odd chunk out of a merge round
+    for (std::size_t size: {std::size_t{0}, std::size_t{1}, std::size_t{1000}, PARALLEL_SORT_THRESHOLD,
+                            PARALLEL_SORT_THRESHOLD * 3 / 2 + 7, std::size_t{1} << 20}) {
+        std::vector<std::int64_t> values(size);
+        std::uint64_t seed = 88172645463325252u;
+        for (auto &value: values) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            value = std::int64_t(seed % 100000) - 50000;
+        }
+        auto expected = values;
+        std::sort(expected.begin(), expected.end());
+        parallelSort(values, std::less<>{}, pool);
+        REQUIRE(values == expected);
+    }
+
+    std::vector<std::string> words;
+    for (std::size_t i = 0; i < PARALLEL_SORT_THRESHOLD * 2; i++) {
+        words.push_back(std::to_string(i * 7919 % 100003));
+    }
+    auto expected = words;
+    std::sort(expected.begin(), expected.end());
+    parallelSort(words, std::less<>{}, pool);
+    REQUIRE(words == expected);
+}
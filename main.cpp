@@ -43,12 +43,14 @@ int main(int argc, char **argv) {
         std::vector<std::string> history;
         std::function<bool(std::string)> iscomplete = determine_completeness;
         auto env = std::make_shared<Common::Environment>();
+        // the lines of a session bind into the same environment, they share their symbols
+        auto symbols = std::make_shared<Common::SymbolInterner>();
         while (true) {
             std::string answer =
                     Term::prompt_multiline(term, "> ", history, iscomplete);
             if (answer.size() == 1 && answer[0] == Key::CTRL + 'd')
                 break;
-            Common::Lexer lexer{answer};
+            Common::Lexer lexer{answer, symbols};
             Common::Parser parser{&lexer};
             auto program = parser.parseProgram();
             // std::cout << "Program: " << program->toString() << std::endl;